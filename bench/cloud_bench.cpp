@@ -0,0 +1,424 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gl_context.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "cloud_maps.h"
+#include "gpu_noise.h"
+#include "noise_volume.h"
+#include "shader_reader.h"
+#include "sun_depth_volume.h"
+#include "thread_pool.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+//Cost of the cloud raymarcher of cloudsFrag3.frag on a headless GL context: a fixed camera path below, inside and above
+//the cloud layer is rendered at the size of main.cpp's cloud pass from the same textures, once marching every step and
+//twice skipping the empty space the occupancy maps of src/cloud_maps.h find, checking single cells of their base level
+//and climbing their mip levels. The shader is compiled with COUNT_DENSITY_SAMPLES to count its cloudDensity calls per
+//pixel, along the view ray and toward the sun, and the occupancy checks along the view ray. Each frame is timed, and
+//skipping empty space must not change a single pixel. The path is then rendered again lighting the clouds from the sun
+//depth volume of src/sun_depth_volume.h, which follows the camera, and compared to the frames marching toward the sun.
+//Last it is rendered sampling the detail noise everywhere at its base level and at the density quality main.cpp sets,
+//counting the shape and detail noise samples per pixel.
+//Run from the repository root. Without a GPU it runs on Mesa's llvmpipe, on Linux LIBGL_ALWAYS_SOFTWARE=1 forces that.
+
+const char* NOISE_RECIPES_PATH = "./assets/cloud_noise.txt";
+const int CLOUD_BENCH_SIZE = 250; //main.cpp's cloud pass is a quarter of its 1000 x 1000 screen
+const float CLOUD_BENCH_RESOLUTION = 1000.0f;
+const float CLOUD_COVERAGE = 0.8f;
+const float DETAIL_SCALE = 134.74f;
+const float DETAIL_EDGE_SHAPE = 0.6f; //the density quality of main.cpp
+const float DETAIL_NOISE_DISTANCE = 4000.0f;
+const float LOD_SCALE = 1.0f;
+const int WEATHER_MAP_SIZE = 512;
+
+struct CameraPose {
+    const char* name;
+    glm::vec2 angle;
+    glm::vec3 pos;
+};
+
+const CameraPose CAMERA_PATH[] = {
+    {"below, up 30", {0.0f, 30.0f}, {0.0f, 0.0f, 0.0f}},
+    {"below, up 12", {45.0f, 12.0f}, {0.0f, 0.0f, 0.0f}},
+    {"below, horizon", {100.0f, 4.0f}, {3000.0f, 0.0f, -2000.0f}},
+    {"below, up 60", {180.0f, 60.0f}, {0.0f, 0.0f, 0.0f}},
+    {"below, down 30", {270.0f, -30.0f}, {0.0f, 0.0f, 0.0f}},
+    {"inside, level", {20.0f, 0.0f}, {1200.0f, 700.0f, -800.0f}},
+    {"inside, down 25", {140.0f, -25.0f}, {1200.0f, 700.0f, -800.0f}},
+    {"above, down 30", {60.0f, -30.0f}, {-2500.0f, 1600.0f, 3000.0f}},
+    {"above, down 8", {230.0f, -8.0f}, {-2500.0f, 1600.0f, 3000.0f}},
+};
+
+//the full noise volume called name, loaded from the volume cache or baked, in a repeating mipmapped 3D texture
+GLuint uploadNoiseVolume(ThreadPool& pool, const std::vector<NoiseVolumeBuilder>& recipes, const char* name) {
+    auto recipe = std::find_if(recipes.begin(), recipes.end(), [&](const NoiseVolumeBuilder& r) { return r.name() == name; });
+    NoiseVolume volume;
+    if (recipe == recipes.end() || !recipe->build(volume)) {
+        std::cout << "No noise recipe called " << name << " in " << NOISE_RECIPES_PATH << "\n";
+        return 0;
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    volume.upload(pool, true);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_3D);
+    return texture;
+}
+
+//the full weather map of main.cpp in one dispatch
+GLuint createWeatherMap() {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, WEATHER_MAP_SIZE, WEATHER_MAP_SIZE, 0, GL_RGBA, GL_FLOAT, NULL);
+    Shader shader = Shader("./src/shaders/cloudNoise2DGen.comp", weatherMapNoiseStates().declarations());
+    glBindImageTexture(0, texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    shader.use();
+    shader.setInt("texelStep", 1);
+    shader.setInt("firstRow", 0);
+    dispatchCompute(shader.ID, WEATHER_MAP_SIZE, WEATHER_MAP_SIZE);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glDeleteProgram(shader.ID);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    return texture;
+}
+
+GLuint loadBlueNoise() {
+    int width, height, channels;
+    unsigned char* texels = stbi_load("./assets/BlueNoise470.png", &width, &height, &channels, 4);
+    if (!texels) {
+        std::cout << "Failed to load ./assets/BlueNoise470.png\n";
+        return 0;
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    stbi_image_free(texels);
+    return texture;
+}
+
+bool compiled(GLuint shader, const char* path) {
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[1024];
+        glGetShaderInfoLog(shader, sizeof(infoLog), NULL, infoLog);
+        std::cout << path << " failed to compile\n" << infoLog << "\n";
+    }
+    return success;
+}
+
+//fboVert.vert and cloudsFrag3.frag with COUNT_DENSITY_SAMPLES defined after its #version line and cloudDensity.glsl in
+//place of its #include CloudDensity like Shader does, 0 when it fails
+GLuint compileCloudProgram() {
+    const char* vertexPath = "./src/shaders/fboVert.vert";
+    const char* fragmentPath = "./src/shaders/cloudsFrag3.frag";
+    std::string vertexCode = readStringFromFile(vertexPath);
+    std::string fragmentCode = readStringFromFile(fragmentPath);
+    fragmentCode.insert(fragmentCode.find('\n') + 1, "#define COUNT_DENSITY_SAMPLES\n");
+    fragmentCode = preprocessString(fragmentCode, "#include CloudDensity", readStringFromFile("./src/shaders/cloudDensity.glsl"));
+    const char* vertexSource = vertexCode.c_str();
+    const char* fragmentSource = fragmentCode.c_str();
+    GLuint vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexSource, NULL);
+    glCompileShader(vertex);
+    GLuint fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentSource, NULL);
+    glCompileShader(fragment);
+    if (!compiled(vertex, vertexPath) || !compiled(fragment, fragmentPath)) return 0;
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success ? program : 0;
+}
+
+struct Frame {
+    double viewSamples, sunSamples, occupancyChecks, shapeSamples, detailSamples; //per pixel
+    double ms;
+    std::vector<unsigned char> pixels;
+};
+
+//renders pose into the framebuffer bound, the camera UBO and the textures are bound already
+Frame renderFrame(GLuint program, GLuint cameraUBO, GLuint counter, const CameraPose& pose, int cloudFrame) {
+    float camera[8] = {pose.angle.x, pose.angle.y, 0.0f, 0.0f, pose.pos.x, pose.pos.y, pose.pos.z, 0.0f};
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(camera), camera);
+    GLuint zeros[5] = {0, 0, 0, 0, 0};
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counter);
+    glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zeros), zeros);
+    glUniform1i(glGetUniformLocation(program, "cloudFrame"), cloudFrame);
+
+    Frame frame;
+    glFinish();
+    auto start = std::chrono::steady_clock::now();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    frame.ms = elapsed.count();
+    //all cloudDensity calls, those toward the sun, the occupancy checks and the shape and detail noise samples
+    GLuint counts[5];
+    glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counts), counts);
+    frame.viewSamples = (double)(counts[0] - counts[1]) / (CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE);
+    frame.sunSamples = (double)counts[1] / (CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE);
+    frame.occupancyChecks = (double)counts[2] / (CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE);
+    frame.shapeSamples = (double)counts[3] / (CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE);
+    frame.detailSamples = (double)counts[4] / (CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE);
+    frame.pixels.resize(CLOUD_BENCH_SIZE * CLOUD_BENCH_SIZE * 4);
+    glReadPixels(0, 0, CLOUD_BENCH_SIZE, CLOUD_BENCH_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, frame.pixels.data());
+    return frame;
+}
+
+int main() {
+    if (!createHeadlessContext()) return 1;
+    std::vector<NoiseVolumeBuilder> recipes;
+    if (!loadNoiseRecipes(NOISE_RECIPES_PATH, recipes)) return 1;
+    ThreadPool pool;
+    GLuint shapeNoise = uploadNoiseVolume(pool, recipes, "shape_noise");
+    GLuint detailNoise = uploadNoiseVolume(pool, recipes, "detail_noise");
+    //cloudsFrag3.frag samples the mip levels of the detail noise like main.cpp
+    glBindTexture(GL_TEXTURE_3D, detailNoise);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    GLuint weatherMap = createWeatherMap();
+    GLuint blueNoise = loadBlueNoise();
+    GLuint program = compileCloudProgram();
+    if (!shapeNoise || !detailNoise || !blueNoise || !program) return 1;
+
+    std::cout << std::fixed << std::setprecision(1);
+    CloudOccupancy occupancy;
+    glFinish();
+    auto bakeStart = std::chrono::steady_clock::now();
+    occupancy.bake(weatherMap, shapeNoise, CLOUD_COVERAGE);
+    glFinish();
+    std::chrono::duration<double, std::milli> bakeMs = std::chrono::steady_clock::now() - bakeStart;
+    std::cout << "Baked the occupancy maps in " << bakeMs.count() << " ms\n";
+    SunDepthVolume sunDepths;
+    sunDepths.bake(weatherMap, shapeNoise, detailNoise, CLOUD_COVERAGE, DETAIL_SCALE, DETAIL_EDGE_SHAPE);
+
+    float triangle[] = {
+        -1.0, -1.0, 0.0, 0.0,
+        3.0, -1.0, 2.0, 0.0,
+        -1.0, 3.0, 0.0, 2.0
+    };
+    GLuint vao, vbo;
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(triangle), triangle, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+    GLuint framebuffer, color;
+    glGenFramebuffers(1, &framebuffer);
+    glGenTextures(1, &color);
+    glBindTexture(GL_TEXTURE_2D, color);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, CLOUD_BENCH_SIZE, CLOUD_BENCH_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    glViewport(0, 0, CLOUD_BENCH_SIZE, CLOUD_BENCH_SIZE);
+
+    GLuint cameraUBO, counter;
+    glGenBuffers(1, &cameraUBO);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, cameraUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(float) * 8, NULL, GL_DYNAMIC_DRAW);
+    glGenBuffers(1, &counter);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counter);
+    glBufferData(GL_ATOMIC_COUNTER_BUFFER, 5 * sizeof(GLuint), NULL, GL_DYNAMIC_READ);
+
+    GLuint textures[][2] = {
+        {GL_TEXTURE_2D, weatherMap}, {GL_TEXTURE_3D, shapeNoise}, {GL_TEXTURE_3D, detailNoise}, {GL_TEXTURE_2D, blueNoise},
+        {GL_TEXTURE_3D, occupancy.shapeBounds}, {GL_TEXTURE_2D_ARRAY, occupancy.coverageBounds},
+        {GL_TEXTURE_3D, sunDepths.opticalDepth}
+    };
+    const char* samplers[] = {
+        "weatherMap", "shapeNoise", "detailNoise", "blueNoise", "shapeBounds", "coverageBounds", "sunOpticalDepth"
+    };
+    //binds the textures again after the sun depth volume bakes with some of them
+    auto bindTextures = [&]() {
+        for (int unit=0; unit<7; unit++) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(textures[unit][0], textures[unit][1]);
+        }
+        glUseProgram(program);
+    };
+    bindTextures();
+    for (int unit=0; unit<7; unit++) glUniform1i(glGetUniformLocation(program, samplers[unit]), unit);
+    glUniform2f(glGetUniformLocation(program, "resolution"), CLOUD_BENCH_RESOLUTION, CLOUD_BENCH_RESOLUTION);
+    glUniform1f(glGetUniformLocation(program, "invAspectRatio"), 1.0f);
+    glUniform1f(glGetUniformLocation(program, "b"), 3.61f);
+    glUniform1f(glGetUniformLocation(program, "exposure"), 0.5f);
+    glUniform1f(glGetUniformLocation(program, "detailScale"), DETAIL_SCALE);
+    glUniform1f(glGetUniformLocation(program, "hg"), 0.8f);
+    glUniform1f(glGetUniformLocation(program, "globalCoverage"), CLOUD_COVERAGE);
+    glUniform1i(glGetUniformLocation(program, "shapeBrickTexels"), SHAPE_BRICK_TEXELS);
+    glUniform1f(glGetUniformLocation(program, "sunDepthTexelSize"), SUN_DEPTH_TEXEL_SIZE);
+    GLint precomputedLocation = glGetUniformLocation(program, "precomputedSunLight");
+    glUniform1i(precomputedLocation, 0);
+    //the quality of the density, the first two comparisons sample the detail noise everywhere at its base level
+    auto setDensityQuality = [&](float edgeShape, float noiseDistance, float lodScale) {
+        glUniform1f(glGetUniformLocation(program, "detailEdgeShape"), edgeShape);
+        glUniform1f(glGetUniformLocation(program, "detailNoiseDistance"), noiseDistance);
+        glUniform1f(glGetUniformLocation(program, "lodScale"), lodScale);
+    };
+    setDensityQuality(1.0f, 1e10f, 0.0f);
+
+    std::cout << "cloudDensity calls per pixel along the view ray + toward the sun and ms per " << CLOUD_BENCH_SIZE << "x"
+        << CLOUD_BENCH_SIZE << " frame marching every step and skipping empty space, then view ray occupancy checks per\n"
+        << "pixel and ms skipping with single cells and with mip levels\n";
+    bool identical = true;
+    Frame march, cells, mips;
+    std::vector<Frame> marchedLight;
+    double marchView = 0.0, marchSun = 0.0, skipView = 0.0, skipSun = 0.0;
+    double marchMs = 0.0, cellsMs = 0.0, mipsMs = 0.0, cellsChecks = 0.0, mipsChecks = 0.0;
+    GLint skipLocation = glGetUniformLocation(program, "skipEmptySpace");
+    GLint levelsLocation = glGetUniformLocation(program, "occupancyLevels");
+    int cloudFrame = 0;
+    for (const CameraPose& pose : CAMERA_PATH) {
+        glUniform1i(skipLocation, 0);
+        march = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        glUniform1i(skipLocation, 1);
+        glUniform1i(levelsLocation, 1);
+        cells = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        glUniform1i(levelsLocation, 16); //all the maps have
+        mips = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        cloudFrame = (cloudFrame + 1) % 16;
+        marchedLight.push_back(mips);
+
+        int differing = 0;
+        for (size_t i=0; i<march.pixels.size(); i+=4) {
+            differing += !std::equal(&march.pixels[i], &march.pixels[i + 4], &cells.pixels[i])
+                || !std::equal(&march.pixels[i], &march.pixels[i + 4], &mips.pixels[i]);
+        }
+        identical &= differing == 0;
+        marchView += march.viewSamples;
+        marchSun += march.sunSamples;
+        skipView += mips.viewSamples;
+        skipSun += mips.sunSamples;
+        marchMs += march.ms;
+        cellsMs += cells.ms;
+        mipsMs += mips.ms;
+        cellsChecks += cells.occupancyChecks;
+        mipsChecks += mips.occupancyChecks;
+        std::cout << std::left << std::setw(16) << pose.name << std::right
+            << " march " << std::setw(6) << march.viewSamples << " + " << std::setw(6) << march.sunSamples
+            << std::setw(8) << march.ms << " ms"
+            << "  skip " << std::setw(6) << mips.viewSamples << " + " << std::setw(6) << mips.sunSamples
+            << "  cells " << std::setw(6) << cells.occupancyChecks << std::setw(8) << cells.ms << " ms"
+            << "  mips " << std::setw(6) << mips.occupancyChecks << std::setw(8) << mips.ms << " ms"
+            << (differing ? "  " + std::to_string(differing) + " PIXELS DIFFER" : "  same image") << "\n";
+    }
+    std::cout << std::setprecision(2) << "Camera path: " << marchView / skipView << "x fewer samples along the view ray, "
+        << (marchView + marchSun) / (skipView + skipSun) << "x fewer in all, " << marchMs / cellsMs
+        << "x faster with single cells, " << cellsChecks / mipsChecks << "x fewer occupancy checks and " << marchMs / mipsMs
+        << "x faster with mip levels\n";
+    std::cout << (identical ? "Skipping empty space leaves every frame unchanged\n" : "FAILED\n");
+
+    std::cout << std::setprecision(1) << "\ncloudDensity calls per pixel toward the sun, ms per frame and the mean and largest "
+        << "difference of a color channel from\nmarching toward the sun, lighting from the sun depth volume, and ms to move "
+        << "the volume's window to the camera\n";
+    glUniform1i(precomputedLocation, 1);
+    double volumeMs = 0.0, followMs = 0.0, volumeSun = 0.0;
+    cloudFrame = 0;
+    for (size_t i=0; i<std::size(CAMERA_PATH); i++) {
+        const CameraPose& pose = CAMERA_PATH[i];
+        glFinish();
+        auto followStart = std::chrono::steady_clock::now();
+        sunDepths.follow(pose.pos);
+        glFinish();
+        std::chrono::duration<double, std::milli> poseFollowMs = std::chrono::steady_clock::now() - followStart;
+        bindTextures();
+        glm::vec4 bounds = sunDepths.bounds();
+        glUniform4f(glGetUniformLocation(program, "sunDepthBounds"), bounds.x, bounds.y, bounds.z, bounds.w);
+        Frame volume = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        cloudFrame = (cloudFrame + 1) % 16;
+
+        const std::vector<unsigned char>& marched = marchedLight[i].pixels;
+        double difference = 0.0;
+        int largest = 0;
+        for (size_t c=0; c<marched.size(); c++) {
+            int channel = std::abs((int)volume.pixels[c] - (int)marched[c]);
+            difference += channel;
+            largest = std::max(largest, channel);
+        }
+        volumeMs += volume.ms;
+        followMs += poseFollowMs.count();
+        volumeSun += volume.sunSamples;
+        std::cout << std::left << std::setw(16) << pose.name << std::right
+            << " marched " << std::setw(6) << marchedLight[i].sunSamples << std::setw(8) << marchedLight[i].ms << " ms"
+            << "  volume " << std::setw(6) << volume.sunSamples << std::setw(8) << volume.ms << " ms"
+            << "  difference " << std::setprecision(2) << std::setw(5) << difference / marched.size() << std::setw(4) << largest
+            << "  window " << std::setprecision(1) << std::setw(7) << poseFollowMs.count() << " ms\n";
+    }
+    std::cout << std::setprecision(2) << "Camera path: " << skipSun / volumeSun << "x fewer samples toward the sun, "
+        << mipsMs / volumeMs << "x faster, the window moved in " << followMs << " ms\n";
+
+    std::cout << std::setprecision(1) << "\ncloudDensity calls and shape noise samples per pixel lit from the sun depth volume, "
+        << "then detail noise samples per pixel\nand ms per frame sampling it everywhere at its base level and at the quality "
+        << "main.cpp sets, and the mean and largest\ndifference of a color channel\n";
+    double calls = 0.0, shapeSamples = 0.0, fullDetail = 0.0, qualityDetail = 0.0, fullMs = 0.0, qualityMs = 0.0;
+    cloudFrame = 0;
+    for (const CameraPose& pose : CAMERA_PATH) {
+        sunDepths.follow(pose.pos);
+        bindTextures();
+        glm::vec4 bounds = sunDepths.bounds();
+        glUniform4f(glGetUniformLocation(program, "sunDepthBounds"), bounds.x, bounds.y, bounds.z, bounds.w);
+        setDensityQuality(1.0f, 1e10f, 0.0f);
+        Frame full = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        setDensityQuality(DETAIL_EDGE_SHAPE, DETAIL_NOISE_DISTANCE, LOD_SCALE);
+        Frame quality = renderFrame(program, cameraUBO, counter, pose, cloudFrame);
+        cloudFrame = (cloudFrame + 1) % 16;
+
+        double difference = 0.0;
+        int largest = 0;
+        for (size_t c=0; c<full.pixels.size(); c++) {
+            int channel = std::abs((int)quality.pixels[c] - (int)full.pixels[c]);
+            difference += channel;
+            largest = std::max(largest, channel);
+        }
+        calls += full.viewSamples + full.sunSamples;
+        shapeSamples += full.shapeSamples;
+        fullDetail += full.detailSamples;
+        qualityDetail += quality.detailSamples;
+        fullMs += full.ms;
+        qualityMs += quality.ms;
+        std::cout << std::left << std::setw(16) << pose.name << std::right
+            << " calls " << std::setw(6) << full.viewSamples + full.sunSamples << "  shape " << std::setw(6) << full.shapeSamples
+            << "  full " << std::setw(6) << full.detailSamples << std::setw(8) << full.ms << " ms"
+            << "  quality " << std::setw(6) << quality.detailSamples << std::setw(8) << quality.ms << " ms"
+            << "  difference " << std::setprecision(2) << std::setw(5) << difference / full.pixels.size() << std::setw(4)
+            << largest << std::setprecision(1) << "\n";
+    }
+    std::cout << std::setprecision(2) << "Camera path: " << calls / shapeSamples << "x fewer shape noise samples and "
+        << calls / fullDetail << "x fewer detail noise samples than cloudDensity calls, " << calls / qualityDetail
+        << "x fewer at the quality main.cpp sets, " << fullMs / qualityMs << "x faster\n";
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+//GL context without a window for the GPU benches. On Linux it is a surfaceless EGL context, so the benches run without
+//a display, and without a GPU through Mesa's llvmpipe (LIBGL_ALWAYS_SOFTWARE=1 picks llvmpipe on any machine). On
+//Windows it is a hidden GLFW window, llvmpipe there is Mesa's opengl32.dll next to the executable.
+//Prints why and returns false when there is no GL 4.5 core context.
+bool createHeadlessContext();
+
+#ifdef _WIN32
+bool createHeadlessContext() {
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return false;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1, 1, "bench", NULL, NULL);
+    if (window == NULL) {
+        std::cout << "Failed to create a GL 4.5 context" << std::endl;
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << "\n";
+    return true;
+}
+#else
+bool createHeadlessContext() {
+    //llvmpipe implements GL 4.6 but reports 4.5, the shaders ask for #version 460
+    setenv("MESA_GL_VERSION_OVERRIDE", "4.6", 0);
+    setenv("MESA_GLSL_VERSION_OVERRIDE", "460", 0);
+    EGLDisplay display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        std::cout << "Failed to initialize a surfaceless EGL display" << std::endl;
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cout << "Failed to create a GL 4.5 context (EGL error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << "\n";
+    return true;
+}
+#endif
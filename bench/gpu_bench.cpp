@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gl_context.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "FastNoiseLite.h"
+#include "gpu_noise.h"
+#include "noise_volume.h"
+#include "shader_reader.h"
+#include "thread_pool.h"
+
+//Throughput of the GPU noise bakes on a headless GL context, and their output against the plain GLSL port.
+//worleyNoise3DGen.comp searches feature points its workgroup cached in shared memory, it has to store exactly what
+//noise3DGen.comp stores through fnlGetNoise3D for the cellular generators of assets/cloud_noise.txt and a spread of
+//cellular settings.
+//Then every noise type x fractal type (x distance function for cellular) is baked over the same grid by
+//FastNoiseLite.h and by noise3DGen.comp, to check the GLSL port against the CPU and to time both: GetNoise on one core,
+//GetNoiseBatch rows on all cores like the CPU bakes, and the GPU dispatch. The GPU has to stay within
+//CROSS_MAX_ERROR of GetNoise, the faster bake path is printed per configuration.
+//Then fnlGetNoiseWithGradient2D/3D runs through noiseGradient3DGen.comp for the noise types it differentiates: its value
+//has to equal fnlGetNoise2D/3D and its gradient has to match finite differences of fnlGetNoise2D/3D on the GPU, by the
+//rules bench/kernel_bench.cpp checks GetNoiseWithGradient with. Its cost is printed relative to fnlGetNoise2D/3D.
+//fnlGetNoiseClamped3D runs through noiseClamped3DGen.comp for bench/kernel_bench.cpp's clamped configs and intervals, it
+//has to store exactly fnlGetNoise3D clamped to the interval, its speedup from skipping octaves is printed.
+//Last every recipe of assets/cloud_noise.txt bakes through cloudNoise3DGen.comp with the channel expressions
+//NoiseVolumeBuilder::glslChannels writes for it, its texels have to stay within RECIPE_MAX_STEPS of the CPU bake.
+//Run from the repository root. Without a GPU it runs on Mesa's llvmpipe, on Linux LIBGL_ALWAYS_SOFTWARE=1 forces that.
+
+const char* NOISE_RECIPES_PATH = "./assets/cloud_noise.txt";
+const char* NOISE_SHADER_PATH = "./src/shaders/noise3DGen.comp";
+const char* WORLEY_SHADER_PATH = "./src/shaders/worleyNoise3DGen.comp";
+const char* GRADIENT_SHADER_PATH = "./src/shaders/noiseGradient3DGen.comp";
+const char* CLAMPED_SHADER_PATH = "./src/shaders/noiseClamped3DGen.comp";
+const char* RECIPE_SHADER_PATH = "./src/shaders/cloudNoise3DGen.comp";
+const int GPU_BENCH_VOLUME_SIZE = 64;
+const int GPU_BENCH_RUNS = 3;
+const float GPU_BENCH_FREQUENCY = 0.05f;
+//grid both paths sample, off the integer lattice like bench/kernel_bench.cpp's
+const float CROSS_GRID_ORIGIN[3] = {-13.7f, 5.3f, 101.9f};
+const float CROSS_GRID_SPACING = 0.61f;
+const double CROSS_MAX_ERROR = 1e-5; //the ports round differently, a few ulp apart
+const int GRADIENT_GRID_SIZE_2D = 128;
+const int GRADIENT_GRID_SIZE_3D = 32;
+//finite difference step in noise units, a power of two so the stepped coordinates stay exact in float, about a
+//thousandth of a cell like bench/kernel_bench.cpp's
+const float GRADIENT_STEP = 1.0f / 64.0f;
+//bench/kernel_bench.cpp's gradient tolerances
+const double GRADIENT_TOLERANCE = 2e-3;
+const double GRADIENT_ONE_SIDED_SLACK = 4.0;
+const double GRADIENT_OUTLIER_FRACTION = 1e-2;
+//bench/kernel_bench.cpp's octaves of the clamped fractals and the intervals it clamps them to
+const int CLAMPED_OCTAVES = 5;
+const float CLAMPED_INTERVALS[][2] = {{0.3f, 1.0f}, {-1.0f, -0.3f}, {-0.1f, 0.1f}};
+//unorm8 steps a GPU texel may be off the CPU bake, fnlGetNoise3D and GetNoise are a few ulp apart and round to
+//the neighbouring step near its midpoint
+const int RECIPE_MAX_STEPS = 1;
+//recipe and generator of the cellular noise the clouds bake
+const char* RECIPE_WORLEY_NOISES[][2] = {
+    {"shape_noise", "worley_r"}, {"shape_noise", "worley_g"}, {"shape_noise", "worley_b"}, {"shape_noise", "worley_a"},
+    {"detail_noise", "detail_r"}, {"detail_noise", "detail_g"}, {"detail_noise", "detail_b"}
+};
+
+struct NoiseConfig {
+    std::string name;
+    FastNoiseLite noise;
+};
+
+struct GradientConfig {
+    std::string name;
+    FastNoiseLite noise;
+    int dimensions;
+};
+
+const char* noiseTypeName(FastNoiseLite::NoiseType type) {
+    const char* names[] = {"opensimplex2", "opensimplex2s", "cellular", "perlin", "valuecubic", "value"};
+    return names[type];
+}
+
+const char* fractalTypeName(FastNoiseLite::FractalType type) {
+    const char* names[] = {"none", "fbm", "ridged", "pingpong"};
+    return names[type];
+}
+
+const char* distanceFunctionName(FastNoiseLite::CellularDistanceFunction function) {
+    const char* names[] = {"euclidean", "euclideansq", "manhattan", "hybrid"};
+    return names[function];
+}
+
+std::vector<NoiseConfig> worleyConfigs(const std::vector<NoiseVolumeBuilder>& recipes) {
+    typedef FastNoiseLite FNL;
+    std::vector<NoiseConfig> configs;
+    for (const auto& entry : RECIPE_WORLEY_NOISES) {
+        auto recipe = std::find_if(recipes.begin(), recipes.end(), [&](const NoiseVolumeBuilder& r) { return r.name() == entry[0]; });
+        const FastNoiseLite* noise = recipe == recipes.end() ? nullptr : recipe->findNoise(entry[1]);
+        if (!noise) {
+            std::cout << "No generator " << entry[1] << " in " << entry[0] << " of " << NOISE_RECIPES_PATH << "\n";
+            continue;
+        }
+        configs.push_back({std::string(entry[0]) + "." + entry[1], *noise});
+    }
+    for (int distance=FNL::CellularDistanceFunction_Euclidean; distance<=FNL::CellularDistanceFunction_Hybrid; distance++) {
+        for (int fractal=FNL::FractalType_None; fractal<=FNL::FractalType_PingPong; fractal++) {
+            NoiseConfig config;
+            config.noise.SetNoiseType(FNL::NoiseType_Cellular);
+            config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+            config.noise.SetCellularDistanceFunction((FNL::CellularDistanceFunction)distance);
+            config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance);
+            config.noise.SetFractalType((FNL::FractalType)fractal);
+            config.noise.SetFractalOctaves(3);
+            config.name = std::string("cellular_") + distanceFunctionName((FNL::CellularDistanceFunction)distance) + "_"
+                + fractalTypeName((FNL::FractalType)fractal);
+            configs.push_back(config);
+        }
+    }
+    //return types that use the second distance and the closest hash, a rotated domain, a periodic one, and octaves
+    //too fine for the shared memory cache
+    NoiseConfig config;
+    config.noise.SetNoiseType(FNL::NoiseType_Cellular);
+    config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+    config.name = "cellular_cellvalue";
+    config.noise.SetCellularReturnType(FNL::CellularReturnType_CellValue);
+    configs.push_back(config);
+    config.name = "cellular_distance2div_jitter1.5";
+    config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance2Div);
+    config.noise.SetCellularJitter(1.5f);
+    configs.push_back(config);
+    config.name = "cellular_improvexy_fbm";
+    config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance);
+    config.noise.SetCellularJitter(1.0f);
+    config.noise.SetRotationType3D(FNL::RotationType3D_ImproveXYPlanes);
+    config.noise.SetFractalType(FNL::FractalType_FBm);
+    config.noise.SetFractalOctaves(3);
+    configs.push_back(config);
+    config.name = "cellular_period4_fbm";
+    config.noise.SetRotationType3D(FNL::RotationType3D_None);
+    setTilingFrequency(config.noise, 4, GPU_BENCH_VOLUME_SIZE);
+    configs.push_back(config);
+    config.name = "cellular_frequency0.6_fbm5";
+    config.noise.SetPeriod(0);
+    config.noise.SetFrequency(0.6f);
+    config.noise.SetFractalOctaves(5);
+    configs.push_back(config);
+    return configs;
+}
+
+std::vector<NoiseConfig> crossConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<NoiseConfig> configs;
+    for (int type=FNL::NoiseType_OpenSimplex2; type<=FNL::NoiseType_Value; type++) {
+        int distanceFunctions = type == FNL::NoiseType_Cellular ? 4 : 1;
+        for (int distance=0; distance<distanceFunctions; distance++) {
+            for (int fractal=FNL::FractalType_None; fractal<=FNL::FractalType_PingPong; fractal++) {
+                NoiseConfig config;
+                config.noise.SetNoiseType((FNL::NoiseType)type);
+                config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+                config.noise.SetFractalType((FNL::FractalType)fractal);
+                config.noise.SetFractalOctaves(3);
+                config.name = noiseTypeName((FNL::NoiseType)type);
+                if (type == FNL::NoiseType_Cellular) {
+                    config.noise.SetCellularDistanceFunction((FNL::CellularDistanceFunction)distance);
+                    config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance);
+                    config.name += std::string("_") + distanceFunctionName((FNL::CellularDistanceFunction)distance);
+                }
+                config.name += std::string("_") + fractalTypeName((FNL::FractalType)fractal);
+                configs.push_back(config);
+            }
+        }
+    }
+    NoiseConfig config;
+    config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+    config.noise.SetFractalType(FNL::FractalType_FBm);
+    config.name = "opensimplex2_improvexy_fbm";
+    config.noise.SetRotationType3D(FNL::RotationType3D_ImproveXYPlanes);
+    configs.push_back(config);
+    config.name = "opensimplex2s_improvexz_fbm";
+    config.noise.SetNoiseType(FNL::NoiseType_OpenSimplex2S);
+    config.noise.SetRotationType3D(FNL::RotationType3D_ImproveXZPlanes);
+    configs.push_back(config);
+    config.name = "cellular_cellvalue";
+    config.noise.SetNoiseType(FNL::NoiseType_Cellular);
+    config.noise.SetRotationType3D(FNL::RotationType3D_None);
+    config.noise.SetFractalType(FNL::FractalType_None);
+    config.noise.SetCellularReturnType(FNL::CellularReturnType_CellValue);
+    configs.push_back(config);
+    config.name = "cellular_distance2div";
+    config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance2Div);
+    configs.push_back(config);
+    return configs;
+}
+
+//the noise types fnlGetNoiseWithGradient2D/3D differentiates analytically, with the 3D rotations added for fbm
+std::vector<GradientConfig> gradientConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<GradientConfig> configs;
+    FNL::NoiseType types[] = {FNL::NoiseType_OpenSimplex2, FNL::NoiseType_Perlin, FNL::NoiseType_Value};
+    for (int dimensions=2; dimensions<=3; dimensions++) {
+        for (FNL::NoiseType type : types) {
+            for (int fractal=FNL::FractalType_None; fractal<=FNL::FractalType_PingPong; fractal++) {
+                GradientConfig config;
+                config.dimensions = dimensions;
+                config.noise.SetNoiseType(type);
+                config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+                config.noise.SetFractalType((FNL::FractalType)fractal);
+                config.noise.SetFractalOctaves(3);
+                config.name = std::string(noiseTypeName(type)) + "_" + fractalTypeName((FNL::FractalType)fractal) + "_"
+                    + std::to_string(dimensions) + "d";
+                configs.push_back(config);
+                if (dimensions != 3 || fractal != FNL::FractalType_FBm) continue;
+                const char* rotationNames[] = {"", "_improvexy", "_improvexz"};
+                for (int rotation=FNL::RotationType3D_ImproveXYPlanes; rotation<=FNL::RotationType3D_ImproveXZPlanes; rotation++) {
+                    GradientConfig rotated = config;
+                    rotated.noise.SetRotationType3D((FNL::RotationType3D)rotation);
+                    rotated.noise.SetFractalWeightedStrength(0.5f);
+                    rotated.name += rotationNames[rotation];
+                    configs.push_back(rotated);
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+//the fbm, ridged and pingpong configs fnlGetNoiseClamped3D culls octaves for, cellular distance returns never cull
+std::vector<NoiseConfig> clampedConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<NoiseConfig> configs;
+    for (int type=FNL::NoiseType_OpenSimplex2; type<=FNL::NoiseType_Value; type++) {
+        if (type == FNL::NoiseType_Cellular) continue;
+        for (int fractal=FNL::FractalType_FBm; fractal<=FNL::FractalType_PingPong; fractal++) {
+            NoiseConfig config;
+            config.noise.SetNoiseType((FNL::NoiseType)type);
+            config.noise.SetFrequency(GPU_BENCH_FREQUENCY);
+            config.noise.SetFractalType((FNL::FractalType)fractal);
+            config.noise.SetFractalOctaves(CLAMPED_OCTAVES);
+            config.name = std::string(noiseTypeName((FNL::NoiseType)type)) + "_" + fractalTypeName((FNL::FractalType)fractal);
+            configs.push_back(config);
+        }
+    }
+    return configs;
+}
+
+bool linked(const Shader& shader) {
+    GLint success;
+    glGetProgramiv(shader.ID, GL_LINK_STATUS, &success);
+    return success;
+}
+
+//best of GPU_BENCH_RUNS bakes of shader into volume in ms, each waited for
+double bakeTime(Shader& shader, GLuint volume, int size) {
+    double best = 1e30;
+    glBindImageTexture(0, volume, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R32F);
+    shader.use();
+    for (int run=0; run<GPU_BENCH_RUNS; run++) {
+        glFinish();
+        auto start = std::chrono::steady_clock::now();
+        dispatchCompute(shader.ID, size, size, size);
+        glFinish();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    return best;
+}
+
+std::vector<float> readVolume(GLuint volume, int size) {
+    std::vector<float> values((size_t)size * size * size);
+    glGetTextureImage(volume, 0, GL_RED, GL_FLOAT, values.size() * sizeof(float), values.data());
+    return values;
+}
+
+bool checkWorley(const NoiseConfig& config, GLuint volume, int size) {
+    NoiseStates plainStates, worleyStates;
+    plainStates.add("noise", config.noise);
+    worleyStates.add("worley", config.noise);
+    Shader plainShader = Shader(NOISE_SHADER_PATH, plainStates.declarations());
+    Shader worleyShader = Shader(WORLEY_SHADER_PATH, worleyStates.declarations());
+    if (!linked(plainShader) || !linked(worleyShader)) {
+        std::cout << config.name << " COMPILE FAILED\n";
+        return false;
+    }
+
+    double plainMs = bakeTime(plainShader, volume, size);
+    std::vector<float> plain = readVolume(volume, size);
+    double worleyMs = bakeTime(worleyShader, volume, size);
+    std::vector<float> worley = readVolume(volume, size);
+    glDeleteProgram(plainShader.ID);
+    glDeleteProgram(worleyShader.ID);
+
+    size_t mismatches = 0;
+    double maxError = 0.0;
+    for (size_t i=0; i<plain.size(); i++) {
+        if (memcmp(&plain[i], &worley[i], sizeof(float)) != 0) mismatches++;
+        maxError = std::max(maxError, (double)std::fabs(plain[i] - worley[i]));
+    }
+    int count = size * size * size;
+    std::cout << std::left << std::setw(36) << config.name << std::right
+        << " fnlGetNoise3D " << std::setw(7) << plainMs * 1e6 / count
+        << "  shared " << std::setw(7) << worleyMs * 1e6 / count
+        << "  | " << std::setprecision(2) << plainMs / worleyMs << "x" << std::setprecision(1);
+    if (mismatches == 0) {
+        std::cout << "  ok\n";
+        return true;
+    }
+    std::cout << "  MISMATCH in " << mismatches << " texels, max error " << std::scientific << maxError << std::fixed << "\n";
+    return false;
+}
+
+//bakes config over the cross grid with FastNoiseLite.h and noise3DGen.comp, counts the configurations the GPU bakes faster
+bool crossValidate(const NoiseConfig& config, ThreadPool& pool, GLuint volume, int size, int& gpuFaster) {
+    int count = size * size * size;
+    std::vector<float> xs(count), ys(count), zs(count);
+    for (int i=0; i<count; i++) {
+        xs[i] = CROSS_GRID_ORIGIN[0] + (i % size) * CROSS_GRID_SPACING;
+        ys[i] = CROSS_GRID_ORIGIN[1] + (i / size % size) * CROSS_GRID_SPACING;
+        zs[i] = CROSS_GRID_ORIGIN[2] + (i / size / size) * CROSS_GRID_SPACING;
+    }
+    std::vector<float> cpu(count), threaded(count);
+    auto timed = [](auto fill) {
+        double best = 1e30;
+        for (int run=0; run<GPU_BENCH_RUNS; run++) {
+            auto start = std::chrono::steady_clock::now();
+            fill();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    };
+    double cpuMs = timed([&]() {
+        for (int i=0; i<count; i++) cpu[i] = config.noise.GetNoise(xs[i], ys[i], zs[i]);
+    });
+    double threadedMs = timed([&]() {
+        pool.parallelFor(count / size, [&](int row) {
+            int start = row * size;
+            config.noise.GetNoiseBatch(&xs[start], &ys[start], &zs[start], &threaded[start], size);
+        });
+    });
+
+    NoiseStates states;
+    states.add("noise", config.noise);
+    Shader shader = Shader(NOISE_SHADER_PATH, states.declarations());
+    if (!linked(shader)) {
+        std::cout << config.name << " COMPILE FAILED\n";
+        return false;
+    }
+    shader.use();
+    shader.setVec3("origin", glm::vec3(CROSS_GRID_ORIGIN[0], CROSS_GRID_ORIGIN[1], CROSS_GRID_ORIGIN[2]));
+    shader.setFloat("spacing", CROSS_GRID_SPACING);
+    double gpuMs = bakeTime(shader, volume, size);
+    std::vector<float> gpu = readVolume(volume, size);
+    glDeleteProgram(shader.ID);
+
+    double maxError = 0.0, errorSum = 0.0;
+    for (int i=0; i<count; i++) {
+        double error = std::fabs((double)cpu[i] - gpu[i]);
+        maxError = std::max(maxError, error);
+        errorSum += error;
+    }
+    bool gpuWins = gpuMs < threadedMs;
+    gpuFaster += gpuWins;
+    std::cout << std::left << std::setw(36) << config.name << std::right
+        << " cpu " << std::setw(6) << cpuMs * 1e6 / count
+        << "  " << pool.threadCount() << "t " << std::setw(6) << threadedMs * 1e6 / count
+        << "  gpu " << std::setw(7) << gpuMs * 1e6 / count
+        << "  " << (gpuWins ? "gpu" : "cpu")
+        << "  | error max " << std::scientific << std::setprecision(1) << maxError
+        << " mean " << errorSum / count << std::fixed;
+    if (maxError <= CROSS_MAX_ERROR) {
+        std::cout << "  ok\n";
+        return true;
+    }
+    std::cout << "  DIFFERS\n";
+    return false;
+}
+
+//value must equal fnlGetNoise2D/3D, the gradient has to match finite differences of fnlGetNoise2D/3D. Like
+//bench/kernel_bench.cpp's checkGradients, one sided second order differences are accepted where the central one
+//straddles a fold or a seam, and a small share of samples boxed in by two of them may miss. volumes are rgba32f, a
+//GRADIENT_GRID_SIZE_2D^2 x 1 one for 2D and a GRADIENT_GRID_SIZE_3D^3 one for 3D
+bool checkGlslGradients(const GradientConfig& config, const GLuint volumes[2]) {
+    int size = config.dimensions == 2 ? GRADIENT_GRID_SIZE_2D : GRADIENT_GRID_SIZE_3D;
+    int depth = config.dimensions == 2 ? 1 : size;
+    size_t count = (size_t)size * size * depth;
+    NoiseStates states;
+    states.add("noise", config.noise);
+    Shader shader = Shader(GRADIENT_SHADER_PATH, states.declarations());
+    if (!linked(shader)) {
+        std::cout << config.name << " COMPILE FAILED\n";
+        return false;
+    }
+    shader.use();
+    shader.setVec3("origin", glm::vec3(CROSS_GRID_ORIGIN[0], CROSS_GRID_ORIGIN[1], CROSS_GRID_ORIGIN[2]));
+    shader.setFloat("spacing", CROSS_GRID_SPACING);
+    shader.setInt("dimensions", config.dimensions);
+    GLuint volume = volumes[config.dimensions - 2];
+    glBindImageTexture(0, volume, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    //best of runs dispatches in ms, texels gets value and gradient of every texel
+    auto bake = [&](bool withGradient, glm::vec3 offset, int runs, std::vector<float>& texels) {
+        shader.setBool("withGradient", withGradient);
+        shader.setVec3("offset", offset);
+        double best = 1e30;
+        for (int run=0; run<runs; run++) {
+            glFinish();
+            auto start = std::chrono::steady_clock::now();
+            dispatchCompute(shader.ID, size, size, depth);
+            glFinish();
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+        texels.resize(count * 4);
+        glGetTextureImage(volume, 0, GL_RGBA, GL_FLOAT, texels.size() * sizeof(float), texels.data());
+        return best;
+    };
+    std::vector<float> gradients, values;
+    double gradientMs = bake(true, glm::vec3(0.0f), GPU_BENCH_RUNS, gradients);
+    double valueMs = bake(false, glm::vec3(0.0f), GPU_BENCH_RUNS, values);
+    //steps[axis][s + 2] is the noise s steps along axis
+    std::vector<float> steps[3][5];
+    for (int axis=0; axis<config.dimensions; axis++) {
+        for (int step=-2; step<=2; step++) {
+            glm::vec3 offset(0.0f);
+            offset[axis] = step * GRADIENT_STEP;
+            if (step != 0) bake(false, offset, 1, steps[axis][step + 2]);
+        }
+    }
+    glDeleteProgram(shader.ID);
+
+    //compare in noise per cell, where the gradients of all configs have similar sizes
+    double stepCells = GRADIENT_STEP * GPU_BENCH_FREQUENCY;
+    size_t valueMismatches = 0, outliers = 0;
+    double maxError = 0;
+    for (size_t i=0; i<count; i++) {
+        valueMismatches += gradients[i * 4] != values[i * 4];
+        double error = 0, magnitude = 0;
+        for (int axis=0; axis<config.dimensions; axis++) {
+            double f[5];
+            for (int step=-2; step<=2; step++) f[step + 2] = step == 0 ? values[i * 4] : steps[axis][step + 2][i * 4];
+            double central = (f[3] - f[1]) / (2 * stepCells);
+            double backward = (3 * f[2] - 4 * f[1] + f[0]) / (2 * stepCells);
+            double forward = (-3 * f[2] + 4 * f[3] - f[4]) / (2 * stepCells);
+            double analytic = gradients[i * 4 + 1 + axis] / GPU_BENCH_FREQUENCY;
+            double oneSided = std::min(std::abs(analytic - backward), std::abs(analytic - forward)) / GRADIENT_ONE_SIDED_SLACK;
+            error = std::max(error, std::min(std::abs(analytic - central), oneSided));
+            magnitude = std::max(magnitude, std::abs(analytic));
+        }
+        error /= std::max(magnitude, 1.0);
+        maxError = std::max(maxError, error);
+        if (error > GRADIENT_TOLERANCE) outliers++;
+    }
+
+    std::string failures;
+    if (valueMismatches) failures += " VALUE MISMATCH in " + std::to_string(valueMismatches) + " texels";
+    if (outliers > count * GRADIENT_OUTLIER_FRACTION) failures += " GRADIENT MISMATCH";
+    std::cout << std::left << std::setw(36) << config.name << std::right
+        << " gradient " << std::setprecision(2) << gradientMs / valueMs << "x fnlGetNoise, max error "
+        << std::scientific << maxError << std::fixed << std::setprecision(1) << ", " << outliers << " outliers"
+        << (failures.empty() ? "  ok" : failures) << "\n";
+    return failures.empty();
+}
+
+//noiseClamped3DGen.comp must store noise3DGen.comp's texels clamped to each interval bit for bit, timed against the
+//full sum
+bool checkClamped(const NoiseConfig& config, GLuint volume, int size) {
+    NoiseStates states;
+    states.add("noise", config.noise);
+    Shader plainShader = Shader(NOISE_SHADER_PATH, states.declarations());
+    Shader clampedShader = Shader(CLAMPED_SHADER_PATH, states.declarations());
+    if (!linked(plainShader) || !linked(clampedShader)) {
+        std::cout << config.name << " COMPILE FAILED\n";
+        return false;
+    }
+    double plainMs = bakeTime(plainShader, volume, size);
+    std::vector<float> plain = readVolume(volume, size);
+
+    std::string failures;
+    std::cout << std::left << std::setw(36) << config.name << std::right;
+    for (const float* interval : CLAMPED_INTERVALS) {
+        float low = interval[0], high = interval[1];
+        clampedShader.use();
+        clampedShader.setFloat("low", low);
+        clampedShader.setFloat("high", high);
+        double clampedMs = bakeTime(clampedShader, volume, size);
+        std::vector<float> clamped = readVolume(volume, size);
+        size_t mismatches = 0, saturated = 0;
+        for (size_t i=0; i<plain.size(); i++) {
+            float expected = std::clamp(plain[i], low, high);
+            mismatches += clamped[i] != expected;
+            saturated += expected == low || expected == high;
+        }
+        if (mismatches) failures += " MISMATCH in " + std::to_string(mismatches) + " texels";
+        std::cout << "  [" << std::setprecision(1) << std::showpos << low << ", " << high << std::noshowpos << "] "
+            << std::setw(3) << saturated * 100 / plain.size() << "% out " << std::setprecision(2) << plainMs / clampedMs << "x";
+    }
+    glDeleteProgram(plainShader.ID);
+    glDeleteProgram(clampedShader.ID);
+    std::cout << std::setprecision(1) << (failures.empty() ? "  ok" : failures) << "\n";
+    return failures.empty();
+}
+
+//bakes recipe on the CPU and through cloudNoise3DGen.comp and compares the stored unorm8 texels
+bool checkRecipe(const NoiseVolumeBuilder& recipe, ThreadPool& pool) {
+    NoiseVolume volume;
+    NoiseStates states;
+    if (!recipe.build(volume) || !recipe.glslChannels("recipeChannels", states)) return false;
+    Shader shader = Shader(RECIPE_SHADER_PATH, states.declarations());
+    if (!linked(shader)) {
+        std::cout << recipe.name() << " COMPILE FAILED\n";
+        return false;
+    }
+    int width = recipe.width(), height = recipe.height(), depth = recipe.depth();
+    size_t bytes = (size_t)width * height * depth * 4;
+    GLuint textures[2];
+    glGenTextures(2, textures);
+    glBindTexture(GL_TEXTURE_3D, textures[0]);
+    auto cpuStart = std::chrono::steady_clock::now();
+    volume.upload(pool, false);
+    glFinish();
+    std::chrono::duration<double, std::milli> cpuMs = std::chrono::steady_clock::now() - cpuStart;
+    std::vector<unsigned char> cpu(bytes), gpu(bytes);
+    glGetTextureImage(textures[0], 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes, cpu.data());
+
+    glBindTexture(GL_TEXTURE_3D, textures[1]);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA8, width, height, depth);
+    glBindImageTexture(0, textures[1], 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    shader.use();
+    auto gpuStart = std::chrono::steady_clock::now();
+    dispatchCompute(shader.ID, width, height, depth);
+    glFinish();
+    std::chrono::duration<double, std::milli> gpuMs = std::chrono::steady_clock::now() - gpuStart;
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+    glGetTextureImage(textures[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes, gpu.data());
+    glDeleteProgram(shader.ID);
+    glDeleteTextures(2, textures);
+
+    size_t different = 0;
+    int maxSteps = 0;
+    for (size_t i=0; i<bytes; i++) {
+        if ((int)(i % 4) >= volume.channelCount()) continue;
+        int steps = std::abs((int)cpu[i] - (int)gpu[i]);
+        different += steps != 0;
+        maxSteps = std::max(maxSteps, steps);
+    }
+    bool passed = maxSteps <= RECIPE_MAX_STEPS;
+    std::cout << std::left << std::setw(36) << recipe.name() << std::right << " CPU " << std::setw(8) << cpuMs.count()
+        << " ms  GPU " << std::setw(8) << gpuMs.count() << " ms  " << different << " of "
+        << (size_t)width * height * depth * volume.channelCount() << " channel values off by up to " << maxSteps
+        << (passed ? "  ok\n" : "  MISMATCH\n");
+    return passed;
+}
+
+int main() {
+    if (!createHeadlessContext()) return 1;
+    std::vector<NoiseVolumeBuilder> recipes;
+    if (!loadNoiseRecipes(NOISE_RECIPES_PATH, recipes)) return 1;
+    ThreadPool pool;
+    bool allPassed = true;
+
+    int size = GPU_BENCH_VOLUME_SIZE;
+    GLuint volume;
+    glGenTextures(1, &volume);
+    glBindTexture(GL_TEXTURE_3D, volume);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_R32F, size, size, size);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "ns/texel baking a " << size << "^3 r32f volume with noise3DGen.comp and worleyNoise3DGen.comp, speedup of the shared memory cache\n";
+    for (const NoiseConfig& config : worleyConfigs(recipes)) {
+        allPassed &= checkWorley(config, volume, size);
+    }
+
+    std::cout << "\nns/sample over a " << size << "^3 grid for GetNoise on one core, GetNoiseBatch rows on " << pool.threadCount()
+        << (pool.threadCount() == 1 ? " thread" : " threads") << " and noise3DGen.comp, the faster bake, "
+        << "and the GPU's error against GetNoise\n";
+    std::vector<NoiseConfig> configs = crossConfigs();
+    int gpuFaster = 0;
+    for (const NoiseConfig& config : configs) {
+        allPassed &= crossValidate(config, pool, volume, size, gpuFaster);
+    }
+    std::cout << "The GPU bakes " << gpuFaster << " of " << configs.size() << " configurations faster than the CPU\n";
+
+    std::cout << "\nfnlGetNoiseClamped3D (" << CLAMPED_OCTAVES << " octaves) against clamped fnlGetNoise3D: share of texels "
+        << "outside each interval, speedup\n";
+    for (const NoiseConfig& config : clampedConfigs()) {
+        allPassed &= checkClamped(config, volume, size);
+    }
+    glDeleteTextures(1, &volume);
+
+    std::cout << "\nfnlGetNoiseWithGradient2D/3D against fnlGetNoise2D/3D and its finite differences\n";
+    GLuint gradientVolumes[2];
+    glGenTextures(2, gradientVolumes);
+    glBindTexture(GL_TEXTURE_3D, gradientVolumes[0]);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA32F, GRADIENT_GRID_SIZE_2D, GRADIENT_GRID_SIZE_2D, 1);
+    glBindTexture(GL_TEXTURE_3D, gradientVolumes[1]);
+    glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA32F, GRADIENT_GRID_SIZE_3D, GRADIENT_GRID_SIZE_3D, GRADIENT_GRID_SIZE_3D);
+    for (const GradientConfig& config : gradientConfigs()) {
+        allPassed &= checkGlslGradients(config, gradientVolumes);
+    }
+    glDeleteTextures(2, gradientVolumes);
+
+    std::cout << "\nThe recipes baked on " << pool.threadCount() << (pool.threadCount() == 1 ? " thread" : " threads")
+        << " and through cloudNoise3DGen.comp, and the unorm8 steps between them\n";
+    for (const NoiseVolumeBuilder& recipe : recipes) {
+        allPassed &= checkRecipe(recipe, pool);
+    }
+
+    std::cout << (allPassed ? "worleyNoise3DGen.comp matches fnlGetNoise3D, fnlGetNoise3D matches GetNoise, "
+        "fnlGetNoiseWithGradient matches fnlGetNoise and its finite differences, "
+        "fnlGetNoiseClamped3D matches clamped fnlGetNoise3D, cloudNoise3DGen.comp bakes the recipes\n" : "FAILED\n");
+    return allPassed ? 0 : 1;
+}
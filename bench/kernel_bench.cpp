@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FastNoiseLite.h"
+#include "thread_pool.h"
+
+//Throughput of every FastNoiseLite noise type x fractal type x dimension (x distance function for cellular), and of the
+//types that tile with a period, over a fixed sample grid, through each evaluation path: per point GetNoise, GetNoiseBatch rows, GenUniformGrid and batch rows spread
+//over all cores. Every path has to reproduce GetNoise exactly, and GetNoise has to match the checksum stored in
+//bench/golden_checksums.txt, so faster paths and changes to the noise code can be checked for exactness.
+//GetNoiseWithGradient is checked the same way: its value has to match GetNoise exactly and its gradient has to match
+//central differences of GetNoise, its cost is printed relative to GetNoise.
+//DomainWarpBatch has to warp every position exactly like DomainWarp, whose warped grids have golden checksums too,
+//and is timed alone and chained into GetNoiseBatch on the same row buffers.
+//GetNoiseClamped has to equal GetNoise clamped to its interval, its speedup from skipping octaves is printed for a few intervals.
+//Needs no GL context. Run with --update-golden to rewrite the checksums after an intended change of the noise output.
+
+const char* GOLDEN_CHECKSUMS_PATH = "./bench/golden_checksums.txt";
+const int KERNEL_GRID_SIZE_2D = 256;
+const int KERNEL_GRID_SIZE_3D = 48;
+//octaves of the fractals GetNoiseClamped runs on, and the intervals it clamps them to
+const int CLAMPED_OCTAVES = 5;
+const float CLAMPED_INTERVALS[][2] = {{0.3f, 1.0f}, {-1.0f, -0.3f}, {-0.1f, 0.1f}};
+//off the integer lattice so samples do not all land on cell corners
+const float KERNEL_GRID_ORIGIN[3] = {-13.7f, 5.3f, 101.9f};
+const float KERNEL_GRID_STEP = 0.61f;
+const float KERNEL_FREQUENCY = 0.05f;
+//cells after which the periodic configs repeat, the grid starts at negative cells so both sides of 0 wrap
+const int KERNEL_PERIOD = 5;
+const int KERNEL_BENCH_RUNS = 3;
+const float WARP_AMPLITUDE = 30.0f;
+//finite difference step in noise cells, and the gradient error allowed relative to the gradient's size (at least 1 per cell)
+const double GRADIENT_STEP_CELLS = 1e-3;
+const double GRADIENT_TOLERANCE = 2e-3;
+//one sided differences carry a larger truncation error, their error counts this much less
+const double GRADIENT_ONE_SIDED_SLACK = 4.0;
+//share of samples allowed to miss: folds of higher octaves can sit on both sides of a sample within two steps
+const double GRADIENT_OUTLIER_FRACTION = 1e-2;
+
+struct KernelConfig {
+    std::string name;
+    FastNoiseLite noise;
+    FastNoiseLite::NoiseType type;
+    FastNoiseLite::FractalType fractal;
+    int dimensions;
+};
+
+//the sample grid is size^dimensions points, x fastest
+struct KernelGrid {
+    int size, dimensions;
+    std::vector<float> xs, ys, zs;
+
+    KernelGrid(int dimensions);
+    int count() const;
+    int rows() const;
+};
+
+KernelGrid::KernelGrid(int dimensions) : dimensions(dimensions) {
+    size = dimensions == 2 ? KERNEL_GRID_SIZE_2D : KERNEL_GRID_SIZE_3D;
+    int samples = count();
+    xs.resize(samples);
+    ys.resize(samples);
+    zs.resize(samples);
+    for (int i=0; i<samples; i++) {
+        xs[i] = KERNEL_GRID_ORIGIN[0] + (i % size) * KERNEL_GRID_STEP;
+        ys[i] = KERNEL_GRID_ORIGIN[1] + (i / size % size) * KERNEL_GRID_STEP;
+        zs[i] = KERNEL_GRID_ORIGIN[2] + (i / size / size) * KERNEL_GRID_STEP;
+    }
+}
+
+int KernelGrid::count() const {
+    return dimensions == 2 ? size * size : size * size * size;
+}
+
+int KernelGrid::rows() const {
+    return count() / size;
+}
+
+const char* noiseTypeName(FastNoiseLite::NoiseType type) {
+    const char* names[] = {"opensimplex2", "opensimplex2s", "cellular", "perlin", "valuecubic", "value"};
+    return names[type];
+}
+
+const char* fractalTypeName(FastNoiseLite::FractalType type) {
+    const char* names[] = {"none", "fbm", "ridged", "pingpong"};
+    return names[type];
+}
+
+const char* distanceFunctionName(FastNoiseLite::CellularDistanceFunction function) {
+    const char* names[] = {"euclidean", "euclideansq", "manhattan", "hybrid"};
+    return names[function];
+}
+
+std::vector<KernelConfig> kernelConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<KernelConfig> configs;
+    for (int dimensions=2; dimensions<=3; dimensions++) {
+        for (int type=FNL::NoiseType_OpenSimplex2; type<=FNL::NoiseType_Value; type++) {
+            int distanceFunctions = type == FNL::NoiseType_Cellular ? 4 : 1;
+            for (int distance=0; distance<distanceFunctions; distance++) {
+                for (int fractal=FNL::FractalType_None; fractal<=FNL::FractalType_PingPong; fractal++) {
+                    KernelConfig config;
+                    config.dimensions = dimensions;
+                    config.type = (FNL::NoiseType)type;
+                    config.fractal = (FNL::FractalType)fractal;
+                    config.noise.SetNoiseType(config.type);
+                    config.noise.SetFrequency(KERNEL_FREQUENCY);
+                    config.noise.SetFractalType(config.fractal);
+                    config.noise.SetFractalOctaves(3);
+                    config.name = noiseTypeName((FNL::NoiseType)type);
+                    if (type == FNL::NoiseType_Cellular) {
+                        config.noise.SetCellularDistanceFunction((FNL::CellularDistanceFunction)distance);
+                        config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance);
+                        config.name += std::string("_") + distanceFunctionName((FNL::CellularDistanceFunction)distance);
+                    }
+                    config.name += std::string("_") + fractalTypeName((FNL::FractalType)fractal) + "_" + std::to_string(dimensions) + "d";
+                    configs.push_back(config);
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+//the noise types that tile, periodic: they wrap their cells before hashing them, on every path, with the octaves' periods
+std::vector<KernelConfig> periodicConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<KernelConfig> configs;
+    for (int dimensions=2; dimensions<=3; dimensions++) {
+        for (int type : {FNL::NoiseType_Cellular, FNL::NoiseType_Perlin, FNL::NoiseType_ValueCubic, FNL::NoiseType_Value}) {
+            KernelConfig config;
+            config.dimensions = dimensions;
+            config.type = (FNL::NoiseType)type;
+            config.fractal = FNL::FractalType_FBm;
+            config.noise.SetNoiseType(config.type);
+            config.noise.SetFrequency(KERNEL_FREQUENCY);
+            config.noise.SetPeriod(KERNEL_PERIOD);
+            config.noise.SetFractalType(config.fractal);
+            config.noise.SetFractalOctaves(3);
+            if (type == FNL::NoiseType_Cellular) config.noise.SetCellularReturnType(FNL::CellularReturnType_Distance);
+            config.name = std::string(noiseTypeName(config.type)) + "_period" + std::to_string(KERNEL_PERIOD) + "_fbm_"
+                + std::to_string(dimensions) + "d";
+            configs.push_back(config);
+        }
+    }
+    return configs;
+}
+
+//64 bit FNV-1a over the float bits, so any change in any sample shows
+uint64_t checksum(const std::vector<float>& values) {
+    uint64_t hash = 14695981039346656037ull;
+    const unsigned char* bytes = (const unsigned char*)values.data();
+    for (size_t i=0; i<values.size() * sizeof(float); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+//best of KERNEL_BENCH_RUNS runs of fill() in ms
+template <typename Fill>
+double bestTime(Fill fill) {
+    double best = 1e30;
+    for (int run=0; run<KERNEL_BENCH_RUNS; run++) {
+        auto start = std::chrono::steady_clock::now();
+        fill();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+void fillPoints(const FastNoiseLite& noise, const KernelGrid& grid, std::vector<float>& out) {
+    for (int i=0; i<grid.count(); i++) {
+        out[i] = grid.dimensions == 2 ? noise.GetNoise(grid.xs[i], grid.ys[i]) : noise.GetNoise(grid.xs[i], grid.ys[i], grid.zs[i]);
+    }
+}
+
+void fillBatchRow(const FastNoiseLite& noise, const KernelGrid& grid, int row, std::vector<float>& out) {
+    int start = row * grid.size;
+    if (grid.dimensions == 2) noise.GetNoiseBatch(&grid.xs[start], &grid.ys[start], &out[start], grid.size);
+    else noise.GetNoiseBatch(&grid.xs[start], &grid.ys[start], &grid.zs[start], &out[start], grid.size);
+}
+
+void fillGrid(const FastNoiseLite& noise, const KernelGrid& grid, std::vector<float>& out) {
+    if (grid.dimensions == 2) {
+        noise.GenUniformGrid2D(KERNEL_GRID_ORIGIN[0], KERNEL_GRID_ORIGIN[1], KERNEL_GRID_STEP, grid.size, grid.size, out.data());
+    } else {
+        noise.GenUniformGrid3D(KERNEL_GRID_ORIGIN[0], KERNEL_GRID_ORIGIN[1], KERNEL_GRID_ORIGIN[2], KERNEL_GRID_STEP,
+            grid.size, grid.size, grid.size, out.data());
+    }
+}
+
+//the noise types GetNoiseWithGradient differentiates analytically, with the 3D rotations added for fbm
+std::vector<KernelConfig> gradientConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<KernelConfig> configs;
+    for (const KernelConfig& config : kernelConfigs()) {
+        if (config.type != FNL::NoiseType_OpenSimplex2 && config.type != FNL::NoiseType_Perlin && config.type != FNL::NoiseType_Value) continue;
+        configs.push_back(config);
+        if (config.dimensions != 3 || config.fractal != FNL::FractalType_FBm) continue;
+        const char* rotationNames[] = {"", "_improvexy", "_improvexz"};
+        for (int rotation=FNL::RotationType3D_ImproveXYPlanes; rotation<=FNL::RotationType3D_ImproveXZPlanes; rotation++) {
+            KernelConfig rotated = config;
+            rotated.noise.SetRotationType3D((FNL::RotationType3D)rotation);
+            rotated.noise.SetFractalWeightedStrength(0.5f);
+            rotated.name += rotationNames[rotation];
+            configs.push_back(rotated);
+        }
+    }
+    return configs;
+}
+
+//value must equal GetNoise, the gradient has to match finite differences of GetNoise taken in double coordinates.
+//Ridged and pingpong folds, the C1 seams of value noise and the tiny steps of 3D OpenSimplex2 break central differences
+//that straddle them, so one sided second order differences are accepted too, as is a small share of samples boxed in by two
+//of them. A wrong gradient misses almost everywhere
+bool checkGradients(const KernelConfig& config, const KernelGrid& grid) {
+    const FastNoiseLite& noise = config.noise;
+    int count = grid.count();
+    std::vector<float> values(count), gradients((size_t)count * 3);
+    std::vector<float> pointOut(count);
+
+    double pointMs = bestTime([&]() { fillPoints(noise, grid, pointOut); });
+    double gradientMs = bestTime([&]() {
+        for (int i=0; i<count; i++) {
+            float* g = &gradients[(size_t)i * 3];
+            values[i] = grid.dimensions == 2 ? noise.GetNoiseWithGradient(grid.xs[i], grid.ys[i], g[0], g[1])
+                : noise.GetNoiseWithGradient(grid.xs[i], grid.ys[i], grid.zs[i], g[0], g[1], g[2]);
+        }
+    });
+
+    double h = GRADIENT_STEP_CELLS / KERNEL_FREQUENCY;
+    double maxError = 0;
+    int outliers = 0;
+    for (int i=0; i<count; i++) {
+        double p[3] = {grid.xs[i], grid.ys[i], grid.zs[i]};
+        double error = 0, size = 0;
+        for (int axis=0; axis<grid.dimensions; axis++) {
+            //f[s + 2] is the noise s steps along axis
+            double f[5];
+            for (int step=-2; step<=2; step++) {
+                double q[3] = {p[0], p[1], p[2]};
+                q[axis] += step * h;
+                f[step + 2] = grid.dimensions == 2 ? noise.GetNoise(q[0], q[1]) : noise.GetNoise(q[0], q[1], q[2]);
+            }
+            //compare in noise per cell, where the gradients of all configs have similar sizes
+            double central = (f[3] - f[1]) / (2 * GRADIENT_STEP_CELLS);
+            double backward = (3 * f[2] - 4 * f[1] + f[0]) / (2 * GRADIENT_STEP_CELLS);
+            double forward = (-3 * f[2] + 4 * f[3] - f[4]) / (2 * GRADIENT_STEP_CELLS);
+            double analytic = gradients[(size_t)i * 3 + axis] / KERNEL_FREQUENCY;
+            double oneSided = std::min(std::abs(analytic - backward), std::abs(analytic - forward)) / GRADIENT_ONE_SIDED_SLACK;
+            error = std::max(error, std::min(std::abs(analytic - central), oneSided));
+            size = std::max(size, std::abs(analytic));
+        }
+        error /= std::max(size, 1.0);
+        maxError = std::max(maxError, error);
+        if (error > GRADIENT_TOLERANCE) outliers++;
+    }
+
+    std::string failures;
+    if (checksum(values) != checksum(pointOut)) failures += " VALUE MISMATCH";
+    if (outliers > count * GRADIENT_OUTLIER_FRACTION) failures += " GRADIENT MISMATCH";
+    std::cout << std::left << std::setw(36) << config.name << std::right
+        << " gradient " << std::setprecision(2) << gradientMs / pointMs << "x GetNoise, max error "
+        << std::scientific << maxError << std::fixed << ", " << outliers << " outliers"
+        << (failures.empty() ? "  ok" : failures) << "\n";
+    return failures.empty();
+}
+
+//every domain warp type in single, progressive and independent mode, each paired with the noise it distorts
+struct WarpConfig {
+    std::string name;
+    FastNoiseLite warp;
+    FastNoiseLite noise;
+    int dimensions;
+};
+
+std::vector<WarpConfig> warpConfigs() {
+    typedef FastNoiseLite FNL;
+    const char* typeNames[] = {"opensimplex2", "os2reduced", "basicgrid"};
+    const char* modeNames[] = {"single", "progressive", "independent"};
+    FNL::FractalType modes[] = {FNL::FractalType_None, FNL::FractalType_DomainWarpProgressive, FNL::FractalType_DomainWarpIndependent};
+    std::vector<WarpConfig> configs;
+    for (int dimensions=2; dimensions<=3; dimensions++) {
+        for (int type=FNL::DomainWarpType_OpenSimplex2; type<=FNL::DomainWarpType_BasicGrid; type++) {
+            for (int mode=0; mode<3; mode++) {
+                WarpConfig config;
+                config.dimensions = dimensions;
+                config.warp.SetDomainWarpType((FNL::DomainWarpType)type);
+                config.warp.SetDomainWarpAmp(WARP_AMPLITUDE);
+                config.warp.SetFrequency(KERNEL_FREQUENCY);
+                config.warp.SetFractalType(modes[mode]);
+                config.warp.SetFractalOctaves(3);
+                config.noise.SetNoiseType(FNL::NoiseType_Perlin);
+                config.noise.SetFrequency(KERNEL_FREQUENCY);
+                config.noise.SetFractalType(FNL::FractalType_FBm);
+                config.name = std::string("warp_") + typeNames[type] + "_" + modeNames[mode] + "_" + std::to_string(dimensions) + "d";
+                configs.push_back(config);
+            }
+        }
+    }
+    return configs;
+}
+
+//warped positions of the grid, x, y and z planes one after another
+void warpPoints(const FastNoiseLite& warp, const KernelGrid& grid, std::vector<float>& out) {
+    int count = grid.count();
+    for (int i=0; i<count; i++) {
+        float x = grid.xs[i], y = grid.ys[i], z = grid.zs[i];
+        if (grid.dimensions == 2) warp.DomainWarp(x, y);
+        else warp.DomainWarp(x, y, z);
+        out[i] = x;
+        out[count + i] = y;
+        out[2 * count + i] = z;
+    }
+}
+
+void warpBatchRows(const FastNoiseLite& warp, const KernelGrid& grid, std::vector<float>& out) {
+    int count = grid.count();
+    std::copy(grid.xs.begin(), grid.xs.end(), out.begin());
+    std::copy(grid.ys.begin(), grid.ys.end(), out.begin() + count);
+    std::copy(grid.zs.begin(), grid.zs.end(), out.begin() + 2 * count);
+    for (int row=0; row<grid.rows(); row++) {
+        float* x = &out[row * grid.size];
+        if (grid.dimensions == 2) warp.DomainWarpBatch(x, x + count, grid.size);
+        else warp.DomainWarpBatch(x, x + count, x + 2 * count, grid.size);
+    }
+}
+
+//warp and noise per point against one row buffer warped in place and evaluated by GetNoiseBatch, row after row
+double chainedTime(const WarpConfig& config, const KernelGrid& grid, bool batch, std::vector<float>& out) {
+    return bestTime([&]() {
+        std::vector<float> xs(grid.size), ys(grid.size), zs(grid.size);
+        for (int row=0; row<grid.rows(); row++) {
+            int start = row * grid.size;
+            std::copy_n(&grid.xs[start], grid.size, xs.data());
+            std::copy_n(&grid.ys[start], grid.size, ys.data());
+            std::copy_n(&grid.zs[start], grid.size, zs.data());
+            if (batch && grid.dimensions == 2) {
+                config.warp.DomainWarpBatch(xs.data(), ys.data(), grid.size);
+                config.noise.GetNoiseBatch(xs.data(), ys.data(), &out[start], grid.size);
+            } else if (batch) {
+                config.warp.DomainWarpBatch(xs.data(), ys.data(), zs.data(), grid.size);
+                config.noise.GetNoiseBatch(xs.data(), ys.data(), zs.data(), &out[start], grid.size);
+            } else {
+                for (int x=0; x<grid.size; x++) {
+                    if (grid.dimensions == 2) {
+                        config.warp.DomainWarp(xs[x], ys[x]);
+                        out[start + x] = config.noise.GetNoise(xs[x], ys[x]);
+                    } else {
+                        config.warp.DomainWarp(xs[x], ys[x], zs[x]);
+                        out[start + x] = config.noise.GetNoise(xs[x], ys[x], zs[x]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+bool checkWarp(const WarpConfig& config, const KernelGrid& grid, const std::map<std::string, uint64_t>& golden, bool updateGolden,
+    std::vector<std::pair<std::string, uint64_t>>& checksums) {
+    int count = grid.count();
+    std::vector<float> pointOut((size_t)count * 3), batchOut((size_t)count * 3), chainedPoint(count), chainedBatch(count);
+
+    double pointMs = bestTime([&]() { warpPoints(config.warp, grid, pointOut); });
+    double batchMs = bestTime([&]() { warpBatchRows(config.warp, grid, batchOut); });
+    double chainedPointMs = chainedTime(config, grid, false, chainedPoint);
+    double chainedBatchMs = chainedTime(config, grid, true, chainedBatch);
+
+    uint64_t sum = checksum(pointOut);
+    checksums.push_back({config.name, sum});
+    std::string failures;
+    if (checksum(batchOut) != sum) failures += " BATCH MISMATCH";
+    if (checksum(chainedBatch) != checksum(chainedPoint)) failures += " CHAINED MISMATCH";
+    auto goldenEntry = golden.find(config.name);
+    if (!updateGolden && goldenEntry == golden.end()) failures += " NO GOLDEN CHECKSUM";
+    else if (!updateGolden && goldenEntry->second != sum) failures += " GOLDEN MISMATCH";
+
+    std::cout << std::left << std::setw(36) << config.name << std::right
+        << " point " << std::setw(6) << pointMs * 1e6 / count
+        << "  batch " << std::setw(6) << batchMs * 1e6 / count
+        << "  | warp + noise point " << std::setw(6) << chainedPointMs * 1e6 / count
+        << "  batch " << std::setw(6) << chainedBatchMs * 1e6 / count
+        << "  " << std::setprecision(2) << chainedPointMs / chainedBatchMs << "x" << std::setprecision(1)
+        << (failures.empty() ? "  ok" : failures) << "\n";
+    return failures.empty();
+}
+
+//the fbm, ridged and pingpong configs GetNoiseClamped culls octaves for, cellular distance returns never cull
+std::vector<KernelConfig> clampedConfigs() {
+    typedef FastNoiseLite FNL;
+    std::vector<KernelConfig> configs;
+    for (KernelConfig config : kernelConfigs()) {
+        if (config.fractal == FNL::FractalType_None || config.type == FNL::NoiseType_Cellular) continue;
+        config.noise.SetFractalOctaves(CLAMPED_OCTAVES);
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+//GetNoiseClamped must equal GetNoise clamped to the same interval, timed against exactly that
+bool checkClamped(const KernelConfig& config, const KernelGrid& grid) {
+    const FastNoiseLite& noise = config.noise;
+    int count = grid.count();
+    std::vector<float> clampedOut(count), pointOut(count);
+
+    std::string failures;
+    std::cout << std::left << std::setw(36) << config.name << std::right;
+    for (const float* interval : CLAMPED_INTERVALS) {
+        float low = interval[0], high = interval[1];
+        double pointMs = bestTime([&]() {
+            for (int i=0; i<count; i++) {
+                float value = grid.dimensions == 2 ? noise.GetNoise(grid.xs[i], grid.ys[i]) : noise.GetNoise(grid.xs[i], grid.ys[i], grid.zs[i]);
+                pointOut[i] = std::clamp(value, low, high);
+            }
+        });
+        double clampedMs = bestTime([&]() {
+            for (int i=0; i<count; i++) {
+                clampedOut[i] = grid.dimensions == 2 ? noise.GetNoiseClamped(grid.xs[i], grid.ys[i], low, high)
+                    : noise.GetNoiseClamped(grid.xs[i], grid.ys[i], grid.zs[i], low, high);
+            }
+        });
+        int saturated = 0;
+        for (float value : pointOut) saturated += value == low || value == high;
+
+        if (checksum(clampedOut) != checksum(pointOut)) failures += " MISMATCH";
+        std::cout << "  [" << std::setprecision(1) << std::showpos << low << ", " << high << std::noshowpos << "] "
+            << std::setw(3) << saturated * 100 / count << "% out " << std::setprecision(2) << pointMs / clampedMs << "x";
+    }
+    std::cout << std::setprecision(1) << (failures.empty() ? "  ok" : failures) << "\n";
+    return failures.empty();
+}
+
+std::map<std::string, uint64_t> readGoldenChecksums() {
+    std::map<std::string, uint64_t> golden;
+    std::ifstream file(GOLDEN_CHECKSUMS_PATH);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        uint64_t value;
+        if (fields >> name >> std::hex >> value) golden[name] = value;
+    }
+    return golden;
+}
+
+bool writeGoldenChecksums(const std::vector<std::pair<std::string, uint64_t>>& checksums) {
+    std::ofstream file(GOLDEN_CHECKSUMS_PATH, std::ios::trunc);
+    file << "# GetNoise checksums for bench/kernel_bench.cpp, regenerate with kernel_bench --update-golden\n";
+    for (const auto& entry : checksums) {
+        file << entry.first << " " << std::hex << std::setw(16) << std::setfill('0') << entry.second << std::dec << "\n";
+    }
+    return (bool)file;
+}
+
+int main(int argc, char** argv) {
+    bool updateGolden = argc > 1 && strcmp(argv[1], "--update-golden") == 0;
+    std::map<std::string, uint64_t> golden = readGoldenChecksums();
+    std::vector<std::pair<std::string, uint64_t>> checksums;
+    ThreadPool pool;
+    KernelGrid grids[2] = {KernelGrid(2), KernelGrid(3)};
+    bool allPassed = true;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "ns/sample on one core for GetNoise, GetNoiseBatch rows and GenUniformGrid, "
+        << "then batch rows on " << pool.threadCount() << (pool.threadCount() == 1 ? " thread" : " threads")
+        << ": speedup over one core and samples/s per core\n";
+    std::vector<KernelConfig> configs = kernelConfigs(), periodic = periodicConfigs();
+    configs.insert(configs.end(), periodic.begin(), periodic.end());
+    for (const KernelConfig& config : configs) {
+        const KernelGrid& grid = grids[config.dimensions - 2];
+        int count = grid.count();
+        std::vector<float> pointOut(count), batchOut(count), gridOut(count), threadedOut(count);
+
+        double pointMs = bestTime([&]() { fillPoints(config.noise, grid, pointOut); });
+        double batchMs = bestTime([&]() {
+            for (int row=0; row<grid.rows(); row++) fillBatchRow(config.noise, grid, row, batchOut);
+        });
+        double gridMs = bestTime([&]() { fillGrid(config.noise, grid, gridOut); });
+        double threadedMs = bestTime([&]() {
+            pool.parallelFor(grid.rows(), [&](int row) { fillBatchRow(config.noise, grid, row, threadedOut); });
+        });
+
+        uint64_t sum = checksum(pointOut);
+        checksums.push_back({config.name, sum});
+        std::string failures;
+        if (checksum(batchOut) != sum) failures += " BATCH MISMATCH";
+        if (checksum(gridOut) != sum) failures += " GRID MISMATCH";
+        if (checksum(threadedOut) != sum) failures += " THREADED MISMATCH";
+        auto goldenEntry = golden.find(config.name);
+        if (!updateGolden && goldenEntry == golden.end()) failures += " NO GOLDEN CHECKSUM";
+        else if (!updateGolden && goldenEntry->second != sum) failures += " GOLDEN MISMATCH";
+        allPassed &= failures.empty();
+
+        double threadedSamplesPerCore = count / (threadedMs * 1e-3) / pool.threadCount();
+        std::cout << std::left << std::setw(36) << config.name << std::right
+            << " point " << std::setw(6) << pointMs * 1e6 / count
+            << "  batch " << std::setw(6) << batchMs * 1e6 / count
+            << "  grid " << std::setw(6) << gridMs * 1e6 / count
+            << "  | " << std::setprecision(2) << batchMs / threadedMs << "x, "
+            << std::setprecision(1) << threadedSamplesPerCore * 1e-6 << " M/s per core"
+            << (failures.empty() ? "  ok" : failures) << "\n";
+    }
+
+    std::cout << "\nns/sample on one core for DomainWarp and DomainWarpBatch rows, then warp chained into GetNoise and GetNoiseBatch (perlin fbm)\n";
+    for (const WarpConfig& config : warpConfigs()) {
+        allPassed &= checkWarp(config, grids[config.dimensions - 2], golden, updateGolden, checksums);
+    }
+
+    std::cout << "\nGetNoiseWithGradient against GetNoise and central differences\n";
+    for (const KernelConfig& config : gradientConfigs()) {
+        allPassed &= checkGradients(config, grids[config.dimensions - 2]);
+    }
+
+    std::cout << "\nGetNoiseClamped (" << CLAMPED_OCTAVES << " octaves) against clamped GetNoise: share of samples outside each interval, speedup\n";
+    for (const KernelConfig& config : clampedConfigs()) {
+        allPassed &= checkClamped(config, grids[config.dimensions - 2]);
+    }
+
+    if (updateGolden) {
+        if (!writeGoldenChecksums(checksums)) {
+            std::cout << "Failed to write " << GOLDEN_CHECKSUMS_PATH << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << checksums.size() << " golden checksums to " << GOLDEN_CHECKSUMS_PATH << "\n";
+    }
+    std::cout << (allPassed ? "All paths match GetNoise or DomainWarp and the golden checksums, all gradients match, clamped noise matches\n" : "FAILED\n");
+    return allPassed ? 0 : 1;
+}
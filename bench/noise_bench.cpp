@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "FastNoiseLite.h"
+#include "noise_volume.h"
+#include "static_noise.h"
+
+//Compares FastNoiseLite::GetNoise against StaticNoise (cellular only) and the uniform grid generator on the
+//generators of the recipes in assets/cloud_noise.txt. All of them run over the same 3D grid and have to match exactly.
+
+const char* NOISE_RECIPES_PATH = "./assets/cloud_noise.txt";
+const int BENCH_GRID_SIZE = 64;
+
+//fills out with noise(x, y, z) over the bench grid, returns the time in ms
+template <typename Noise>
+double timeGrid(const Noise& noise, std::vector<float>& out) {
+    auto start = std::chrono::steady_clock::now();
+    int index = 0;
+    for (int z=0; z<BENCH_GRID_SIZE; z++) {
+        for (int y=0; y<BENCH_GRID_SIZE; y++) {
+            for (int x=0; x<BENCH_GRID_SIZE; x++) {
+                out[index++] = noise.GetNoise((float)x, (float)y, (float)z);
+            }
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+//returns false if the static generator does not match the dynamic one
+template <typename Static>
+bool compareStatic(const char* name, const FastNoiseLite& dynamicNoise) {
+    Static staticNoise(dynamicNoise);
+    int count = BENCH_GRID_SIZE * BENCH_GRID_SIZE * BENCH_GRID_SIZE;
+    std::vector<float> dynamicOut(count), staticOut(count);
+
+    //best of a few runs to keep the numbers stable
+    double dynamicMs = 1e30, staticMs = 1e30;
+    for (int run=0; run<3; run++) {
+        dynamicMs = std::min(dynamicMs, timeGrid(dynamicNoise, dynamicOut));
+        staticMs = std::min(staticMs, timeGrid(staticNoise, staticOut));
+    }
+
+    bool identical = memcmp(dynamicOut.data(), staticOut.data(), count * sizeof(float)) == 0;
+    std::cout << name << ": dynamic " << dynamicMs * 1e6 / count << " ns/sample, static "
+        << staticMs * 1e6 / count << " ns/sample, " << dynamicMs / staticMs << "x"
+        << (identical ? "" : ", OUTPUT MISMATCH") << "\n";
+    return identical;
+}
+
+//times GenUniformGrid3D against per point GetNoise over the bench grid, returns false if the outputs differ
+bool compareUniformGrid(const char* name, const FastNoiseLite& noise) {
+    int count = BENCH_GRID_SIZE * BENCH_GRID_SIZE * BENCH_GRID_SIZE;
+    std::vector<float> pointOut(count), gridOut(count);
+
+    double pointMs = 1e30, gridMs = 1e30;
+    for (int run=0; run<3; run++) {
+        pointMs = std::min(pointMs, timeGrid(noise, pointOut));
+        auto start = std::chrono::steady_clock::now();
+        noise.GenUniformGrid3D(0.0f, 0.0f, 0.0f, 1.0f, BENCH_GRID_SIZE, BENCH_GRID_SIZE, BENCH_GRID_SIZE, gridOut.data());
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        gridMs = std::min(gridMs, elapsed.count());
+    }
+
+    bool identical = memcmp(pointOut.data(), gridOut.data(), count * sizeof(float)) == 0;
+    std::cout << name << ": per point " << pointMs * 1e6 / count << " ns/sample, uniform grid "
+        << gridMs * 1e6 / count << " ns/sample, " << pointMs / gridMs << "x"
+        << (identical ? "" : ", OUTPUT MISMATCH") << "\n";
+    return identical;
+}
+
+//the generator called noise in the recipe called volume, null (after saying so) when there is none
+const FastNoiseLite* findRecipeNoise(const std::vector<NoiseVolumeBuilder>& recipes, const char* volume, const char* noise) {
+    auto recipe = std::find_if(recipes.begin(), recipes.end(), [&](const NoiseVolumeBuilder& r) { return r.name() == volume; });
+    const FastNoiseLite* found = recipe == recipes.end() ? nullptr : recipe->findNoise(noise);
+    if (!found) std::cout << "No generator " << noise << " in " << volume << " of " << NOISE_RECIPES_PATH << "\n";
+    return found;
+}
+
+//times the generator against StaticNoise with its settings as template arguments and against GenUniformGrid3D,
+//false when it is missing or an output differs. StaticNoise asserts that the recipe still has those settings
+template <typename Static>
+bool compareRecipeNoise(const std::vector<NoiseVolumeBuilder>& recipes, const char* volume, const char* name) {
+    const FastNoiseLite* noise = findRecipeNoise(recipes, volume, name);
+    if (!noise) return false;
+    bool identical = compareStatic<Static>(name, *noise);
+    return compareUniformGrid(name, *noise) && identical;
+}
+
+int main() {
+    typedef FastNoiseLite FNL;
+    std::vector<NoiseVolumeBuilder> recipes;
+    if (!loadNoiseRecipes(NOISE_RECIPES_PATH, recipes)) return 1;
+    bool allIdentical = true;
+
+    //StaticNoise only saves Perlin's noise type switch, within the run to run noise of its lattice walk,
+    //so perlin_r is only timed against the uniform grid the bake uses for it
+    const FastNoiseLite* perlin_r = findRecipeNoise(recipes, "shape_noise", "perlin_r");
+    allIdentical &= perlin_r && compareUniformGrid("perlin_r", *perlin_r);
+    allIdentical &= compareRecipeNoise<StaticNoise<FNL::NoiseType_Cellular, FNL::FractalType_None,
+        FNL::CellularDistanceFunction_EuclideanSq, FNL::CellularReturnType_Distance>>(recipes, "shape_noise", "worley_r");
+    for (const char* name : {"worley_g", "worley_b", "worley_a"}) {
+        allIdentical &= compareRecipeNoise<StaticNoise<FNL::NoiseType_Cellular, FNL::FractalType_FBm,
+            FNL::CellularDistanceFunction_Euclidean, FNL::CellularReturnType_Distance, 3>>(recipes, "shape_noise", name);
+    }
+    allIdentical &= compareRecipeNoise<StaticNoise<FNL::NoiseType_Cellular, FNL::FractalType_FBm,
+        FNL::CellularDistanceFunction_EuclideanSq, FNL::CellularReturnType_Distance, 3>>(recipes, "detail_noise", "detail_r");
+    allIdentical &= compareRecipeNoise<StaticNoise<FNL::NoiseType_Cellular, FNL::FractalType_FBm,
+        FNL::CellularDistanceFunction_Euclidean, FNL::CellularReturnType_Distance, 5>>(recipes, "detail_noise", "detail_g");
+    allIdentical &= compareRecipeNoise<StaticNoise<FNL::NoiseType_Cellular, FNL::FractalType_FBm,
+        FNL::CellularDistanceFunction_Euclidean, FNL::CellularReturnType_Distance, 3>>(recipes, "detail_noise", "detail_b");
+
+    return allIdentical ? 0 : 1;
+}
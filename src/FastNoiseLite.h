@@ -51,6 +51,13 @@
 #define FASTNOISELITE_H
 
 #include <cmath>
+#include <vector>
+
+// Batch noise kernels use GCC/Clang vector extensions and x86 runtime CPU dispatch,
+// other compilers and architectures only get the scalar batch path
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define FNL_BATCH_SIMD
+#endif
 
 class FastNoiseLite
 {
@@ -115,6 +122,7 @@ public:
     {
         mSeed = seed;
         mFrequency = 0.01f;
+        mPeriod = 0;
         mNoiseType = NoiseType_OpenSimplex2;
         mRotationType3D = RotationType3D_None;
         mTransformType3D = TransformType3D_DefaultOpenSimplex2;
@@ -153,6 +161,17 @@ public:
     /// </remarks>
     void SetFrequency(float frequency) { mFrequency = frequency; }
 
+    /// <summary>
+    /// Sets the period in noise cells after which Perlin, Value, ValueCubic and Cellular noise repeat along every axis
+    /// </summary>
+    /// <remarks>
+    /// Default: 0 (no repetition)
+    /// Each fractal octave repeats after the previous octave's period times lacunarity (rounded),
+    /// so fractal noise only tiles with a whole number lacunarity.
+    /// A volume of N texels wraps seamlessly when sampled at 0...N-1 with frequency period / N.
+    /// </remarks>
+    void SetPeriod(int period) { mPeriod = period > 0 ? period : 0; }
+
     /// <summary>
     /// Sets noise algorithm used for GetNoise(...)
     /// </summary>
@@ -302,7 +321,7 @@ public:
         switch (mFractalType)
         {
         default:
-            return GenNoiseSingle(mSeed, x, y);
+            return GenNoiseSingle(mSeed, x, y, mPeriod);
         case FractalType_FBm:
             return GenFractalFBm(x, y);
         case FractalType_Ridged:
@@ -328,7 +347,7 @@ public:
         switch (mFractalType)
         {
         default:
-            return GenNoiseSingle(mSeed, x, y, z);
+            return GenNoiseSingle(mSeed, x, y, z, mPeriod);
         case FractalType_FBm:
             return GenFractalFBm(x, y, z);
         case FractalType_Ridged:
@@ -339,6 +358,110 @@ public:
     }
 
 
+    /// <summary>
+    /// 2D noise and its gradient at given position using current settings
+    /// </summary>
+    /// <remarks>
+    /// dx and dy receive the derivative of the returned noise along x and y, per unit of input coordinate.
+    /// Perlin, Value and OpenSimplex2 noise differentiate their interpolation analytically in the same pass
+    /// (fractals included) and return the same value as GetNoise(...).
+    /// Other noise types fall back to central differences of GetNoise(...)
+    /// </remarks>
+    /// <returns>
+    /// Noise output bounded between -1...1
+    /// </returns>
+    template <typename FNfloat>
+    float GetNoiseWithGradient(FNfloat x, FNfloat y, float& dx, float& dy) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        if (!GradientSupported())
+        {
+            return GetNoiseCentralDifferences(x, y, dx, dy);
+        }
+
+        TransformNoiseCoordinate(x, y);
+        float value = GenFractalWithGradient(x, y, dx, dy);
+        TransformNoiseGradient(dx, dy);
+        return value;
+    }
+
+    /// <summary>
+    /// 3D noise and its gradient at given position using current settings
+    /// </summary>
+    /// <remarks>
+    /// dx, dy and dz receive the derivative of the returned noise along x, y and z, per unit of input coordinate.
+    /// Perlin, Value and OpenSimplex2 noise differentiate their interpolation analytically in the same pass
+    /// (fractals and 3D rotations included) and return the same value as GetNoise(...).
+    /// Other noise types fall back to central differences of GetNoise(...)
+    /// </remarks>
+    /// <returns>
+    /// Noise output bounded between -1...1
+    /// </returns>
+    template <typename FNfloat>
+    float GetNoiseWithGradient(FNfloat x, FNfloat y, FNfloat z, float& dx, float& dy, float& dz) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        if (!GradientSupported())
+        {
+            return GetNoiseCentralDifferences(x, y, z, dx, dy, dz);
+        }
+
+        TransformNoiseCoordinate(x, y, z);
+        float value = GenFractalWithGradient(x, y, z, dx, dy, dz);
+        TransformNoiseGradient(dx, dy, dz);
+        return value;
+    }
+
+    /// <summary>
+    /// 2D noise at given position using current settings, clamped to [min, max]
+    /// </summary>
+    /// <remarks>
+    /// Returns the same value as clamping GetNoise(...) to [min, max], for thresholds and coverage remaps
+    /// that only care about one part of the noise range.
+    /// FBm, Ridged and PingPong fractals stop adding octaves once the octaves left can no longer bring
+    /// the sum back into the interval, so samples that saturate skip their fine octaves.
+    /// Cellular noise only culls with CellularReturnType_CellValue, the distance returns are not bounded by 1
+    /// </remarks>
+    template <typename FNfloat>
+    float GetNoiseClamped(FNfloat x, FNfloat y, float min, float max) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        if (!OctaveCullingSupported())
+        {
+            return ClampNoise(GetNoise(x, y), min, max);
+        }
+
+        TransformNoiseCoordinate(x, y);
+        return GenFractalClamped(x, y, min, max);
+    }
+
+    /// <summary>
+    /// 3D noise at given position using current settings, clamped to [min, max]
+    /// </summary>
+    /// <remarks>
+    /// Returns the same value as clamping GetNoise(...) to [min, max], for thresholds and coverage remaps
+    /// that only care about one part of the noise range.
+    /// FBm, Ridged and PingPong fractals stop adding octaves once the octaves left can no longer bring
+    /// the sum back into the interval, so samples that saturate skip their fine octaves.
+    /// Cellular noise only culls with CellularReturnType_CellValue, the distance returns are not bounded by 1
+    /// </remarks>
+    template <typename FNfloat>
+    float GetNoiseClamped(FNfloat x, FNfloat y, FNfloat z, float min, float max) const
+    {
+        Arguments_must_be_floating_point_values<FNfloat>();
+
+        if (!OctaveCullingSupported())
+        {
+            return ClampNoise(GetNoise(x, y, z), min, max);
+        }
+
+        TransformNoiseCoordinate(x, y, z);
+        return GenFractalClamped(x, y, z, min, max);
+    }
+
     /// <summary>
     /// 2D warps the input position using current domain warp settings
     /// </summary>
@@ -393,7 +516,202 @@ public:
         }
     }
 
+
+    /// <summary>
+    /// 2D noise at a batch of positions using current settings
+    /// </summary>
+    /// <remarks>
+    /// Positions are read from separate x and y arrays, out receives count values.
+    /// Perlin, OpenSimplex2 and Cellular noise run on SSE4.1/AVX2/AVX-512 kernels when the CPU supports them,
+    /// the output is identical to calling GetNoise(...) for each position
+    /// </remarks>
+    void GetNoiseBatch(const float* xs, const float* ys, float* out, int count) const
+    {
+        int done = 0;
+#ifdef FNL_BATCH_SIMD
+        if (BatchSupported())
+        {
+            switch (BatchLevel())
+            {
+            case 3: done = GetNoiseBatchAVX512(xs, ys, out, count); break;
+            case 2: done = GetNoiseBatchAVX2(xs, ys, out, count); break;
+            case 1: done = GetNoiseBatchSSE41(xs, ys, out, count); break;
+            default: break;
+            }
+        }
+#endif
+        for (int i = done; i < count; i++)
+        {
+            out[i] = GetNoise(xs[i], ys[i]);
+        }
+    }
+
+    /// <summary>
+    /// 3D noise at a batch of positions using current settings
+    /// </summary>
+    /// <remarks>
+    /// Positions are read from separate x, y and z arrays, out receives count values.
+    /// Perlin, OpenSimplex2 and Cellular noise run on SSE4.1/AVX2/AVX-512 kernels when the CPU supports them,
+    /// the output is identical to calling GetNoise(...) for each position
+    /// </remarks>
+    void GetNoiseBatch(const float* xs, const float* ys, const float* zs, float* out, int count) const
+    {
+        int done = 0;
+#ifdef FNL_BATCH_SIMD
+        if (BatchSupported())
+        {
+            switch (BatchLevel())
+            {
+            case 3: done = GetNoiseBatchAVX512(xs, ys, zs, out, count); break;
+            case 2: done = GetNoiseBatchAVX2(xs, ys, zs, out, count); break;
+            case 1: done = GetNoiseBatchSSE41(xs, ys, zs, out, count); break;
+            default: break;
+            }
+        }
+#endif
+        for (int i = done; i < count; i++)
+        {
+            out[i] = GetNoise(xs[i], ys[i], zs[i]);
+        }
+    }
+
+    /// <summary>
+    /// 2D warps a batch of positions in place using current domain warp settings
+    /// </summary>
+    /// <remarks>
+    /// Positions are read from and written back to separate x and y arrays, so the warped batch can go straight
+    /// to GetNoiseBatch(...) of the noise it distorts.
+    /// Every domain warp type and fractal mode runs on SSE4.1/AVX2/AVX-512 kernels when the CPU supports them,
+    /// the result is identical to calling DomainWarp(...) for each position
+    /// </remarks>
+    void DomainWarpBatch(float* xs, float* ys, int count) const
+    {
+        int done = 0;
+#ifdef FNL_BATCH_SIMD
+        switch (BatchLevel())
+        {
+        case 3: done = DomainWarpBatchAVX512(xs, ys, count); break;
+        case 2: done = DomainWarpBatchAVX2(xs, ys, count); break;
+        case 1: done = DomainWarpBatchSSE41(xs, ys, count); break;
+        default: break;
+        }
+#endif
+        for (int i = done; i < count; i++)
+        {
+            DomainWarp(xs[i], ys[i]);
+        }
+    }
+
+    /// <summary>
+    /// 3D warps a batch of positions in place using current domain warp settings
+    /// </summary>
+    /// <remarks>
+    /// Positions are read from and written back to separate x, y and z arrays, so the warped batch can go straight
+    /// to GetNoiseBatch(...) of the noise it distorts.
+    /// Every domain warp type and fractal mode runs on SSE4.1/AVX2/AVX-512 kernels when the CPU supports them,
+    /// the result is identical to calling DomainWarp(...) for each position
+    /// </remarks>
+    void DomainWarpBatch(float* xs, float* ys, float* zs, int count) const
+    {
+        int done = 0;
+#ifdef FNL_BATCH_SIMD
+        switch (BatchLevel())
+        {
+        case 3: done = DomainWarpBatchAVX512(xs, ys, zs, count); break;
+        case 2: done = DomainWarpBatchAVX2(xs, ys, zs, count); break;
+        case 1: done = DomainWarpBatchSSE41(xs, ys, zs, count); break;
+        default: break;
+        }
+#endif
+        for (int i = done; i < count; i++)
+        {
+            DomainWarp(xs[i], ys[i], zs[i]);
+        }
+    }
+
+    /// <summary>
+    /// 2D noise over a regular grid using current settings
+    /// </summary>
+    /// <remarks>
+    /// out[y * xSize + x] receives GetNoise(xOrigin + x * step, yOrigin + y * step).
+    /// Perlin, Value and ValueCubic walk the grid row by row and compute each gradient or lattice value
+    /// once per octave for all samples that share it, Cellular runs row by row through GetNoiseBatch(...),
+    /// the output is identical to calling GetNoise(...) per sample.
+    /// Other noise types fall back to GetNoise(...)
+    /// </remarks>
+    void GenUniformGrid2D(float xOrigin, float yOrigin, float step, int xSize, int ySize, float* out) const
+    {
+        if (GridUsesBatchRows(false))
+        {
+            GenGridBatchRows(xOrigin, yOrigin, 0, step, xSize, ySize, 1, false, out);
+            return;
+        }
+
+        if (!GridSupported() || xSize <= 0 || ySize <= 0)
+        {
+            for (int y = 0; y < ySize; y++)
+                for (int x = 0; x < xSize; x++)
+                    out[y * xSize + x] = GetNoise(xOrigin + x * step, yOrigin + y * step);
+            return;
+        }
+
+        std::vector<float> xs(xSize), ys(ySize);
+        for (int x = 0; x < xSize; x++) xs[x] = (xOrigin + x * step) * mFrequency;
+        for (int y = 0; y < ySize; y++) ys[y] = (yOrigin + y * step) * mFrequency;
+
+        GenGridFractal(xs.data(), ys.data(), nullptr, xSize, ySize, 1, out);
+    }
+
+    /// <summary>
+    /// 3D noise over a regular grid using current settings
+    /// </summary>
+    /// <remarks>
+    /// out[(z * ySize + y) * xSize + x] receives GetNoise(xOrigin + x * step, yOrigin + y * step, zOrigin + z * step).
+    /// Cellular, Perlin, Value and ValueCubic walk the grid row by row and compute each feature point,
+    /// gradient or lattice value once per octave for all samples that share it, where the CPU runs the
+    /// SIMD kernels Cellular goes row by row through GetNoiseBatch(...) instead,
+    /// the output is identical to calling GetNoise(...) per sample.
+    /// Other noise types and 3D rotations fall back to GetNoise(...)
+    /// </remarks>
+    void GenUniformGrid3D(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize, float* out) const
+    {
+        if (GridUsesBatchRows(true))
+        {
+            GenGridBatchRows(xOrigin, yOrigin, zOrigin, step, xSize, ySize, zSize, true, out);
+            return;
+        }
+
+        if (!GridSupported() || mTransformType3D != TransformType3D_None || xSize <= 0 || ySize <= 0 || zSize <= 0)
+        {
+            for (int z = 0; z < zSize; z++)
+                for (int y = 0; y < ySize; y++)
+                    for (int x = 0; x < xSize; x++)
+                        out[(z * ySize + y) * xSize + x] = GetNoise(xOrigin + x * step, yOrigin + y * step, zOrigin + z * step);
+            return;
+        }
+
+        std::vector<float> xs(xSize), ys(ySize), zs(zSize);
+        for (int x = 0; x < xSize; x++) xs[x] = (xOrigin + x * step) * mFrequency;
+        for (int y = 0; y < ySize; y++) ys[y] = (yOrigin + y * step) * mFrequency;
+        for (int z = 0; z < zSize; z++) zs[z] = (zOrigin + z * step) * mFrequency;
+
+        GenGridFractal(xs.data(), ys.data(), zs.data(), xSize, ySize, zSize, out);
+    }
+
 private:
+    // Compile time specialized version of GetNoise(...), see static_noise.h
+    template <NoiseType, FractalType, CellularDistanceFunction, CellularReturnType, int>
+    friend class StaticNoise;
+
+    // Picks the grid or batch path per layer, see noise_layers.h
+    friend class NoiseLayers;
+
+    // Hashes every setting for the baked volume cache, see volume_cache.h
+    friend class VolumeCacheKey;
+
+    // Declares the settings as fnl_state constants of a compute shader, see gpu_noise.h
+    friend class NoiseStates;
+
     template <typename T>
     struct Arguments_must_be_floating_point_values;
 
@@ -407,6 +725,7 @@ private:
 
     int mSeed;
     float mFrequency;
+    int mPeriod;
     NoiseType mNoiseType;
     RotationType3D mRotationType3D;
     TransformType3D mTransformType3D;
@@ -488,6 +807,22 @@ private:
     static const int PrimeY = 1136930381;
     static const int PrimeZ = 1720413743;
 
+    // Primed lattice coordinate, wrapped into [0, period) first when the noise is periodic
+    static int PrimeCell(int cell, int prime, int period)
+    {
+        if (period > 0)
+        {
+            cell %= period;
+            if (cell < 0) cell += period;
+        }
+        return cell * prime;
+    }
+
+    int NextOctavePeriod(int period) const
+    {
+        return period > 0 ? (int)(period * mLacunarity + 0.5f) : 0;
+    }
+
     static int Hash(int seed, int xPrimed, int yPrimed)
     {
         int hash = seed ^ xPrimed ^ yPrimed;
@@ -614,7 +949,7 @@ private:
     // Generic noise gen
 
     template <typename FNfloat>
-    float GenNoiseSingle(int seed, FNfloat x, FNfloat y) const
+    float GenNoiseSingle(int seed, FNfloat x, FNfloat y, int period = 0) const
     {
         switch (mNoiseType)
         {
@@ -623,20 +958,20 @@ private:
         case NoiseType_OpenSimplex2S:
             return SingleOpenSimplex2S(seed, x, y);
         case NoiseType_Cellular:
-            return SingleCellular(seed, x, y);
+            return SingleCellular(seed, x, y, period);
         case NoiseType_Perlin:
-            return SinglePerlin(seed, x, y);
+            return SinglePerlin(seed, x, y, period);
         case NoiseType_ValueCubic:
-            return SingleValueCubic(seed, x, y);
+            return SingleValueCubic(seed, x, y, period);
         case NoiseType_Value:
-            return SingleValue(seed, x, y);
+            return SingleValue(seed, x, y, period);
         default:
             return 0;
         }
     }
 
     template <typename FNfloat>
-    float GenNoiseSingle(int seed, FNfloat x, FNfloat y, FNfloat z) const
+    float GenNoiseSingle(int seed, FNfloat x, FNfloat y, FNfloat z, int period = 0) const
     {
         switch (mNoiseType)
         {
@@ -645,13 +980,13 @@ private:
         case NoiseType_OpenSimplex2S:
             return SingleOpenSimplex2S(seed, x, y, z);
         case NoiseType_Cellular:
-            return SingleCellular(seed, x, y, z);
+            return SingleCellular(seed, x, y, z, period);
         case NoiseType_Perlin:
-            return SinglePerlin(seed, x, y, z);
+            return SinglePerlin(seed, x, y, z, period);
         case NoiseType_ValueCubic:
-            return SingleValueCubic(seed, x, y, z);
+            return SingleValueCubic(seed, x, y, z, period);
         case NoiseType_Value:
-            return SingleValue(seed, x, y, z);
+            return SingleValue(seed, x, y, z, period);
         default:
             return 0;
         }
@@ -845,18 +1180,20 @@ private:
     float GenFractalFBm(FNfloat x, FNfloat y) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = GenNoiseSingle(seed++, x, y);
+            float noise = GenNoiseSingle(seed++, x, y, period);
             sum += noise * amp;
             amp *= Lerp(1.0f, FastMin(noise + 1, 2) * 0.5f, mWeightedStrength);
 
             x *= mLacunarity;
             y *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -866,12 +1203,13 @@ private:
     float GenFractalFBm(FNfloat x, FNfloat y, FNfloat z) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = GenNoiseSingle(seed++, x, y, z);
+            float noise = GenNoiseSingle(seed++, x, y, z, period);
             sum += noise * amp;
             amp *= Lerp(1.0f, (noise + 1) * 0.5f, mWeightedStrength);
 
@@ -879,6 +1217,7 @@ private:
             y *= mLacunarity;
             z *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -891,18 +1230,20 @@ private:
     float GenFractalRidged(FNfloat x, FNfloat y) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = FastAbs(GenNoiseSingle(seed++, x, y));
+            float noise = FastAbs(GenNoiseSingle(seed++, x, y, period));
             sum += (noise * -2 + 1) * amp;
             amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
 
             x *= mLacunarity;
             y *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -912,12 +1253,13 @@ private:
     float GenFractalRidged(FNfloat x, FNfloat y, FNfloat z) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = FastAbs(GenNoiseSingle(seed++, x, y, z));
+            float noise = FastAbs(GenNoiseSingle(seed++, x, y, z, period));
             sum += (noise * -2 + 1) * amp;
             amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
 
@@ -925,6 +1267,7 @@ private:
             y *= mLacunarity;
             z *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -937,18 +1280,20 @@ private:
     float GenFractalPingPong(FNfloat x, FNfloat y) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = PingPong((GenNoiseSingle(seed++, x, y) + 1) * mPingPongStrength);
+            float noise = PingPong((GenNoiseSingle(seed++, x, y, period) + 1) * mPingPongStrength);
             sum += (noise - 0.5f) * 2 * amp;
             amp *= Lerp(1.0f, noise, mWeightedStrength);
 
             x *= mLacunarity;
             y *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -958,12 +1303,13 @@ private:
     float GenFractalPingPong(FNfloat x, FNfloat y, FNfloat z) const
     {
         int seed = mSeed;
+        int period = mPeriod;
         float sum = 0;
         float amp = mFractalBounding;
 
         for (int i = 0; i < mOctaves; i++)
         {
-            float noise = PingPong((GenNoiseSingle(seed++, x, y, z) + 1) * mPingPongStrength);
+            float noise = PingPong((GenNoiseSingle(seed++, x, y, z, period) + 1) * mPingPongStrength);
             sum += (noise - 0.5f) * 2 * amp;
             amp *= Lerp(1.0f, noise, mWeightedStrength);
 
@@ -971,6 +1317,7 @@ private:
             y *= mLacunarity;
             z *= mLacunarity;
             amp *= mGain;
+            period = NextOctavePeriod(period);
         }
 
         return sum;
@@ -1480,7 +1827,7 @@ private:
     // Cellular Noise
 
     template <typename FNfloat>
-    float SingleCellular(int seed, FNfloat x, FNfloat y) const
+    float SingleCellular(int seed, FNfloat x, FNfloat y, int period = 0) const
     {
         int xr = FastRound(x);
         int yr = FastRound(y);
@@ -1491,8 +1838,12 @@ private:
 
         float cellularJitter = 0.43701595f * mCellularJitterModifier;
 
-        int xPrimed = (xr - 1) * PrimeX;
-        int yPrimedBase = (yr - 1) * PrimeY;
+        int xPrimes[3], yPrimes[3];
+        for (int i = 0; i < 3; i++)
+        {
+            xPrimes[i] = PrimeCell(xr - 1 + i, PrimeX, period);
+            yPrimes[i] = PrimeCell(yr - 1 + i, PrimeY, period);
+        }
 
         switch (mCellularDistanceFunction)
         {
@@ -1501,11 +1852,9 @@ private:
         case CellularDistanceFunction_EuclideanSq:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = Hash(seed, xPrimed, yPrimed);
+                    int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = (float)(xi - x) + Lookup<float>::RandVecs2D[idx] * cellularJitter;
@@ -1519,19 +1868,15 @@ private:
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         case CellularDistanceFunction_Manhattan:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = Hash(seed, xPrimed, yPrimed);
+                    int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = (float)(xi - x) + Lookup<float>::RandVecs2D[idx] * cellularJitter;
@@ -1545,19 +1890,15 @@ private:
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         case CellularDistanceFunction_Hybrid:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = Hash(seed, xPrimed, yPrimed);
+                    int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = (float)(xi - x) + Lookup<float>::RandVecs2D[idx] * cellularJitter;
@@ -1571,9 +1912,7 @@ private:
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         }
@@ -1610,7 +1949,7 @@ private:
     }
 
     template <typename FNfloat>
-    float SingleCellular(int seed, FNfloat x, FNfloat y, FNfloat z) const
+    float SingleCellular(int seed, FNfloat x, FNfloat y, FNfloat z, int period = 0) const
     {
         int xr = FastRound(x);
         int yr = FastRound(y);
@@ -1622,9 +1961,13 @@ private:
 
         float cellularJitter = 0.39614353f * mCellularJitterModifier;
 
-        int xPrimed = (xr - 1) * PrimeX;
-        int yPrimedBase = (yr - 1) * PrimeY;
-        int zPrimedBase = (zr - 1) * PrimeZ;
+        int xPrimes[3], yPrimes[3], zPrimes[3];
+        for (int i = 0; i < 3; i++)
+        {
+            xPrimes[i] = PrimeCell(xr - 1 + i, PrimeX, period);
+            yPrimes[i] = PrimeCell(yr - 1 + i, PrimeY, period);
+            zPrimes[i] = PrimeCell(zr - 1 + i, PrimeZ, period);
+        }
 
         switch (mCellularDistanceFunction)
         {
@@ -1632,15 +1975,11 @@ private:
         case CellularDistanceFunction_EuclideanSq:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int zPrimed = zPrimedBase;
-
                     for (int zi = zr - 1; zi <= zr + 1; zi++)
                     {
-                        int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+                        int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                         int idx = hash & (255 << 2);
 
                         float vecX = (float)(xi - x) + Lookup<float>::RandVecs3D[idx] * cellularJitter;
@@ -1655,25 +1994,18 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         case CellularDistanceFunction_Manhattan:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int zPrimed = zPrimedBase;
-
                     for (int zi = zr - 1; zi <= zr + 1; zi++)
                     {
-                        int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+                        int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                         int idx = hash & (255 << 2);
 
                         float vecX = (float)(xi - x) + Lookup<float>::RandVecs3D[idx] * cellularJitter;
@@ -1688,25 +2020,18 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         case CellularDistanceFunction_Hybrid:
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int zPrimed = zPrimedBase;
-
                     for (int zi = zr - 1; zi <= zr + 1; zi++)
                     {
-                        int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+                        int hash = Hash(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                         int idx = hash & (255 << 2);
 
                         float vecX = (float)(xi - x) + Lookup<float>::RandVecs3D[idx] * cellularJitter;
@@ -1721,11 +2046,8 @@ private:
                             distance0 = newDistance;
                             closestHash = hash;
                         }
-                        zPrimed += PrimeZ;
                     }
-                    yPrimed += PrimeY;
                 }
-                xPrimed += PrimeX;
             }
             break;
         default:
@@ -1767,7 +2089,7 @@ private:
     // Perlin Noise
 
     template <typename FNfloat>
-    float SinglePerlin(int seed, FNfloat x, FNfloat y) const
+    float SinglePerlin(int seed, FNfloat x, FNfloat y, int period = 0) const
     {
         int x0 = FastFloor(x);
         int y0 = FastFloor(y);
@@ -1780,10 +2102,10 @@ private:
         float xs = InterpQuintic(xd0);
         float ys = InterpQuintic(yd0);
 
-        x0 *= PrimeX;
-        y0 *= PrimeY;
-        int x1 = x0 + PrimeX;
-        int y1 = y0 + PrimeY;
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
 
         float xf0 = Lerp(GradCoord(seed, x0, y0, xd0, yd0), GradCoord(seed, x1, y0, xd1, yd0), xs);
         float xf1 = Lerp(GradCoord(seed, x0, y1, xd0, yd1), GradCoord(seed, x1, y1, xd1, yd1), xs);
@@ -1792,7 +2114,7 @@ private:
     }
 
     template <typename FNfloat>
-    float SinglePerlin(int seed, FNfloat x, FNfloat y, FNfloat z) const
+    float SinglePerlin(int seed, FNfloat x, FNfloat y, FNfloat z, int period = 0) const
     {
         int x0 = FastFloor(x);
         int y0 = FastFloor(y);
@@ -1809,12 +2131,12 @@ private:
         float ys = InterpQuintic(yd0);
         float zs = InterpQuintic(zd0);
 
-        x0 *= PrimeX;
-        y0 *= PrimeY;
-        z0 *= PrimeZ;
-        int x1 = x0 + PrimeX;
-        int y1 = y0 + PrimeY;
-        int z1 = z0 + PrimeZ;
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        int z1 = PrimeCell(z0 + 1, PrimeZ, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+        z0 = PrimeCell(z0, PrimeZ, period);
 
         float xf00 = Lerp(GradCoord(seed, x0, y0, z0, xd0, yd0, zd0), GradCoord(seed, x1, y0, z0, xd1, yd0, zd0), xs);
         float xf10 = Lerp(GradCoord(seed, x0, y1, z0, xd0, yd1, zd0), GradCoord(seed, x1, y1, z0, xd1, yd1, zd0), xs);
@@ -1831,7 +2153,7 @@ private:
     // Value Cubic Noise
 
     template <typename FNfloat>
-    float SingleValueCubic(int seed, FNfloat x, FNfloat y) const
+    float SingleValueCubic(int seed, FNfloat x, FNfloat y, int period = 0) const
     {
         int x1 = FastFloor(x);
         int y1 = FastFloor(y);
@@ -1839,14 +2161,14 @@ private:
         float xs = (float)(x - x1);
         float ys = (float)(y - y1);
 
-        x1 *= PrimeX;
-        y1 *= PrimeY;
-        int x0 = x1 - PrimeX;
-        int y0 = y1 - PrimeY;
-        int x2 = x1 + PrimeX;
-        int y2 = y1 + PrimeY;
-        int x3 = x1 + (int)((long)PrimeX << 1);
-        int y3 = y1 + (int)((long)PrimeY << 1);
+        int x0 = PrimeCell(x1 - 1, PrimeX, period);
+        int y0 = PrimeCell(y1 - 1, PrimeY, period);
+        int x2 = PrimeCell(x1 + 1, PrimeX, period);
+        int y2 = PrimeCell(y1 + 1, PrimeY, period);
+        int x3 = PrimeCell(x1 + 2, PrimeX, period);
+        int y3 = PrimeCell(y1 + 2, PrimeY, period);
+        x1 = PrimeCell(x1, PrimeX, period);
+        y1 = PrimeCell(y1, PrimeY, period);
 
         return CubicLerp(
             CubicLerp(ValCoord(seed, x0, y0), ValCoord(seed, x1, y0), ValCoord(seed, x2, y0), ValCoord(seed, x3, y0),
@@ -1861,7 +2183,7 @@ private:
     }
 
     template <typename FNfloat>
-    float SingleValueCubic(int seed, FNfloat x, FNfloat y, FNfloat z) const
+    float SingleValueCubic(int seed, FNfloat x, FNfloat y, FNfloat z, int period = 0) const
     {
         int x1 = FastFloor(x);
         int y1 = FastFloor(y);
@@ -1871,19 +2193,18 @@ private:
         float ys = (float)(y - y1);
         float zs = (float)(z - z1);
 
-        x1 *= PrimeX;
-        y1 *= PrimeY;
-        z1 *= PrimeZ;
-
-        int x0 = x1 - PrimeX;
-        int y0 = y1 - PrimeY;
-        int z0 = z1 - PrimeZ;
-        int x2 = x1 + PrimeX;
-        int y2 = y1 + PrimeY;
-        int z2 = z1 + PrimeZ;
-        int x3 = x1 + (int)((long)PrimeX << 1);
-        int y3 = y1 + (int)((long)PrimeY << 1);
-        int z3 = z1 + (int)((long)PrimeZ << 1);
+        int x0 = PrimeCell(x1 - 1, PrimeX, period);
+        int y0 = PrimeCell(y1 - 1, PrimeY, period);
+        int z0 = PrimeCell(z1 - 1, PrimeZ, period);
+        int x2 = PrimeCell(x1 + 1, PrimeX, period);
+        int y2 = PrimeCell(y1 + 1, PrimeY, period);
+        int z2 = PrimeCell(z1 + 1, PrimeZ, period);
+        int x3 = PrimeCell(x1 + 2, PrimeX, period);
+        int y3 = PrimeCell(y1 + 2, PrimeY, period);
+        int z3 = PrimeCell(z1 + 2, PrimeZ, period);
+        x1 = PrimeCell(x1, PrimeX, period);
+        y1 = PrimeCell(y1, PrimeY, period);
+        z1 = PrimeCell(z1, PrimeZ, period);
 
 
         return CubicLerp(
@@ -1918,7 +2239,7 @@ private:
     // Value Noise
 
     template <typename FNfloat>
-    float SingleValue(int seed, FNfloat x, FNfloat y) const
+    float SingleValue(int seed, FNfloat x, FNfloat y, int period = 0) const
     {
         int x0 = FastFloor(x);
         int y0 = FastFloor(y);
@@ -1926,10 +2247,10 @@ private:
         float xs = InterpHermite((float)(x - x0));
         float ys = InterpHermite((float)(y - y0));
 
-        x0 *= PrimeX;
-        y0 *= PrimeY;
-        int x1 = x0 + PrimeX;
-        int y1 = y0 + PrimeY;
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
 
         float xf0 = Lerp(ValCoord(seed, x0, y0), ValCoord(seed, x1, y0), xs);
         float xf1 = Lerp(ValCoord(seed, x0, y1), ValCoord(seed, x1, y1), xs);
@@ -1938,7 +2259,7 @@ private:
     }
 
     template <typename FNfloat>
-    float SingleValue(int seed, FNfloat x, FNfloat y, FNfloat z) const
+    float SingleValue(int seed, FNfloat x, FNfloat y, FNfloat z, int period = 0) const
     {
         int x0 = FastFloor(x);
         int y0 = FastFloor(y);
@@ -1948,12 +2269,12 @@ private:
         float ys = InterpHermite((float)(y - y0));
         float zs = InterpHermite((float)(z - z0));
 
-        x0 *= PrimeX;
-        y0 *= PrimeY;
-        z0 *= PrimeZ;
-        int x1 = x0 + PrimeX;
-        int y1 = y0 + PrimeY;
-        int z1 = z0 + PrimeZ;
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        int z1 = PrimeCell(z0 + 1, PrimeZ, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+        z0 = PrimeCell(z0, PrimeZ, period);
 
         float xf00 = Lerp(ValCoord(seed, x0, y0, z0), ValCoord(seed, x1, y0, z0), xs);
         float xf10 = Lerp(ValCoord(seed, x0, y1, z0), ValCoord(seed, x1, y1, z0), xs);
@@ -2442,6 +2763,2869 @@ private:
         yr += vy * warpAmp;
         zr += vz * warpAmp;
     }
+
+
+    // Noise With Gradient
+    //
+    // Each function returns the value of its GetNoise(...) counterpart, computed with the same operations,
+    // together with its derivative: Perlin and Value differentiate the interpolation weights, OpenSimplex2
+    // differentiates the falloff of each vertex. Fractals and coordinate transforms apply the chain rule.
+
+    bool GradientSupported() const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+        case NoiseType_Perlin:
+        case NoiseType_Value:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    template <typename FNfloat>
+    float GetNoiseCentralDifferences(FNfloat x, FNfloat y, float& dx, float& dy) const
+    {
+        // A thousandth of a noise cell
+        FNfloat h = (FNfloat)(0.001f / mFrequency);
+        float scale = (float)(1 / (2 * h));
+
+        dx = (GetNoise(x + h, y) - GetNoise(x - h, y)) * scale;
+        dy = (GetNoise(x, y + h) - GetNoise(x, y - h)) * scale;
+        return GetNoise(x, y);
+    }
+
+    template <typename FNfloat>
+    float GetNoiseCentralDifferences(FNfloat x, FNfloat y, FNfloat z, float& dx, float& dy, float& dz) const
+    {
+        FNfloat h = (FNfloat)(0.001f / mFrequency);
+        float scale = (float)(1 / (2 * h));
+
+        dx = (GetNoise(x + h, y, z) - GetNoise(x - h, y, z)) * scale;
+        dy = (GetNoise(x, y + h, z) - GetNoise(x, y - h, z)) * scale;
+        dz = (GetNoise(x, y, z + h) - GetNoise(x, y, z - h)) * scale;
+        return GetNoise(x, y, z);
+    }
+
+    // Transpose of TransformNoiseCoordinate(...): turns a gradient over transformed coordinates into one over input coordinates
+    void TransformNoiseGradient(float& dx, float& dy) const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+        case NoiseType_OpenSimplex2S:
+            {
+                // The skew is symmetric
+                const float SQRT3 = 1.7320508075688772935274463415059f;
+                const float F2 = 0.5f * (SQRT3 - 1);
+                float t = (dx + dy) * F2;
+                dx += t;
+                dy += t;
+            }
+            break;
+        default:
+            break;
+        }
+
+        dx *= mFrequency;
+        dy *= mFrequency;
+    }
+
+    void TransformNoiseGradient(float& dx, float& dy, float& dz) const
+    {
+        switch (mTransformType3D)
+        {
+        case TransformType3D_ImproveXYPlanes:
+            {
+                float s2 = (dx + dy) * -0.211324865405187f;
+                float zs = dz * 0.577350269189626f;
+                dz = (dz - dx - dy) * 0.577350269189626f;
+                dx += s2 + zs;
+                dy += s2 + zs;
+            }
+            break;
+        case TransformType3D_ImproveXZPlanes:
+            {
+                float s2 = (dx + dz) * -0.211324865405187f;
+                float ys = dy * 0.577350269189626f;
+                dy = (dy - dx - dz) * 0.577350269189626f;
+                dx += s2 + ys;
+                dz += s2 + ys;
+            }
+            break;
+        case TransformType3D_DefaultOpenSimplex2:
+            {
+                // The rotation is symmetric
+                const float R3 = (float)(2.0 / 3.0);
+                float r = (dx + dy + dz) * R3;
+                dx = r - dx;
+                dy = r - dy;
+                dz = r - dz;
+            }
+            break;
+        default:
+            break;
+        }
+
+        dx *= mFrequency;
+        dy *= mFrequency;
+        dz *= mFrequency;
+    }
+
+    template <typename FNfloat>
+    float GenFractalWithGradient(FNfloat x, FNfloat y, float& dx, float& dy) const
+    {
+        if (mFractalType != FractalType_FBm && mFractalType != FractalType_Ridged && mFractalType != FractalType_PingPong)
+        {
+            return GenNoiseSingleWithGradient(mSeed, x, y, mPeriod, dx, dy);
+        }
+
+        int seed = mSeed;
+        int period = mPeriod;
+        float sum = 0;
+        float amp = mFractalBounding;
+        float frequency = 1;
+        float sumGrad[2] = { 0, 0 };
+        float ampGrad[2] = { 0, 0 };
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            float noiseGrad[2];
+            float noise = GenNoiseSingleWithGradient(seed++, x, y, period, noiseGrad[0], noiseGrad[1]);
+            noiseGrad[0] *= frequency;
+            noiseGrad[1] *= frequency;
+            AddOctaveWithGradient<2>(noise, noiseGrad, sum, sumGrad, amp, ampGrad);
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            frequency *= mLacunarity;
+            period = NextOctavePeriod(period);
+        }
+
+        dx = sumGrad[0];
+        dy = sumGrad[1];
+        return sum;
+    }
+
+    template <typename FNfloat>
+    float GenFractalWithGradient(FNfloat x, FNfloat y, FNfloat z, float& dx, float& dy, float& dz) const
+    {
+        if (mFractalType != FractalType_FBm && mFractalType != FractalType_Ridged && mFractalType != FractalType_PingPong)
+        {
+            return GenNoiseSingleWithGradient(mSeed, x, y, z, mPeriod, dx, dy, dz);
+        }
+
+        int seed = mSeed;
+        int period = mPeriod;
+        float sum = 0;
+        float amp = mFractalBounding;
+        float frequency = 1;
+        float sumGrad[3] = { 0, 0, 0 };
+        float ampGrad[3] = { 0, 0, 0 };
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            float noiseGrad[3];
+            float noise = GenNoiseSingleWithGradient(seed++, x, y, z, period, noiseGrad[0], noiseGrad[1], noiseGrad[2]);
+            noiseGrad[0] *= frequency;
+            noiseGrad[1] *= frequency;
+            noiseGrad[2] *= frequency;
+            AddOctaveWithGradient<3>(noise, noiseGrad, sum, sumGrad, amp, ampGrad);
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            z *= mLacunarity;
+            frequency *= mLacunarity;
+            period = NextOctavePeriod(period);
+        }
+
+        dx = sumGrad[0];
+        dy = sumGrad[1];
+        dz = sumGrad[2];
+        return sum;
+    }
+
+    // One octave of GenFractalFBm/Ridged/PingPong(...), also carrying the gradients of the sum and of the
+    // amplitude, which depends on earlier octaves through the weighted strength
+    template <int Dims>
+    void AddOctaveWithGradient(float noise, float* noiseGrad, float& sum, float* sumGrad, float& amp, float* ampGrad) const
+    {
+        float weight, weightSlope;
+
+        switch (mFractalType)
+        {
+        default:
+        case FractalType_FBm:
+            for (int d = 0; d < Dims; d++) sumGrad[d] += noiseGrad[d] * amp + noise * ampGrad[d];
+            sum += noise * amp;
+            weight = Lerp(1.0f, (Dims == 2 ? FastMin(noise + 1, 2) : noise + 1) * 0.5f, mWeightedStrength);
+            weightSlope = Dims == 2 && noise > 1 ? 0 : 0.5f * mWeightedStrength;
+            break;
+        case FractalType_Ridged:
+            {
+                float sign = noise < 0 ? -1.0f : 1.0f;
+                noise = FastAbs(noise);
+                for (int d = 0; d < Dims; d++)
+                {
+                    noiseGrad[d] *= sign;
+                    sumGrad[d] += noiseGrad[d] * -2 * amp + (noise * -2 + 1) * ampGrad[d];
+                }
+                sum += (noise * -2 + 1) * amp;
+                weight = Lerp(1.0f, 1 - noise, mWeightedStrength);
+                weightSlope = -mWeightedStrength;
+            }
+            break;
+        case FractalType_PingPong:
+            {
+                float t = (noise + 1) * mPingPongStrength;
+                float slope = PingPongSlope(t) * mPingPongStrength;
+                noise = PingPong(t);
+                for (int d = 0; d < Dims; d++)
+                {
+                    noiseGrad[d] *= slope;
+                    sumGrad[d] += noiseGrad[d] * 2 * amp + (noise - 0.5f) * 2 * ampGrad[d];
+                }
+                sum += (noise - 0.5f) * 2 * amp;
+                weight = Lerp(1.0f, noise, mWeightedStrength);
+                weightSlope = mWeightedStrength;
+            }
+            break;
+        }
+
+        for (int d = 0; d < Dims; d++) ampGrad[d] = (ampGrad[d] * weight + amp * weightSlope * noiseGrad[d]) * mGain;
+        amp *= weight;
+        amp *= mGain;
+    }
+
+    template <typename FNfloat>
+    float GenNoiseSingleWithGradient(int seed, FNfloat x, FNfloat y, int period, float& dx, float& dy) const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+            return SingleSimplexWithGradient(seed, x, y, dx, dy);
+        case NoiseType_Perlin:
+            return SinglePerlinWithGradient(seed, x, y, period, dx, dy);
+        default:
+        case NoiseType_Value:
+            return SingleValueWithGradient(seed, x, y, period, dx, dy);
+        }
+    }
+
+    template <typename FNfloat>
+    float GenNoiseSingleWithGradient(int seed, FNfloat x, FNfloat y, FNfloat z, int period, float& dx, float& dy, float& dz) const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+            return SingleOpenSimplex2WithGradient(seed, x, y, z, dx, dy, dz);
+        case NoiseType_Perlin:
+            return SinglePerlinWithGradient(seed, x, y, z, period, dx, dy, dz);
+        default:
+        case NoiseType_Value:
+            return SingleValueWithGradient(seed, x, y, z, period, dx, dy, dz);
+        }
+    }
+
+    static float InterpHermiteDerivative(float t) { return t * (6 - t * 6); }
+
+    static float InterpQuinticDerivative(float t) { return t * t * (t * (t * 30 - 60) + 30); }
+
+    // Slope of PingPong(t), the same fold as PingPong(...)
+    static float PingPongSlope(float t)
+    {
+        t -= (int)(t * 0.5f) * 2;
+        return t < 1 ? 1.0f : -1.0f;
+    }
+
+    // Trilinear interpolation of the corners v[0], v[stride] ... v[7 * stride], x fastest
+    static float TrilinearLerp(const float* v, int stride, float xs, float ys, float zs)
+    {
+        float xf00 = Lerp(v[0], v[stride], xs);
+        float xf10 = Lerp(v[2 * stride], v[3 * stride], xs);
+        float xf01 = Lerp(v[4 * stride], v[5 * stride], xs);
+        float xf11 = Lerp(v[6 * stride], v[7 * stride], xs);
+
+        return Lerp(Lerp(xf00, xf10, ys), Lerp(xf01, xf11, ys), zs);
+    }
+
+    // Adds the derivative of falloff^4 * (gradient . offset), with falloff = r - |offset|^2, to dx and dy
+    static void AddFalloffGradient(float falloff, float value, float xg, float yg, float xd, float yd, float& dx, float& dy)
+    {
+        float falloff3 = falloff * falloff * falloff;
+        dx += falloff3 * (falloff * xg - 8 * value * xd);
+        dy += falloff3 * (falloff * yg - 8 * value * yd);
+    }
+
+    static void AddFalloffGradient(float falloff, float value, float xg, float yg, float zg, float xd, float yd, float zd, float& dx, float& dy, float& dz)
+    {
+        float falloff3 = falloff * falloff * falloff;
+        dx += falloff3 * (falloff * xg - 8 * value * xd);
+        dy += falloff3 * (falloff * yg - 8 * value * yd);
+        dz += falloff3 * (falloff * zg - 8 * value * zd);
+    }
+
+    // GradCoord(...) that also returns the gradient vector it used
+    float GradCoord(int seed, int xPrimed, int yPrimed, float xd, float yd, float& xg, float& yg) const
+    {
+        int hash = Hash(seed, xPrimed, yPrimed);
+        hash ^= hash >> 15;
+        hash &= 127 << 1;
+
+        xg = Lookup<float>::Gradients2D[hash];
+        yg = Lookup<float>::Gradients2D[hash | 1];
+
+        return xd * xg + yd * yg;
+    }
+
+    float GradCoord(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd, float& xg, float& yg, float& zg) const
+    {
+        int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+        hash ^= hash >> 15;
+        hash &= 63 << 2;
+
+        xg = Lookup<float>::Gradients3D[hash];
+        yg = Lookup<float>::Gradients3D[hash | 1];
+        zg = Lookup<float>::Gradients3D[hash | 2];
+
+        return xd * xg + yd * yg + zd * zg;
+    }
+
+    template <typename FNfloat>
+    float SingleSimplexWithGradient(int seed, FNfloat x, FNfloat y, float& dx, float& dy) const
+    {
+        const float SQRT3 = 1.7320508075688772935274463415059f;
+        const float G2 = (3 - SQRT3) / 6;
+
+        int i = FastFloor(x);
+        int j = FastFloor(y);
+        float xi = (float)(x - i);
+        float yi = (float)(y - j);
+
+        float t = (xi + yi) * G2;
+        float x0 = (float)(xi - t);
+        float y0 = (float)(yi - t);
+
+        i *= PrimeX;
+        j *= PrimeY;
+
+        // Gradient over the vertex offsets, which all move like (x0, y0)
+        float ox = 0, oy = 0;
+        float xg, yg;
+        float n0, n1, n2;
+
+        float a = 0.5f - x0 * x0 - y0 * y0;
+        if (a <= 0) n0 = 0;
+        else
+        {
+            float g = GradCoord(seed, i, j, x0, y0, xg, yg);
+            n0 = (a * a) * (a * a) * g;
+            AddFalloffGradient(a, g, xg, yg, x0, y0, ox, oy);
+        }
+
+        float c = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a);
+        if (c <= 0) n2 = 0;
+        else
+        {
+            float x2 = x0 + (2 * (float)G2 - 1);
+            float y2 = y0 + (2 * (float)G2 - 1);
+            float g = GradCoord(seed, i + PrimeX, j + PrimeY, x2, y2, xg, yg);
+            n2 = (c * c) * (c * c) * g;
+            AddFalloffGradient(c, g, xg, yg, x2, y2, ox, oy);
+        }
+
+        if (y0 > x0)
+        {
+            float x1 = x0 + (float)G2;
+            float y1 = y0 + ((float)G2 - 1);
+            float b = 0.5f - x1 * x1 - y1 * y1;
+            if (b <= 0) n1 = 0;
+            else
+            {
+                float g = GradCoord(seed, i, j + PrimeY, x1, y1, xg, yg);
+                n1 = (b * b) * (b * b) * g;
+                AddFalloffGradient(b, g, xg, yg, x1, y1, ox, oy);
+            }
+        }
+        else
+        {
+            float x1 = x0 + ((float)G2 - 1);
+            float y1 = y0 + (float)G2;
+            float b = 0.5f - x1 * x1 - y1 * y1;
+            if (b <= 0) n1 = 0;
+            else
+            {
+                float g = GradCoord(seed, i + PrimeX, j, x1, y1, xg, yg);
+                n1 = (b * b) * (b * b) * g;
+                AddFalloffGradient(b, g, xg, yg, x1, y1, ox, oy);
+            }
+        }
+
+        // The unskew (x0, y0) = (xi, yi) - (xi + yi) * G2 is symmetric
+        float ot = (ox + oy) * G2;
+        dx = (ox - ot) * 99.83685446303647f;
+        dy = (oy - ot) * 99.83685446303647f;
+
+        return (n0 + n1 + n2) * 99.83685446303647f;
+    }
+
+    template <typename FNfloat>
+    float SingleOpenSimplex2WithGradient(int seed, FNfloat x, FNfloat y, FNfloat z, float& dx, float& dy, float& dz) const
+    {
+        int i = FastRound(x);
+        int j = FastRound(y);
+        int k = FastRound(z);
+        float x0 = (float)(x - i);
+        float y0 = (float)(y - j);
+        float z0 = (float)(z - k);
+
+        int xNSign = (int)(-1.0f - x0) | 1;
+        int yNSign = (int)(-1.0f - y0) | 1;
+        int zNSign = (int)(-1.0f - z0) | 1;
+
+        float ax0 = xNSign * -x0;
+        float ay0 = yNSign * -y0;
+        float az0 = zNSign * -z0;
+
+        i *= PrimeX;
+        j *= PrimeY;
+        k *= PrimeZ;
+
+        // Every vertex offset moves like (x, y, z), so the gradient over the offsets is the result
+        dx = dy = dz = 0;
+        float xg, yg, zg;
+        float value = 0;
+        float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+
+        for (int l = 0; ; l++)
+        {
+            if (a > 0)
+            {
+                float g = GradCoord(seed, i, j, k, x0, y0, z0, xg, yg, zg);
+                value += (a * a) * (a * a) * g;
+                AddFalloffGradient(a, g, xg, yg, zg, x0, y0, z0, dx, dy, dz);
+            }
+
+            float b = a + 1;
+            int i1 = i;
+            int j1 = j;
+            int k1 = k;
+            float x1 = x0;
+            float y1 = y0;
+            float z1 = z0;
+
+            if (ax0 >= ay0 && ax0 >= az0)
+            {
+                x1 += xNSign;
+                b -= xNSign * 2 * x1;
+                i1 -= xNSign * PrimeX;
+            }
+            else if (ay0 > ax0 && ay0 >= az0)
+            {
+                y1 += yNSign;
+                b -= yNSign * 2 * y1;
+                j1 -= yNSign * PrimeY;
+            }
+            else
+            {
+                z1 += zNSign;
+                b -= zNSign * 2 * z1;
+                k1 -= zNSign * PrimeZ;
+            }
+
+            if (b > 0)
+            {
+                float g = GradCoord(seed, i1, j1, k1, x1, y1, z1, xg, yg, zg);
+                value += (b * b) * (b * b) * g;
+                AddFalloffGradient(b, g, xg, yg, zg, x1, y1, z1, dx, dy, dz);
+            }
+
+            if (l == 1) break;
+
+            ax0 = 0.5f - ax0;
+            ay0 = 0.5f - ay0;
+            az0 = 0.5f - az0;
+
+            x0 = xNSign * ax0;
+            y0 = yNSign * ay0;
+            z0 = zNSign * az0;
+
+            a += (0.75f - ax0) - (ay0 + az0);
+
+            i += (xNSign >> 1) & PrimeX;
+            j += (yNSign >> 1) & PrimeY;
+            k += (zNSign >> 1) & PrimeZ;
+
+            xNSign = -xNSign;
+            yNSign = -yNSign;
+            zNSign = -zNSign;
+
+            seed = ~seed;
+        }
+
+        dx *= 32.69428253173828125f;
+        dy *= 32.69428253173828125f;
+        dz *= 32.69428253173828125f;
+
+        return value * 32.69428253173828125f;
+    }
+
+    template <typename FNfloat>
+    float SinglePerlinWithGradient(int seed, FNfloat x, FNfloat y, int period, float& dx, float& dy) const
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+
+        float xd0 = (float)(x - x0);
+        float yd0 = (float)(y - y0);
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+
+        float xs = InterpQuintic(xd0);
+        float ys = InterpQuintic(yd0);
+
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+
+        // Corner gradients, [corner][xy] with x fastest
+        float g[8];
+        float v00 = GradCoord(seed, x0, y0, xd0, yd0, g[0], g[1]);
+        float v10 = GradCoord(seed, x1, y0, xd1, yd0, g[2], g[3]);
+        float v01 = GradCoord(seed, x0, y1, xd0, yd1, g[4], g[5]);
+        float v11 = GradCoord(seed, x1, y1, xd1, yd1, g[6], g[7]);
+
+        float xf0 = Lerp(v00, v10, xs);
+        float xf1 = Lerp(v01, v11, xs);
+
+        float xsd = InterpQuinticDerivative(xd0);
+        float ysd = InterpQuinticDerivative(yd0);
+        dx = (Lerp(Lerp(g[0], g[2], xs), Lerp(g[4], g[6], xs), ys) + Lerp(v10 - v00, v11 - v01, ys) * xsd) * 1.4247691104677813f;
+        dy = (Lerp(Lerp(g[1], g[3], xs), Lerp(g[5], g[7], xs), ys) + (xf1 - xf0) * ysd) * 1.4247691104677813f;
+
+        return Lerp(xf0, xf1, ys) * 1.4247691104677813f;
+    }
+
+    template <typename FNfloat>
+    float SinglePerlinWithGradient(int seed, FNfloat x, FNfloat y, FNfloat z, int period, float& dx, float& dy, float& dz) const
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+        int z0 = FastFloor(z);
+
+        float xd0 = (float)(x - x0);
+        float yd0 = (float)(y - y0);
+        float zd0 = (float)(z - z0);
+        float xd1 = xd0 - 1;
+        float yd1 = yd0 - 1;
+        float zd1 = zd0 - 1;
+
+        float xs = InterpQuintic(xd0);
+        float ys = InterpQuintic(yd0);
+        float zs = InterpQuintic(zd0);
+
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        int z1 = PrimeCell(z0 + 1, PrimeZ, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+        z0 = PrimeCell(z0, PrimeZ, period);
+
+        // Corner values and gradients, [corner][xyz] with x fastest
+        float v[8], g[24];
+        v[0] = GradCoord(seed, x0, y0, z0, xd0, yd0, zd0, g[0], g[1], g[2]);
+        v[1] = GradCoord(seed, x1, y0, z0, xd1, yd0, zd0, g[3], g[4], g[5]);
+        v[2] = GradCoord(seed, x0, y1, z0, xd0, yd1, zd0, g[6], g[7], g[8]);
+        v[3] = GradCoord(seed, x1, y1, z0, xd1, yd1, zd0, g[9], g[10], g[11]);
+        v[4] = GradCoord(seed, x0, y0, z1, xd0, yd0, zd1, g[12], g[13], g[14]);
+        v[5] = GradCoord(seed, x1, y0, z1, xd1, yd0, zd1, g[15], g[16], g[17]);
+        v[6] = GradCoord(seed, x0, y1, z1, xd0, yd1, zd1, g[18], g[19], g[20]);
+        v[7] = GradCoord(seed, x1, y1, z1, xd1, yd1, zd1, g[21], g[22], g[23]);
+
+        float xf00 = Lerp(v[0], v[1], xs);
+        float xf10 = Lerp(v[2], v[3], xs);
+        float xf01 = Lerp(v[4], v[5], xs);
+        float xf11 = Lerp(v[6], v[7], xs);
+
+        float yf0 = Lerp(xf00, xf10, ys);
+        float yf1 = Lerp(xf01, xf11, ys);
+
+        float xsd = InterpQuinticDerivative(xd0);
+        float ysd = InterpQuinticDerivative(yd0);
+        float zsd = InterpQuinticDerivative(zd0);
+        float xSlope = Lerp(Lerp(v[1] - v[0], v[3] - v[2], ys), Lerp(v[5] - v[4], v[7] - v[6], ys), zs);
+        dx = (TrilinearLerp(g, 3, xs, ys, zs) + xSlope * xsd) * 0.964921414852142333984375f;
+        dy = (TrilinearLerp(g + 1, 3, xs, ys, zs) + Lerp(xf10 - xf00, xf11 - xf01, zs) * ysd) * 0.964921414852142333984375f;
+        dz = (TrilinearLerp(g + 2, 3, xs, ys, zs) + (yf1 - yf0) * zsd) * 0.964921414852142333984375f;
+
+        return Lerp(yf0, yf1, zs) * 0.964921414852142333984375f;
+    }
+
+    template <typename FNfloat>
+    float SingleValueWithGradient(int seed, FNfloat x, FNfloat y, int period, float& dx, float& dy) const
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+
+        float xd = (float)(x - x0);
+        float yd = (float)(y - y0);
+        float xs = InterpHermite(xd);
+        float ys = InterpHermite(yd);
+
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+
+        float v00 = ValCoord(seed, x0, y0);
+        float v10 = ValCoord(seed, x1, y0);
+        float v01 = ValCoord(seed, x0, y1);
+        float v11 = ValCoord(seed, x1, y1);
+
+        float xf0 = Lerp(v00, v10, xs);
+        float xf1 = Lerp(v01, v11, xs);
+
+        dx = Lerp(v10 - v00, v11 - v01, ys) * InterpHermiteDerivative(xd);
+        dy = (xf1 - xf0) * InterpHermiteDerivative(yd);
+
+        return Lerp(xf0, xf1, ys);
+    }
+
+    template <typename FNfloat>
+    float SingleValueWithGradient(int seed, FNfloat x, FNfloat y, FNfloat z, int period, float& dx, float& dy, float& dz) const
+    {
+        int x0 = FastFloor(x);
+        int y0 = FastFloor(y);
+        int z0 = FastFloor(z);
+
+        float xd = (float)(x - x0);
+        float yd = (float)(y - y0);
+        float zd = (float)(z - z0);
+        float xs = InterpHermite(xd);
+        float ys = InterpHermite(yd);
+        float zs = InterpHermite(zd);
+
+        int x1 = PrimeCell(x0 + 1, PrimeX, period);
+        int y1 = PrimeCell(y0 + 1, PrimeY, period);
+        int z1 = PrimeCell(z0 + 1, PrimeZ, period);
+        x0 = PrimeCell(x0, PrimeX, period);
+        y0 = PrimeCell(y0, PrimeY, period);
+        z0 = PrimeCell(z0, PrimeZ, period);
+
+        float v[8] = {
+            ValCoord(seed, x0, y0, z0), ValCoord(seed, x1, y0, z0), ValCoord(seed, x0, y1, z0), ValCoord(seed, x1, y1, z0),
+            ValCoord(seed, x0, y0, z1), ValCoord(seed, x1, y0, z1), ValCoord(seed, x0, y1, z1), ValCoord(seed, x1, y1, z1) };
+
+        float xf00 = Lerp(v[0], v[1], xs);
+        float xf10 = Lerp(v[2], v[3], xs);
+        float xf01 = Lerp(v[4], v[5], xs);
+        float xf11 = Lerp(v[6], v[7], xs);
+
+        float yf0 = Lerp(xf00, xf10, ys);
+        float yf1 = Lerp(xf01, xf11, ys);
+
+        dx = Lerp(Lerp(v[1] - v[0], v[3] - v[2], ys), Lerp(v[5] - v[4], v[7] - v[6], ys), zs) * InterpHermiteDerivative(xd);
+        dy = Lerp(xf10 - xf00, xf11 - xf01, zs) * InterpHermiteDerivative(yd);
+        dz = (yf1 - yf0) * InterpHermiteDerivative(zd);
+
+        return Lerp(yf0, yf1, zs);
+    }
+
+
+    // Octave Culling
+    //
+    // The culled fractals add the same terms as GenFractal*(...) in the same order. Every octave adds at most
+    // its amplitude once the single noise is within [-1, 1], and the weighting scales the amplitude by at most
+    // max(1, |1 - weighted strength|) per octave, which bounds what the octaves left can still add.
+
+    bool OctaveCullingSupported() const
+    {
+        switch (mFractalType)
+        {
+        case FractalType_FBm:
+        case FractalType_Ridged:
+        case FractalType_PingPong:
+            return mNoiseType != NoiseType_Cellular || mCellularReturnType == CellularReturnType_CellValue;
+        default:
+            return false;
+        }
+    }
+
+    static float ClampNoise(float value, float min, float max)
+    {
+        return value < min ? min : (max < value ? max : value);
+    }
+
+    // Bound on the sum of the last remaining octaves per unit of the next octave's amplitude,
+    // with some headroom for single noise that rounds slightly past 1
+    float RemainingOctavesBound(int remaining) const
+    {
+        float weight = FastMax(1.0f, FastAbs(1 - mWeightedStrength));
+        float octaveScale = weight * FastAbs(mGain);
+        float bound = 0;
+        for (int i = 0; i < remaining; i++)
+        {
+            bound = bound * octaveScale + 1;
+        }
+        return bound * 1.001f;
+    }
+
+    // Term one octave adds to the fractal sum, amp receives the weighting for the next octave
+    template <int Dims>
+    float FractalOctave(float noise, float& amp) const
+    {
+        switch (mFractalType)
+        {
+        default:
+        case FractalType_FBm:
+            {
+                float value = noise * amp;
+                amp *= Lerp(1.0f, (Dims == 2 ? FastMin(noise + 1, 2) : noise + 1) * 0.5f, mWeightedStrength);
+                return value;
+            }
+        case FractalType_Ridged:
+            {
+                noise = FastAbs(noise);
+                float value = (noise * -2 + 1) * amp;
+                amp *= Lerp(1.0f, 1 - noise, mWeightedStrength);
+                return value;
+            }
+        case FractalType_PingPong:
+            {
+                noise = PingPong((noise + 1) * mPingPongStrength);
+                float value = (noise - 0.5f) * 2 * amp;
+                amp *= Lerp(1.0f, noise, mWeightedStrength);
+                return value;
+            }
+        }
+    }
+
+    // True with value min or max once the sum so far is further outside [min, max] than the octaves left
+    // (and the rounding of their additions) can reach
+    bool CullOctaves(float sum, float amp, int remaining, float min, float max, float& value) const
+    {
+        float reach = FastAbs(amp) * RemainingOctavesBound(remaining) + 1e-6f;
+        if (sum - reach >= max)
+        {
+            value = max;
+            return true;
+        }
+        if (sum + reach <= min)
+        {
+            value = min;
+            return true;
+        }
+        return false;
+    }
+
+    template <typename FNfloat>
+    float GenFractalClamped(FNfloat x, FNfloat y, float min, float max) const
+    {
+        int seed = mSeed;
+        int period = mPeriod;
+        float sum = 0;
+        float amp = mFractalBounding;
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            sum += FractalOctave<2>(GenNoiseSingle(seed++, x, y, period), amp);
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            amp *= mGain;
+            period = NextOctavePeriod(period);
+
+            float culled;
+            if (i + 1 < mOctaves && CullOctaves(sum, amp, mOctaves - 1 - i, min, max, culled))
+            {
+                return culled;
+            }
+        }
+
+        return ClampNoise(sum, min, max);
+    }
+
+    template <typename FNfloat>
+    float GenFractalClamped(FNfloat x, FNfloat y, FNfloat z, float min, float max) const
+    {
+        int seed = mSeed;
+        int period = mPeriod;
+        float sum = 0;
+        float amp = mFractalBounding;
+
+        for (int i = 0; i < mOctaves; i++)
+        {
+            sum += FractalOctave<3>(GenNoiseSingle(seed++, x, y, z, period), amp);
+
+            x *= mLacunarity;
+            y *= mLacunarity;
+            z *= mLacunarity;
+            amp *= mGain;
+            period = NextOctavePeriod(period);
+
+            float culled;
+            if (i + 1 < mOctaves && CullOctaves(sum, amp, mOctaves - 1 - i, min, max, culled))
+            {
+                return culled;
+            }
+        }
+
+        return ClampNoise(sum, min, max);
+    }
+
+
+    // Uniform Grid Gen
+    //
+    // The grid generators run one octave at a time over the whole grid, axis coordinates are stored
+    // already transformed and zs is null for 2D grids.
+
+    bool GridSupported() const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_Cellular:
+        case NoiseType_Perlin:
+        case NoiseType_ValueCubic:
+        case NoiseType_Value:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // The SIMD kernels beat the cellular grid walk 3-4x. Without them the 2D walk is no faster than
+    // GetNoise(...) per sample, which is what GetNoiseBatch(...) falls back to, only the 3D walk still wins
+    bool GridUsesBatchRows(bool is3D) const
+    {
+        if (mNoiseType != NoiseType_Cellular) return false;
+#ifdef FNL_BATCH_SIMD
+        if (BatchLevel() > 0) return true;
+#endif
+        return !is3D;
+    }
+
+    void GenGridBatchRows(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize, bool is3D, float* out) const
+    {
+        if (xSize <= 0) return;
+
+        std::vector<float> xs(xSize), ys(xSize), zs(xSize);
+        for (int x = 0; x < xSize; x++) xs[x] = xOrigin + x * step;
+
+        for (int z = 0; z < zSize; z++)
+        {
+            for (int x = 0; x < xSize; x++) zs[x] = zOrigin + z * step;
+            for (int y = 0; y < ySize; y++)
+            {
+                for (int x = 0; x < xSize; x++) ys[x] = yOrigin + y * step;
+                float* row = out + ((size_t)z * ySize + y) * xSize;
+                if (is3D) GetNoiseBatch(xs.data(), ys.data(), zs.data(), row, xSize);
+                else GetNoiseBatch(xs.data(), ys.data(), row, xSize);
+            }
+        }
+    }
+
+    void GenGridFractal(float* xs, float* ys, float* zs, int xSize, int ySize, int zSize, float* out) const
+    {
+        int count = xSize * ySize * zSize;
+
+        if (mFractalType != FractalType_FBm && mFractalType != FractalType_Ridged && mFractalType != FractalType_PingPong)
+        {
+            GenGridSingle(mSeed, xs, ys, zs, xSize, ySize, zSize, out, mPeriod);
+            return;
+        }
+
+        std::vector<float> noise(count), amp(count, mFractalBounding);
+        int seed = mSeed;
+        int period = mPeriod;
+
+        for (int i = 0; i < count; i++) out[i] = 0;
+
+        for (int octave = 0; octave < mOctaves; octave++)
+        {
+            GenGridSingle(seed++, xs, ys, zs, xSize, ySize, zSize, noise.data(), period);
+
+            for (int i = 0; i < count; i++)
+            {
+                float n = noise[i];
+                switch (mFractalType)
+                {
+                default:
+                case FractalType_FBm:
+                    out[i] += n * amp[i];
+                    amp[i] *= Lerp(1.0f, (zs ? (n + 1) : FastMin(n + 1, 2)) * 0.5f, mWeightedStrength);
+                    break;
+                case FractalType_Ridged:
+                    n = FastAbs(n);
+                    out[i] += (n * -2 + 1) * amp[i];
+                    amp[i] *= Lerp(1.0f, 1 - n, mWeightedStrength);
+                    break;
+                case FractalType_PingPong:
+                    n = PingPong((n + 1) * mPingPongStrength);
+                    out[i] += (n - 0.5f) * 2 * amp[i];
+                    amp[i] *= Lerp(1.0f, n, mWeightedStrength);
+                    break;
+                }
+                amp[i] *= mGain;
+            }
+
+            for (int x = 0; x < xSize; x++) xs[x] *= mLacunarity;
+            for (int y = 0; y < ySize; y++) ys[y] *= mLacunarity;
+            if (zs) for (int z = 0; z < zSize; z++) zs[z] *= mLacunarity;
+            period = NextOctavePeriod(period);
+        }
+    }
+
+    void GenGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        switch (mNoiseType)
+        {
+        default:
+        case NoiseType_Cellular:
+            return GenCellularGridSingle(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+        case NoiseType_Perlin:
+            return zs ? GenPerlinGridSingle(seed, xs, ys, zs, xSize, ySize, zSize, out, period) : GenPerlinGridSingle(seed, xs, ys, xSize, ySize, out, period);
+        case NoiseType_ValueCubic:
+            return zs ? GenValueCubicGridSingle(seed, xs, ys, zs, xSize, ySize, zSize, out, period) : GenValueCubicGridSingle(seed, xs, ys, xSize, ySize, out, period);
+        case NoiseType_Value:
+            return zs ? GenValueGridSingle(seed, xs, ys, zs, xSize, ySize, zSize, out, period) : GenValueGridSingle(seed, xs, ys, xSize, ySize, out, period);
+        }
+    }
+
+    // Fallback for grids with fewer samples than lattice cells (very high frequencies), where caching is slower than recomputing
+    void GenGridPerSample(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        for (int z = 0; z < zSize; z++)
+            for (int y = 0; y < ySize; y++)
+                for (int x = 0; x < xSize; x++)
+                    out[(z * ySize + y) * xSize + x] = zs ? GenNoiseSingle(seed, xs[x], ys[y], zs[z], period) : GenNoiseSingle(seed, xs[x], ys[y], period);
+    }
+
+
+    // Cellular Grid Gen
+    //
+    // Keeps one octave's feature points for the cells around the current row (2D) or slice (3D)
+    // and evaluates every sample against them in the same order SingleCellular(...) does.
+
+    struct CellularFeature
+    {
+        int hash;
+        float x, y, z;
+    };
+
+    void GenCellularGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        switch (mCellularDistanceFunction)
+        {
+        default:
+        case CellularDistanceFunction_Euclidean:
+        case CellularDistanceFunction_EuclideanSq:
+            return GenCellularGridSingle<CellularDistanceFunction_EuclideanSq>(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+        case CellularDistanceFunction_Manhattan:
+            return GenCellularGridSingle<CellularDistanceFunction_Manhattan>(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+        case CellularDistanceFunction_Hybrid:
+            return GenCellularGridSingle<CellularDistanceFunction_Hybrid>(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+        }
+    }
+
+    template <CellularDistanceFunction DistanceFunction>
+    void GenCellularGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        // Coordinates are monotonic along each axis, so the rounded end points bound the cells in use
+        int xrFirst = FastRound(xs[0]), xrLast = FastRound(xs[xSize - 1]);
+        int yrFirst = FastRound(ys[0]), yrLast = FastRound(ys[ySize - 1]);
+        int xMin = (xrFirst < xrLast ? xrFirst : xrLast) - 1;
+        int yMin = (yrFirst < yrLast ? yrFirst : yrLast) - 1;
+        int cellsX = (xrFirst < xrLast ? xrLast - xrFirst : xrFirst - xrLast) + 3;
+        int cellsY = (yrFirst < yrLast ? yrLast - yrFirst : yrFirst - yrLast) + 3;
+
+        // Fewer samples than cells (very high frequencies) would make the cache slower than recomputing
+        if ((long long)cellsX * (zs ? cellsY : 3) > 4LL * xSize * (zs ? ySize : 1) + 64)
+        {
+            GenGridPerSample(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+            return;
+        }
+
+        std::vector<int> xr(xSize);
+        for (int x = 0; x < xSize; x++) xr[x] = FastRound(xs[x]) - xMin;
+
+        if (!zs)
+        {
+            // Rolling buffer of 3 cell rows, row yi lives in slot yi mod 3
+            float cellularJitter = 0.43701595f * mCellularJitterModifier;
+            std::vector<CellularFeature> rows(3 * cellsX);
+            int rowY[3] = { yMin - 1, yMin - 1, yMin - 1 };
+
+            for (int y = 0; y < ySize; y++)
+            {
+                int yr = FastRound(ys[y]);
+
+                for (int yi = yr - 1; yi <= yr + 1; yi++)
+                {
+                    int slot = ((yi % 3) + 3) % 3;
+                    if (rowY[slot] == yi) continue;
+                    rowY[slot] = yi;
+
+                    CellularFeature* row = &rows[slot * cellsX];
+                    int yPrimed = PrimeCell(yi, PrimeY, period);
+                    for (int cx = 0; cx < cellsX; cx++)
+                    {
+                        int hash = Hash(seed, PrimeCell(xMin + cx, PrimeX, period), yPrimed);
+                        int idx = hash & (255 << 1);
+                        row[cx] = { hash, Lookup<float>::RandVecs2D[idx] * cellularJitter, Lookup<float>::RandVecs2D[idx | 1] * cellularJitter, 0 };
+                    }
+                }
+
+                for (int x = 0; x < xSize; x++)
+                {
+                    float distance0 = 1e10f;
+                    float distance1 = 1e10f;
+                    int closestHash = 0;
+
+                    for (int cx = xr[x] - 1; cx <= xr[x] + 1; cx++)
+                    {
+                        int xi = cx + xMin;
+                        for (int yi = yr - 1; yi <= yr + 1; yi++)
+                        {
+                            const CellularFeature& cell = rows[(((yi % 3) + 3) % 3) * cellsX + cx];
+
+                            float vecX = (float)(xi - xs[x]) + cell.x;
+                            float vecY = (float)(yi - ys[y]) + cell.y;
+
+                            float newDistance;
+                            switch (DistanceFunction)
+                            {
+                            case CellularDistanceFunction_Manhattan:
+                                newDistance = FastAbs(vecX) + FastAbs(vecY);
+                                break;
+                            case CellularDistanceFunction_Hybrid:
+                                newDistance = (FastAbs(vecX) + FastAbs(vecY)) + (vecX * vecX + vecY * vecY);
+                                break;
+                            default:
+                                newDistance = vecX * vecX + vecY * vecY;
+                                break;
+                            }
+
+                            distance1 = FastMax(FastMin(distance1, newDistance), distance0);
+                            closestHash = newDistance < distance0 ? cell.hash : closestHash;
+                            distance0 = FastMin(newDistance, distance0);
+                        }
+                    }
+
+                    out[y * xSize + x] = CellularGridReturn(distance0, distance1, closestHash);
+                }
+            }
+            return;
+        }
+
+        // Rolling buffer of 3 cell layers, layer zi lives in slot zi mod 3.
+        // The slots of a cell column are stored next to each other: [x cell][y cell][slot]
+        float cellularJitter = 0.39614353f * mCellularJitterModifier;
+        std::vector<CellularFeature> layers(cellsX * cellsY * 3);
+        std::vector<int> yr(ySize);
+        for (int y = 0; y < ySize; y++) yr[y] = FastRound(ys[y]) - yMin;
+        int zrFirst = FastRound(zs[0]), zrLast = FastRound(zs[zSize - 1]);
+        int zUnused = (zrFirst < zrLast ? zrFirst : zrLast) - 2;
+        int layerZ[3] = { zUnused, zUnused, zUnused };
+
+        // Cell offsets (float)(xi - x) for the 3 cells around each sample, same rounding as SingleCellular(...)
+        std::vector<float> xOffsets(xSize * 3), yOffsets(ySize * 3);
+        for (int x = 0; x < xSize; x++)
+            for (int o = 0; o < 3; o++) xOffsets[x * 3 + o] = (float)(xr[x] - 1 + o + xMin - xs[x]);
+        for (int y = 0; y < ySize; y++)
+            for (int o = 0; o < 3; o++) yOffsets[y * 3 + o] = (float)(yr[y] - 1 + o + yMin - ys[y]);
+
+        for (int z = 0; z < zSize; z++)
+        {
+            int zr = FastRound(zs[z]);
+
+            for (int zi = zr - 1; zi <= zr + 1; zi++)
+            {
+                int slot = ((zi % 3) + 3) % 3;
+                if (layerZ[slot] == zi) continue;
+                layerZ[slot] = zi;
+
+                int zPrimed = PrimeCell(zi, PrimeZ, period);
+                for (int cx = 0; cx < cellsX; cx++)
+                {
+                    int xPrimed = PrimeCell(xMin + cx, PrimeX, period);
+                    for (int cy = 0; cy < cellsY; cy++)
+                    {
+                        int hash = Hash(seed, xPrimed, PrimeCell(yMin + cy, PrimeY, period), zPrimed);
+                        int idx = hash & (255 << 2);
+                        layers[(cx * cellsY + cy) * 3 + slot] = { hash,
+                            Lookup<float>::RandVecs3D[idx] * cellularJitter,
+                            Lookup<float>::RandVecs3D[idx | 1] * cellularJitter,
+                            Lookup<float>::RandVecs3D[idx | 2] * cellularJitter };
+                    }
+                }
+            }
+
+            int slots[3] = { ((zr - 1) % 3 + 3) % 3, (zr % 3 + 3) % 3, ((zr + 1) % 3 + 3) % 3 };
+            float zOffsets[3];
+            for (int o = 0; o < 3; o++) zOffsets[o] = (float)(zr - 1 + o - zs[z]);
+
+            for (int y = 0; y < ySize; y++)
+            {
+                const float* yOffset = &yOffsets[y * 3];
+                float* row = &out[(z * ySize + y) * xSize];
+
+                for (int x = 0; x < xSize; x++)
+                {
+                    const float* xOffset = &xOffsets[x * 3];
+                    const CellularFeature* column = &layers[((xr[x] - 1) * cellsY + yr[y] - 1) * 3];
+                    float distance0 = 1e10f;
+                    float distance1 = 1e10f;
+                    int closestHash = 0;
+
+                    for (int xo = 0; xo < 3; xo++)
+                    {
+                        for (int yo = 0; yo < 3; yo++)
+                        {
+                            const CellularFeature* cells = column + (xo * cellsY + yo) * 3;
+
+                            for (int zo = 0; zo < 3; zo++)
+                            {
+                                const CellularFeature& cell = cells[slots[zo]];
+
+                                float vecX = xOffset[xo] + cell.x;
+                                float vecY = yOffset[yo] + cell.y;
+                                float vecZ = zOffsets[zo] + cell.z;
+
+                                float newDistance;
+                                switch (DistanceFunction)
+                                {
+                                case CellularDistanceFunction_Manhattan:
+                                    newDistance = FastAbs(vecX) + FastAbs(vecY) + FastAbs(vecZ);
+                                    break;
+                                case CellularDistanceFunction_Hybrid:
+                                    newDistance = (FastAbs(vecX) + FastAbs(vecY) + FastAbs(vecZ)) + (vecX * vecX + vecY * vecY + vecZ * vecZ);
+                                    break;
+                                default:
+                                    newDistance = vecX * vecX + vecY * vecY + vecZ * vecZ;
+                                    break;
+                                }
+
+                                distance1 = FastMax(FastMin(distance1, newDistance), distance0);
+                                closestHash = newDistance < distance0 ? cell.hash : closestHash;
+                                distance0 = FastMin(newDistance, distance0);
+                            }
+                        }
+                    }
+
+                    row[x] = CellularGridReturn(distance0, distance1, closestHash);
+                }
+            }
+        }
+    }
+
+    float CellularGridReturn(float distance0, float distance1, int closestHash) const
+    {
+        if (mCellularDistanceFunction == CellularDistanceFunction_Euclidean && mCellularReturnType >= CellularReturnType_Distance)
+        {
+            distance0 = FastSqrt(distance0);
+
+            if (mCellularReturnType >= CellularReturnType_Distance2)
+            {
+                distance1 = FastSqrt(distance1);
+            }
+        }
+
+        switch (mCellularReturnType)
+        {
+        case CellularReturnType_CellValue:
+            return closestHash * (1 / 2147483648.0f);
+        case CellularReturnType_Distance:
+            return distance0 - 1;
+        case CellularReturnType_Distance2:
+            return distance1 - 1;
+        case CellularReturnType_Distance2Add:
+            return (distance1 + distance0) * 0.5f - 1;
+        case CellularReturnType_Distance2Sub:
+            return distance1 - distance0 - 1;
+        case CellularReturnType_Distance2Mul:
+            return distance1 * distance0 * 0.5f - 1;
+        case CellularReturnType_Distance2Div:
+            return distance0 / distance1 - 1;
+        default:
+            return 0;
+        }
+    }
+
+    // Lattice Grid Gen
+    //
+    // Perlin and Value noise only depend on the lattice points around each sample, so the gradients or
+    // values of every lattice point along the current row of cells are cached and shared by all samples
+    // in those cells. Rows are refilled only when a sample row crosses into a new y (or z) cell,
+    // per sample work is the interpolation, done in the same order as the Single*(...) functions.
+
+    struct GridLatticeAxis
+    {
+        std::vector<int> cell;
+        std::vector<float> offset;
+        int first, count;
+
+        GridLatticeAxis(const float* coords, int size) : cell(size), offset(size)
+        {
+            for (int i = 0; i < size; i++)
+            {
+                cell[i] = FastFloor(coords[i]);
+                offset[i] = (float)(coords[i] - cell[i]);
+            }
+
+            // Coordinates are monotonic, so the end points bound the cells in use
+            first = cell[0] < cell[size - 1] ? cell[0] : cell[size - 1];
+            count = (cell[0] < cell[size - 1] ? cell[size - 1] - cell[0] : cell[0] - cell[size - 1]) + 1;
+        }
+
+        bool Sparse(int size) const { return count > 2 * size + 16; }
+    };
+
+    static void GridGradient(int seed, int xPrimed, int yPrimed, float* g)
+    {
+        int hash = Hash(seed, xPrimed, yPrimed);
+        hash ^= hash >> 15;
+        hash &= 127 << 1;
+
+        g[0] = Lookup<float>::Gradients2D[hash];
+        g[1] = Lookup<float>::Gradients2D[hash | 1];
+    }
+
+    static void GridGradient(int seed, int xPrimed, int yPrimed, int zPrimed, float* g)
+    {
+        int hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+        hash ^= hash >> 15;
+        hash &= 63 << 2;
+
+        g[0] = Lookup<float>::Gradients3D[hash];
+        g[1] = Lookup<float>::Gradients3D[hash | 1];
+        g[2] = Lookup<float>::Gradients3D[hash | 2];
+    }
+
+    void GenPerlinGridSingle(int seed, const float* xs, const float* ys, int xSize, int ySize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, nullptr, xSize, ySize, 1, out, period);
+
+        std::vector<float> xWeight(xSize);
+        for (int x = 0; x < xSize; x++) xWeight[x] = InterpQuintic(xAxis.offset[x]);
+
+        // Gradients along the current cell row, [x point][y0, y1][xy]
+        int points = xAxis.count + 1;
+        std::vector<float> grads(points * 4);
+        bool rowValid = false;
+        int rowY = 0;
+
+        for (int y = 0; y < ySize; y++)
+        {
+            if (!rowValid || yAxis.cell[y] != rowY)
+            {
+                rowValid = true;
+                rowY = yAxis.cell[y];
+
+                int y0 = PrimeCell(rowY, PrimeY, period);
+                int y1 = PrimeCell(rowY + 1, PrimeY, period);
+                for (int i = 0; i < points; i++)
+                {
+                    int xPrimed = PrimeCell(xAxis.first + i, PrimeX, period);
+                    GridGradient(seed, xPrimed, y0, &grads[i * 4]);
+                    GridGradient(seed, xPrimed, y1, &grads[i * 4 + 2]);
+                }
+            }
+
+            float yd0 = yAxis.offset[y];
+            float yd1 = yd0 - 1;
+            float yw = InterpQuintic(yd0);
+
+            float* row = out + y * xSize;
+            for (int x = 0; x < xSize; x++)
+            {
+                const float* g = &grads[(xAxis.cell[x] - xAxis.first) * 4];
+                float xd0 = xAxis.offset[x];
+                float xd1 = xd0 - 1;
+
+                float xf0 = Lerp(xd0 * g[0] + yd0 * g[1], xd1 * g[4] + yd0 * g[5], xWeight[x]);
+                float xf1 = Lerp(xd0 * g[2] + yd1 * g[3], xd1 * g[6] + yd1 * g[7], xWeight[x]);
+
+                row[x] = Lerp(xf0, xf1, yw) * 1.4247691104677813f;
+            }
+        }
+    }
+
+    void GenPerlinGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize), zAxis(zs, zSize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+
+        std::vector<float> xWeight(xSize);
+        for (int x = 0; x < xSize; x++) xWeight[x] = InterpQuintic(xAxis.offset[x]);
+
+        // Gradients along the current cell row, [x point][y0z0, y1z0, y0z1, y1z1][xyz]
+        int points = xAxis.count + 1;
+        std::vector<float> grads(points * 12);
+        bool rowValid = false;
+        int rowY = 0, rowZ = 0;
+
+        for (int z = 0; z < zSize; z++)
+        {
+            float zd0 = zAxis.offset[z];
+            float zd1 = zd0 - 1;
+            float zw = InterpQuintic(zd0);
+
+            for (int y = 0; y < ySize; y++)
+            {
+                if (!rowValid || yAxis.cell[y] != rowY || zAxis.cell[z] != rowZ)
+                {
+                    rowValid = true;
+                    rowY = yAxis.cell[y];
+                    rowZ = zAxis.cell[z];
+
+                    int y0 = PrimeCell(rowY, PrimeY, period);
+                    int y1 = PrimeCell(rowY + 1, PrimeY, period);
+                    int z0 = PrimeCell(rowZ, PrimeZ, period);
+                    int z1 = PrimeCell(rowZ + 1, PrimeZ, period);
+                    for (int i = 0; i < points; i++)
+                    {
+                        int xPrimed = PrimeCell(xAxis.first + i, PrimeX, period);
+                        GridGradient(seed, xPrimed, y0, z0, &grads[i * 12]);
+                        GridGradient(seed, xPrimed, y1, z0, &grads[i * 12 + 3]);
+                        GridGradient(seed, xPrimed, y0, z1, &grads[i * 12 + 6]);
+                        GridGradient(seed, xPrimed, y1, z1, &grads[i * 12 + 9]);
+                    }
+                }
+
+                float yd0 = yAxis.offset[y];
+                float yd1 = yd0 - 1;
+                float yw = InterpQuintic(yd0);
+
+                float* row = out + (z * ySize + y) * xSize;
+                for (int x = 0; x < xSize; x++)
+                {
+                    const float* g = &grads[(xAxis.cell[x] - xAxis.first) * 12];
+                    float xd0 = xAxis.offset[x];
+                    float xd1 = xd0 - 1;
+                    float xw = xWeight[x];
+
+                    float xf00 = Lerp(xd0 * g[0] + yd0 * g[1] + zd0 * g[2], xd1 * g[12] + yd0 * g[13] + zd0 * g[14], xw);
+                    float xf10 = Lerp(xd0 * g[3] + yd1 * g[4] + zd0 * g[5], xd1 * g[15] + yd1 * g[16] + zd0 * g[17], xw);
+                    float xf01 = Lerp(xd0 * g[6] + yd0 * g[7] + zd1 * g[8], xd1 * g[18] + yd0 * g[19] + zd1 * g[20], xw);
+                    float xf11 = Lerp(xd0 * g[9] + yd1 * g[10] + zd1 * g[11], xd1 * g[21] + yd1 * g[22] + zd1 * g[23], xw);
+
+                    float yf0 = Lerp(xf00, xf10, yw);
+                    float yf1 = Lerp(xf01, xf11, yw);
+
+                    row[x] = Lerp(yf0, yf1, zw) * 0.964921414852142333984375f;
+                }
+            }
+        }
+    }
+
+    void GenValueCubicGridSingle(int seed, const float* xs, const float* ys, int xSize, int ySize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, nullptr, xSize, ySize, 1, out, period);
+
+        // Values along the current cell row, [x point][y0..y3], x points start one before the first cell
+        int points = xAxis.count + 3;
+        std::vector<float> values(points * 4);
+        bool rowValid = false;
+        int rowY = 0;
+
+        for (int y = 0; y < ySize; y++)
+        {
+            if (!rowValid || yAxis.cell[y] != rowY)
+            {
+                rowValid = true;
+                rowY = yAxis.cell[y];
+
+                int yPrimed[4];
+                for (int j = 0; j < 4; j++) yPrimed[j] = PrimeCell(rowY - 1 + j, PrimeY, period);
+                for (int i = 0; i < points; i++)
+                {
+                    int xPrimed = PrimeCell(xAxis.first - 1 + i, PrimeX, period);
+                    for (int j = 0; j < 4; j++)
+                        values[i * 4 + j] = ValCoord(seed, xPrimed, yPrimed[j]);
+                }
+            }
+
+            float yw = yAxis.offset[y];
+
+            float* row = out + y * xSize;
+            for (int x = 0; x < xSize; x++)
+            {
+                const float* v = &values[(xAxis.cell[x] - xAxis.first) * 4];
+                float xw = xAxis.offset[x];
+
+                row[x] = CubicLerp(
+                    CubicLerp(v[0], v[4], v[8], v[12], xw),
+                    CubicLerp(v[1], v[5], v[9], v[13], xw),
+                    CubicLerp(v[2], v[6], v[10], v[14], xw),
+                    CubicLerp(v[3], v[7], v[11], v[15], xw),
+                    yw) * (1 / (1.5f * 1.5f));
+            }
+        }
+    }
+
+    void GenValueCubicGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize), zAxis(zs, zSize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+
+        // Values along the current cell row, [x point][z0..z3][y0..y3], x points start one before the first cell
+        int points = xAxis.count + 3;
+        std::vector<float> values(points * 16);
+        bool rowValid = false;
+        int rowY = 0, rowZ = 0;
+
+        for (int z = 0; z < zSize; z++)
+        {
+            float zw = zAxis.offset[z];
+
+            for (int y = 0; y < ySize; y++)
+            {
+                if (!rowValid || yAxis.cell[y] != rowY || zAxis.cell[z] != rowZ)
+                {
+                    rowValid = true;
+                    rowY = yAxis.cell[y];
+                    rowZ = zAxis.cell[z];
+
+                    int yPrimed[4], zPrimed[4];
+                    for (int j = 0; j < 4; j++)
+                    {
+                        yPrimed[j] = PrimeCell(rowY - 1 + j, PrimeY, period);
+                        zPrimed[j] = PrimeCell(rowZ - 1 + j, PrimeZ, period);
+                    }
+                    for (int i = 0; i < points; i++)
+                    {
+                        int xPrimed = PrimeCell(xAxis.first - 1 + i, PrimeX, period);
+                        for (int k = 0; k < 4; k++)
+                            for (int j = 0; j < 4; j++)
+                                values[i * 16 + k * 4 + j] = ValCoord(seed, xPrimed, yPrimed[j], zPrimed[k]);
+                    }
+                }
+
+                float yw = yAxis.offset[y];
+
+                float* row = out + (z * ySize + y) * xSize;
+                for (int x = 0; x < xSize; x++)
+                {
+                    const float* v = &values[(xAxis.cell[x] - xAxis.first) * 16];
+                    float xw = xAxis.offset[x];
+
+                    float zf[4];
+                    for (int k = 0; k < 4; k++)
+                    {
+                        const float* vz = v + k * 4;
+                        zf[k] = CubicLerp(
+                            CubicLerp(vz[0], vz[16], vz[32], vz[48], xw),
+                            CubicLerp(vz[1], vz[17], vz[33], vz[49], xw),
+                            CubicLerp(vz[2], vz[18], vz[34], vz[50], xw),
+                            CubicLerp(vz[3], vz[19], vz[35], vz[51], xw),
+                            yw);
+                    }
+
+                    row[x] = CubicLerp(zf[0], zf[1], zf[2], zf[3], zw) * (1 / (1.5f * 1.5f * 1.5f));
+                }
+            }
+        }
+    }
+
+    void GenValueGridSingle(int seed, const float* xs, const float* ys, int xSize, int ySize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, nullptr, xSize, ySize, 1, out, period);
+
+        std::vector<float> xWeight(xSize);
+        for (int x = 0; x < xSize; x++) xWeight[x] = InterpHermite(xAxis.offset[x]);
+
+        // Values along the current cell row, [x point][y0, y1]
+        int points = xAxis.count + 1;
+        std::vector<float> values(points * 2);
+        bool rowValid = false;
+        int rowY = 0;
+
+        for (int y = 0; y < ySize; y++)
+        {
+            if (!rowValid || yAxis.cell[y] != rowY)
+            {
+                rowValid = true;
+                rowY = yAxis.cell[y];
+
+                int y0 = PrimeCell(rowY, PrimeY, period);
+                int y1 = PrimeCell(rowY + 1, PrimeY, period);
+                for (int i = 0; i < points; i++)
+                {
+                    int xPrimed = PrimeCell(xAxis.first + i, PrimeX, period);
+                    values[i * 2] = ValCoord(seed, xPrimed, y0);
+                    values[i * 2 + 1] = ValCoord(seed, xPrimed, y1);
+                }
+            }
+
+            float yw = InterpHermite(yAxis.offset[y]);
+
+            float* row = out + y * xSize;
+            for (int x = 0; x < xSize; x++)
+            {
+                const float* v = &values[(xAxis.cell[x] - xAxis.first) * 2];
+
+                float xf0 = Lerp(v[0], v[2], xWeight[x]);
+                float xf1 = Lerp(v[1], v[3], xWeight[x]);
+
+                row[x] = Lerp(xf0, xf1, yw);
+            }
+        }
+    }
+
+    void GenValueGridSingle(int seed, const float* xs, const float* ys, const float* zs, int xSize, int ySize, int zSize, float* out, int period) const
+    {
+        GridLatticeAxis xAxis(xs, xSize), yAxis(ys, ySize), zAxis(zs, zSize);
+        if (xAxis.Sparse(xSize)) return GenGridPerSample(seed, xs, ys, zs, xSize, ySize, zSize, out, period);
+
+        std::vector<float> xWeight(xSize);
+        for (int x = 0; x < xSize; x++) xWeight[x] = InterpHermite(xAxis.offset[x]);
+
+        // Values along the current cell row, [x point][y0z0, y1z0, y0z1, y1z1]
+        int points = xAxis.count + 1;
+        std::vector<float> values(points * 4);
+        bool rowValid = false;
+        int rowY = 0, rowZ = 0;
+
+        for (int z = 0; z < zSize; z++)
+        {
+            float zw = InterpHermite(zAxis.offset[z]);
+
+            for (int y = 0; y < ySize; y++)
+            {
+                if (!rowValid || yAxis.cell[y] != rowY || zAxis.cell[z] != rowZ)
+                {
+                    rowValid = true;
+                    rowY = yAxis.cell[y];
+                    rowZ = zAxis.cell[z];
+
+                    int y0 = PrimeCell(rowY, PrimeY, period);
+                    int y1 = PrimeCell(rowY + 1, PrimeY, period);
+                    int z0 = PrimeCell(rowZ, PrimeZ, period);
+                    int z1 = PrimeCell(rowZ + 1, PrimeZ, period);
+                    for (int i = 0; i < points; i++)
+                    {
+                        int xPrimed = PrimeCell(xAxis.first + i, PrimeX, period);
+                        values[i * 4] = ValCoord(seed, xPrimed, y0, z0);
+                        values[i * 4 + 1] = ValCoord(seed, xPrimed, y1, z0);
+                        values[i * 4 + 2] = ValCoord(seed, xPrimed, y0, z1);
+                        values[i * 4 + 3] = ValCoord(seed, xPrimed, y1, z1);
+                    }
+                }
+
+                float yw = InterpHermite(yAxis.offset[y]);
+
+                float* row = out + (z * ySize + y) * xSize;
+                for (int x = 0; x < xSize; x++)
+                {
+                    const float* v = &values[(xAxis.cell[x] - xAxis.first) * 4];
+
+                    float xf00 = Lerp(v[0], v[4], xWeight[x]);
+                    float xf10 = Lerp(v[1], v[5], xWeight[x]);
+                    float xf01 = Lerp(v[2], v[6], xWeight[x]);
+                    float xf11 = Lerp(v[3], v[7], xWeight[x]);
+
+                    float yf0 = Lerp(xf00, xf10, yw);
+                    float yf1 = Lerp(xf01, xf11, yw);
+
+                    row[x] = Lerp(yf0, yf1, zw);
+                }
+            }
+        }
+    }
+
+
+#ifdef FNL_BATCH_SIMD
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+    // Batch Noise Gen
+    //
+    // BatchGen<W> mirrors the scalar noise functions operation for operation on W lanes at once,
+    // so every lane rounds exactly like GetNoise(...). Branches become per-lane selects.
+    // The ISA entry points flatten everything into one function compiled for their instruction set.
+
+    bool BatchSupported() const
+    {
+        switch (mNoiseType)
+        {
+        case NoiseType_OpenSimplex2:
+        case NoiseType_Cellular:
+        case NoiseType_Perlin:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static int BatchLevel()
+    {
+        static const int level =
+            __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") ? 3 :
+            __builtin_cpu_supports("avx2") ? 2 :
+            __builtin_cpu_supports("sse4.1") ? 1 : 0;
+        return level;
+    }
+
+    __attribute__((target("sse4.1"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchSSE41(const float* xs, const float* ys, float* out, int count) const { return BatchGen<4>::Gen(*this, xs, ys, out, count); }
+
+    __attribute__((target("sse4.1"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchSSE41(const float* xs, const float* ys, const float* zs, float* out, int count) const { return BatchGen<4>::Gen(*this, xs, ys, zs, out, count); }
+
+    __attribute__((target("avx2"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchAVX2(const float* xs, const float* ys, float* out, int count) const { return BatchGen<8>::Gen(*this, xs, ys, out, count); }
+
+    __attribute__((target("avx2"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchAVX2(const float* xs, const float* ys, const float* zs, float* out, int count) const { return BatchGen<8>::Gen(*this, xs, ys, zs, out, count); }
+
+    __attribute__((target("avx512f,avx512dq"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchAVX512(const float* xs, const float* ys, float* out, int count) const { return BatchGen<16>::Gen(*this, xs, ys, out, count); }
+
+    __attribute__((target("avx512f,avx512dq"), optimize("fp-contract=off"), flatten))
+    int GetNoiseBatchAVX512(const float* xs, const float* ys, const float* zs, float* out, int count) const { return BatchGen<16>::Gen(*this, xs, ys, zs, out, count); }
+
+    __attribute__((target("sse4.1"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchSSE41(float* xs, float* ys, int count) const { return BatchGen<4>::Warp(*this, xs, ys, count); }
+
+    __attribute__((target("sse4.1"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchSSE41(float* xs, float* ys, float* zs, int count) const { return BatchGen<4>::Warp(*this, xs, ys, zs, count); }
+
+    __attribute__((target("avx2"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchAVX2(float* xs, float* ys, int count) const { return BatchGen<8>::Warp(*this, xs, ys, count); }
+
+    __attribute__((target("avx2"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchAVX2(float* xs, float* ys, float* zs, int count) const { return BatchGen<8>::Warp(*this, xs, ys, zs, count); }
+
+    __attribute__((target("avx512f,avx512dq"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchAVX512(float* xs, float* ys, int count) const { return BatchGen<16>::Warp(*this, xs, ys, count); }
+
+    __attribute__((target("avx512f,avx512dq"), optimize("fp-contract=off"), flatten))
+    int DomainWarpBatchAVX512(float* xs, float* ys, float* zs, int count) const { return BatchGen<16>::Warp(*this, xs, ys, zs, count); }
+
+    // Vector types live outside BatchGen, GCC only applies a dependent vector_size through a separate template
+    template <int W>
+    struct BatchVec
+    {
+        typedef float vf __attribute__((vector_size(W * sizeof(float))));
+        typedef int vi __attribute__((vector_size(W * sizeof(int))));
+    };
+
+    template <int W>
+    struct BatchGen
+    {
+        typedef typename BatchVec<W>::vf vf;
+        typedef typename BatchVec<W>::vi vi;
+
+        static vf Load(const float* p)
+        {
+            vf v;
+            __builtin_memcpy(&v, p, sizeof(vf));
+            return v;
+        }
+
+        static void Store(float* p, vf v) { __builtin_memcpy(p, &v, sizeof(vf)); }
+
+        static vf Set(float f)
+        {
+            float lanes[W];
+            for (int l = 0; l < W; l++) lanes[l] = f;
+            return Load(lanes);
+        }
+
+        static vf ToFloat(vi v) { return __builtin_convertvector(v, vf); }
+
+        static vi ToInt(vf v) { return __builtin_convertvector(v, vi); }
+
+        static vf Blend(vi mask, vf a, vf b) { return (vf)(((vi)a & mask) | ((vi)b & ~mask)); }
+
+        static vf FastMin(vf a, vf b) { return a < b ? a : b; }
+
+        static vf FastMax(vf a, vf b) { return a > b ? a : b; }
+
+        static vf FastAbs(vf f) { return f < 0.0f ? -f : f; }
+
+        static vf FastSqrt(vf f)
+        {
+            float lanes[W];
+            Store(lanes, f);
+            for (int l = 0; l < W; l++) lanes[l] = __builtin_sqrtf(lanes[l]);
+            return Load(lanes);
+        }
+
+        // Table lookups are done one lane at a time, the indices are already masked to the table size
+        static vf Gather(const float* table, vi index)
+        {
+            int indices[W];
+            float lanes[W];
+            __builtin_memcpy(indices, &index, sizeof(vi));
+            for (int l = 0; l < W; l++) lanes[l] = table[indices[l]];
+            return Load(lanes);
+        }
+
+        static vi FastFloor(vf f)
+        {
+            vi i = ToInt(f);
+            return f >= 0.0f ? i : i - 1;
+        }
+
+        static vi FastRound(vf f) { return ToInt(f >= 0.0f ? f + 0.5f : f - 0.5f); }
+
+        static vf Lerp(vf a, vf b, vf t) { return a + t * (b - a); }
+
+        static vf LerpWeight(vf b, float t) { return 1.0f + t * (b - 1.0f); }
+
+        static vf InterpQuintic(vf t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+
+        static vf PingPong(vf t)
+        {
+            t -= ToFloat(ToInt(t * 0.5f) * 2);
+            return t < 1.0f ? t : 2.0f - t;
+        }
+
+        static vi Hash(int seed, vi xPrimed, vi yPrimed)
+        {
+            vi hash = seed ^ xPrimed ^ yPrimed;
+
+            hash *= 0x27d4eb2d;
+            return hash;
+        }
+
+        static vi Hash(int seed, vi xPrimed, vi yPrimed, vi zPrimed)
+        {
+            vi hash = seed ^ xPrimed ^ yPrimed ^ zPrimed;
+
+            hash *= 0x27d4eb2d;
+            return hash;
+        }
+
+        static vf GradCoord(int seed, vi xPrimed, vi yPrimed, vf xd, vf yd)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed);
+            hash ^= hash >> 15;
+            hash &= 127 << 1;
+
+            vf xg = Gather(Lookup<float>::Gradients2D, hash);
+            vf yg = Gather(Lookup<float>::Gradients2D + 1, hash);
+
+            return xd * xg + yd * yg;
+        }
+
+        static vf GradCoord(int seed, vi xPrimed, vi yPrimed, vi zPrimed, vf xd, vf yd, vf zd)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+            hash ^= hash >> 15;
+            hash &= 63 << 2;
+
+            vf xg = Gather(Lookup<float>::Gradients3D, hash);
+            vf yg = Gather(Lookup<float>::Gradients3D + 1, hash);
+            vf zg = Gather(Lookup<float>::Gradients3D + 2, hash);
+
+            return xd * xg + yd * yg + zd * zg;
+        }
+
+        // Same as FastNoiseLite::PrimeCell(...), the quotient is estimated in float and corrected by one either way,
+        // exact while the cells stay within 2^24
+        static vi PrimeCell(vi cell, int prime, int period)
+        {
+            if (period > 0)
+            {
+                vi quotient = ToInt(ToFloat(cell) * (1.0f / period));
+                cell -= quotient * period;
+                cell = cell < 0 ? cell + period : cell;
+                cell = cell >= period ? cell - period : cell;
+                cell = cell < 0 ? cell + period : cell;
+            }
+            return cell * prime;
+        }
+
+
+        // Coordinate transforms
+
+        static void TransformNoiseCoordinate(const FastNoiseLite& n, vf& x, vf& y)
+        {
+            x *= n.mFrequency;
+            y *= n.mFrequency;
+
+            if (n.mNoiseType == NoiseType_OpenSimplex2 || n.mNoiseType == NoiseType_OpenSimplex2S)
+            {
+                const float SQRT3 = (float)1.7320508075688772935274463415059;
+                const float F2 = 0.5f * (SQRT3 - 1);
+                vf t = (x + y) * F2;
+                x += t;
+                y += t;
+            }
+        }
+
+        static void TransformNoiseCoordinate(const FastNoiseLite& n, vf& x, vf& y, vf& z)
+        {
+            x *= n.mFrequency;
+            y *= n.mFrequency;
+            z *= n.mFrequency;
+
+            switch (n.mTransformType3D)
+            {
+            case TransformType3D_ImproveXYPlanes:
+                {
+                    vf xy = x + y;
+                    vf s2 = xy * -(float)0.211324865405187;
+                    z *= (float)0.577350269189626;
+                    x += s2 - z;
+                    y = y + s2 - z;
+                    z += xy * (float)0.577350269189626;
+                }
+                break;
+            case TransformType3D_ImproveXZPlanes:
+                {
+                    vf xz = x + z;
+                    vf s2 = xz * -(float)0.211324865405187;
+                    y *= (float)0.577350269189626;
+                    x += s2 - y;
+                    z += s2 - y;
+                    y += xz * (float)0.577350269189626;
+                }
+                break;
+            case TransformType3D_DefaultOpenSimplex2:
+                {
+                    const float R3 = (float)(2.0 / 3.0);
+                    vf r = (x + y + z) * R3; // Rotation, not skew
+                    x = r - x;
+                    y = r - y;
+                    z = r - z;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+
+        // Single noise
+
+        template <NoiseType Type>
+        static vf GenNoiseSingle(const FastNoiseLite& n, int seed, vf x, vf y, int period)
+        {
+            switch (Type)
+            {
+            case NoiseType_OpenSimplex2:
+                return SingleSimplex(seed, x, y);
+            case NoiseType_Cellular:
+                return SingleCellular(n, seed, x, y, period);
+            default:
+                return SinglePerlin(seed, x, y, period);
+            }
+        }
+
+        template <NoiseType Type>
+        static vf GenNoiseSingle(const FastNoiseLite& n, int seed, vf x, vf y, vf z, int period)
+        {
+            switch (Type)
+            {
+            case NoiseType_OpenSimplex2:
+                return SingleOpenSimplex2(seed, x, y, z);
+            case NoiseType_Cellular:
+                return SingleCellular(n, seed, x, y, z, period);
+            default:
+                return SinglePerlin(seed, x, y, z, period);
+            }
+        }
+
+        static vf SingleSimplex(int seed, vf x, vf y)
+        {
+            const float SQRT3 = 1.7320508075688772935274463415059f;
+            const float G2 = (3 - SQRT3) / 6;
+
+            vi i = FastFloor(x);
+            vi j = FastFloor(y);
+            vf xi = x - ToFloat(i);
+            vf yi = y - ToFloat(j);
+
+            vf t = (xi + yi) * G2;
+            vf x0 = xi - t;
+            vf y0 = yi - t;
+
+            i *= PrimeX;
+            j *= PrimeY;
+
+            vf a = 0.5f - x0 * x0 - y0 * y0;
+            vf n0 = a <= 0.0f ? 0.0f : (a * a) * (a * a) * GradCoord(seed, i, j, x0, y0);
+
+            vf c = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a);
+            vf x2 = x0 + (2 * (float)G2 - 1);
+            vf y2 = y0 + (2 * (float)G2 - 1);
+            vf n2 = c <= 0.0f ? 0.0f : (c * c) * (c * c) * GradCoord(seed, i + PrimeX, j + PrimeY, x2, y2);
+
+            vf x1 = y0 > x0 ? x0 + (float)G2 : x0 + ((float)G2 - 1);
+            vf y1 = y0 > x0 ? y0 + ((float)G2 - 1) : y0 + (float)G2;
+            vi i1 = y0 > x0 ? i : i + PrimeX;
+            vi j1 = y0 > x0 ? j + PrimeY : j;
+            vf b = 0.5f - x1 * x1 - y1 * y1;
+            vf n1 = b <= 0.0f ? 0.0f : (b * b) * (b * b) * GradCoord(seed, i1, j1, x1, y1);
+
+            return (n0 + n1 + n2) * 99.83685446303647f;
+        }
+
+        static vf SingleOpenSimplex2(int seed, vf x, vf y, vf z)
+        {
+            vi i = FastRound(x);
+            vi j = FastRound(y);
+            vi k = FastRound(z);
+            vf x0 = x - ToFloat(i);
+            vf y0 = y - ToFloat(j);
+            vf z0 = z - ToFloat(k);
+
+            vi xNSign = ToInt(-1.0f - x0) | 1;
+            vi yNSign = ToInt(-1.0f - y0) | 1;
+            vi zNSign = ToInt(-1.0f - z0) | 1;
+
+            vf ax0 = ToFloat(xNSign) * -x0;
+            vf ay0 = ToFloat(yNSign) * -y0;
+            vf az0 = ToFloat(zNSign) * -z0;
+
+            i *= PrimeX;
+            j *= PrimeY;
+            k *= PrimeZ;
+
+            vf value = Set(0);
+            vf a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+
+            for (int l = 0; ; l++)
+            {
+                value = a > 0.0f ? value + (a * a) * (a * a) * GradCoord(seed, i, j, k, x0, y0, z0) : value;
+
+                vf b = a + 1.0f;
+
+                // Step along the axis with the largest offset, ties go to x then y like the scalar branches.
+                // The lane masks are combined as integers, GCC scalarises 16 lane comparison masks that get and-ed together
+                vi stepX = ToInt(ax0 >= FastMax(ay0, az0) ? Set(-1) : Set(0));
+                vi stepY = ToInt(ay0 >= FastMax(ax0, az0) ? Set(-1) : Set(0)) & ~stepX;
+                vi stepZ = ~(stepX | stepY);
+
+                vf x1 = x0 + ToFloat(xNSign);
+                vf y1 = y0 + ToFloat(yNSign);
+                vf z1 = z0 + ToFloat(zNSign);
+
+                vf b1 = Blend(stepX, b - ToFloat(xNSign * 2) * x1, b);
+                b1 = Blend(stepY, b - ToFloat(yNSign * 2) * y1, b1);
+                b1 = Blend(stepZ, b - ToFloat(zNSign * 2) * z1, b1);
+
+                x1 = Blend(stepX, x1, x0);
+                y1 = Blend(stepY, y1, y0);
+                z1 = Blend(stepZ, z1, z0);
+                vi i1 = i - (xNSign * PrimeX & stepX);
+                vi j1 = j - (yNSign * PrimeY & stepY);
+                vi k1 = k - (zNSign * PrimeZ & stepZ);
+
+                value = b1 > 0.0f ? value + (b1 * b1) * (b1 * b1) * GradCoord(seed, i1, j1, k1, x1, y1, z1) : value;
+
+                if (l == 1) break;
+
+                ax0 = 0.5f - ax0;
+                ay0 = 0.5f - ay0;
+                az0 = 0.5f - az0;
+
+                x0 = ToFloat(xNSign) * ax0;
+                y0 = ToFloat(yNSign) * ay0;
+                z0 = ToFloat(zNSign) * az0;
+
+                a += (0.75f - ax0) - (ay0 + az0);
+
+                i += (xNSign >> 1) & PrimeX;
+                j += (yNSign >> 1) & PrimeY;
+                k += (zNSign >> 1) & PrimeZ;
+
+                xNSign = -xNSign;
+                yNSign = -yNSign;
+                zNSign = -zNSign;
+
+                seed = ~seed;
+            }
+
+            return value * 32.69428253173828125f;
+        }
+
+        static vf CellularReturn(const FastNoiseLite& n, vf distance0, vf distance1, vi closestHash)
+        {
+            if (n.mCellularDistanceFunction == CellularDistanceFunction_Euclidean && n.mCellularReturnType >= CellularReturnType_Distance)
+            {
+                distance0 = FastSqrt(distance0);
+
+                if (n.mCellularReturnType >= CellularReturnType_Distance2)
+                {
+                    distance1 = FastSqrt(distance1);
+                }
+            }
+
+            switch (n.mCellularReturnType)
+            {
+            case CellularReturnType_CellValue:
+                return ToFloat(closestHash) * (1 / 2147483648.0f);
+            case CellularReturnType_Distance:
+                return distance0 - 1.0f;
+            case CellularReturnType_Distance2:
+                return distance1 - 1.0f;
+            case CellularReturnType_Distance2Add:
+                return (distance1 + distance0) * 0.5f - 1.0f;
+            case CellularReturnType_Distance2Sub:
+                return distance1 - distance0 - 1.0f;
+            case CellularReturnType_Distance2Mul:
+                return distance1 * distance0 * 0.5f - 1.0f;
+            case CellularReturnType_Distance2Div:
+                return distance0 / distance1 - 1.0f;
+            default:
+                return Set(0);
+            }
+        }
+
+        template <CellularDistanceFunction DistanceFunction>
+        static vf CellularDistance(vf vecX, vf vecY)
+        {
+            switch (DistanceFunction)
+            {
+            case CellularDistanceFunction_Manhattan:
+                return FastAbs(vecX) + FastAbs(vecY);
+            case CellularDistanceFunction_Hybrid:
+                return (FastAbs(vecX) + FastAbs(vecY)) + (vecX * vecX + vecY * vecY);
+            default:
+                return vecX * vecX + vecY * vecY;
+            }
+        }
+
+        template <CellularDistanceFunction DistanceFunction>
+        static vf CellularDistance(vf vecX, vf vecY, vf vecZ)
+        {
+            switch (DistanceFunction)
+            {
+            case CellularDistanceFunction_Manhattan:
+                return FastAbs(vecX) + FastAbs(vecY) + FastAbs(vecZ);
+            case CellularDistanceFunction_Hybrid:
+                return (FastAbs(vecX) + FastAbs(vecY) + FastAbs(vecZ)) + (vecX * vecX + vecY * vecY + vecZ * vecZ);
+            default:
+                return vecX * vecX + vecY * vecY + vecZ * vecZ;
+            }
+        }
+
+        template <CellularDistanceFunction DistanceFunction>
+        static vf SingleCellular(const FastNoiseLite& n, int seed, vf x, vf y, int period)
+        {
+            vi xr = FastRound(x);
+            vi yr = FastRound(y);
+
+            vf distance0 = Set(1e10f);
+            vf distance1 = Set(1e10f);
+            vi closestHash = xr ^ xr;
+
+            float cellularJitter = 0.43701595f * n.mCellularJitterModifier;
+
+            vi xPrimes[3], yPrimes[3];
+            for (int i = 0; i < 3; i++)
+            {
+                xPrimes[i] = PrimeCell(xr - 1 + i, PrimeX, period);
+                yPrimes[i] = PrimeCell(yr - 1 + i, PrimeY, period);
+            }
+
+            for (int xo = -1; xo <= 1; xo++)
+            {
+                vf xd = ToFloat(xr + xo) - x;
+
+                for (int yo = -1; yo <= 1; yo++)
+                {
+                    vi hash = Hash(seed, xPrimes[xo + 1], yPrimes[yo + 1]);
+                    vi idx = hash & (255 << 1);
+
+                    vf randX = Gather(Lookup<float>::RandVecs2D, idx);
+                    vf randY = Gather(Lookup<float>::RandVecs2D + 1, idx);
+
+                    vf vecX = xd + randX * cellularJitter;
+                    vf vecY = (ToFloat(yr + yo) - y) + randY * cellularJitter;
+
+                    vf newDistance = CellularDistance<DistanceFunction>(vecX, vecY);
+
+                    distance1 = FastMax(FastMin(distance1, newDistance), distance0);
+                    closestHash = newDistance < distance0 ? hash : closestHash;
+                    distance0 = FastMin(newDistance, distance0);
+                }
+            }
+
+            return CellularReturn(n, distance0, distance1, closestHash);
+        }
+
+        template <CellularDistanceFunction DistanceFunction>
+        static vf SingleCellular(const FastNoiseLite& n, int seed, vf x, vf y, vf z, int period)
+        {
+            vi xr = FastRound(x);
+            vi yr = FastRound(y);
+            vi zr = FastRound(z);
+
+            vf distance0 = Set(1e10f);
+            vf distance1 = Set(1e10f);
+            vi closestHash = xr ^ xr;
+
+            float cellularJitter = 0.39614353f * n.mCellularJitterModifier;
+
+            vi xPrimes[3], yPrimes[3], zPrimes[3];
+            for (int i = 0; i < 3; i++)
+            {
+                xPrimes[i] = PrimeCell(xr - 1 + i, PrimeX, period);
+                yPrimes[i] = PrimeCell(yr - 1 + i, PrimeY, period);
+                zPrimes[i] = PrimeCell(zr - 1 + i, PrimeZ, period);
+            }
+
+            for (int xo = -1; xo <= 1; xo++)
+            {
+                vf xd = ToFloat(xr + xo) - x;
+
+                for (int yo = -1; yo <= 1; yo++)
+                {
+                    vf yd = ToFloat(yr + yo) - y;
+
+                    for (int zo = -1; zo <= 1; zo++)
+                    {
+                        vi hash = Hash(seed, xPrimes[xo + 1], yPrimes[yo + 1], zPrimes[zo + 1]);
+                        vi idx = hash & (255 << 2);
+
+                        vf randX = Gather(Lookup<float>::RandVecs3D, idx);
+                        vf randY = Gather(Lookup<float>::RandVecs3D + 1, idx);
+                        vf randZ = Gather(Lookup<float>::RandVecs3D + 2, idx);
+
+                        vf vecX = xd + randX * cellularJitter;
+                        vf vecY = yd + randY * cellularJitter;
+                        vf vecZ = (ToFloat(zr + zo) - z) + randZ * cellularJitter;
+
+                        vf newDistance = CellularDistance<DistanceFunction>(vecX, vecY, vecZ);
+
+                        distance1 = FastMax(FastMin(distance1, newDistance), distance0);
+                        closestHash = newDistance < distance0 ? hash : closestHash;
+                        distance0 = FastMin(newDistance, distance0);
+                    }
+                }
+            }
+
+            return CellularReturn(n, distance0, distance1, closestHash);
+        }
+
+        static vf SingleCellular(const FastNoiseLite& n, int seed, vf x, vf y, int period)
+        {
+            switch (n.mCellularDistanceFunction)
+            {
+            case CellularDistanceFunction_Manhattan:
+                return SingleCellular<CellularDistanceFunction_Manhattan>(n, seed, x, y, period);
+            case CellularDistanceFunction_Hybrid:
+                return SingleCellular<CellularDistanceFunction_Hybrid>(n, seed, x, y, period);
+            default:
+                return SingleCellular<CellularDistanceFunction_Euclidean>(n, seed, x, y, period);
+            }
+        }
+
+        static vf SingleCellular(const FastNoiseLite& n, int seed, vf x, vf y, vf z, int period)
+        {
+            switch (n.mCellularDistanceFunction)
+            {
+            case CellularDistanceFunction_Manhattan:
+                return SingleCellular<CellularDistanceFunction_Manhattan>(n, seed, x, y, z, period);
+            case CellularDistanceFunction_Hybrid:
+                return SingleCellular<CellularDistanceFunction_Hybrid>(n, seed, x, y, z, period);
+            default:
+                return SingleCellular<CellularDistanceFunction_Euclidean>(n, seed, x, y, z, period);
+            }
+        }
+
+        static vf SinglePerlin(int seed, vf x, vf y, int period)
+        {
+            vi x0 = FastFloor(x);
+            vi y0 = FastFloor(y);
+
+            vf xd0 = x - ToFloat(x0);
+            vf yd0 = y - ToFloat(y0);
+            vf xd1 = xd0 - 1.0f;
+            vf yd1 = yd0 - 1.0f;
+
+            vf xs = InterpQuintic(xd0);
+            vf ys = InterpQuintic(yd0);
+
+            vi x1 = PrimeCell(x0 + 1, PrimeX, period);
+            vi y1 = PrimeCell(y0 + 1, PrimeY, period);
+            x0 = PrimeCell(x0, PrimeX, period);
+            y0 = PrimeCell(y0, PrimeY, period);
+
+            vf xf0 = Lerp(GradCoord(seed, x0, y0, xd0, yd0), GradCoord(seed, x1, y0, xd1, yd0), xs);
+            vf xf1 = Lerp(GradCoord(seed, x0, y1, xd0, yd1), GradCoord(seed, x1, y1, xd1, yd1), xs);
+
+            return Lerp(xf0, xf1, ys) * 1.4247691104677813f;
+        }
+
+        static vf SinglePerlin(int seed, vf x, vf y, vf z, int period)
+        {
+            vi x0 = FastFloor(x);
+            vi y0 = FastFloor(y);
+            vi z0 = FastFloor(z);
+
+            vf xd0 = x - ToFloat(x0);
+            vf yd0 = y - ToFloat(y0);
+            vf zd0 = z - ToFloat(z0);
+            vf xd1 = xd0 - 1.0f;
+            vf yd1 = yd0 - 1.0f;
+            vf zd1 = zd0 - 1.0f;
+
+            vf xs = InterpQuintic(xd0);
+            vf ys = InterpQuintic(yd0);
+            vf zs = InterpQuintic(zd0);
+
+            vi x1 = PrimeCell(x0 + 1, PrimeX, period);
+            vi y1 = PrimeCell(y0 + 1, PrimeY, period);
+            vi z1 = PrimeCell(z0 + 1, PrimeZ, period);
+            x0 = PrimeCell(x0, PrimeX, period);
+            y0 = PrimeCell(y0, PrimeY, period);
+            z0 = PrimeCell(z0, PrimeZ, period);
+
+            vf xf00 = Lerp(GradCoord(seed, x0, y0, z0, xd0, yd0, zd0), GradCoord(seed, x1, y0, z0, xd1, yd0, zd0), xs);
+            vf xf10 = Lerp(GradCoord(seed, x0, y1, z0, xd0, yd1, zd0), GradCoord(seed, x1, y1, z0, xd1, yd1, zd0), xs);
+            vf xf01 = Lerp(GradCoord(seed, x0, y0, z1, xd0, yd0, zd1), GradCoord(seed, x1, y0, z1, xd1, yd0, zd1), xs);
+            vf xf11 = Lerp(GradCoord(seed, x0, y1, z1, xd0, yd1, zd1), GradCoord(seed, x1, y1, z1, xd1, yd1, zd1), xs);
+
+            vf yf0 = Lerp(xf00, xf10, ys);
+            vf yf1 = Lerp(xf01, xf11, ys);
+
+            return Lerp(yf0, yf1, zs) * 0.964921414852142333984375f;
+        }
+
+
+        // Fractals
+
+        template <NoiseType Type>
+        static vf GenFractal(const FastNoiseLite& n, vf x, vf y)
+        {
+            int seed = n.mSeed;
+            int period = n.mPeriod;
+            vf sum = Set(0);
+            vf amp = Set(n.mFractalBounding);
+
+            switch (n.mFractalType)
+            {
+            default:
+                return GenNoiseSingle<Type>(n, seed, x, y, period);
+            case FractalType_FBm:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = GenNoiseSingle<Type>(n, seed++, x, y, period);
+                    sum += noise * amp;
+                    amp *= LerpWeight(FastMin(noise + 1.0f, Set(2)) * 0.5f, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            case FractalType_Ridged:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = FastAbs(GenNoiseSingle<Type>(n, seed++, x, y, period));
+                    sum += (noise * -2.0f + 1.0f) * amp;
+                    amp *= LerpWeight(1.0f - noise, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            case FractalType_PingPong:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = PingPong((GenNoiseSingle<Type>(n, seed++, x, y, period) + 1.0f) * n.mPingPongStrength);
+                    sum += (noise - 0.5f) * 2.0f * amp;
+                    amp *= LerpWeight(noise, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            }
+        }
+
+        template <NoiseType Type>
+        static vf GenFractal(const FastNoiseLite& n, vf x, vf y, vf z)
+        {
+            int seed = n.mSeed;
+            int period = n.mPeriod;
+            vf sum = Set(0);
+            vf amp = Set(n.mFractalBounding);
+
+            switch (n.mFractalType)
+            {
+            default:
+                return GenNoiseSingle<Type>(n, seed, x, y, z, period);
+            case FractalType_FBm:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = GenNoiseSingle<Type>(n, seed++, x, y, z, period);
+                    sum += noise * amp;
+                    amp *= LerpWeight((noise + 1.0f) * 0.5f, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    z *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            case FractalType_Ridged:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = FastAbs(GenNoiseSingle<Type>(n, seed++, x, y, z, period));
+                    sum += (noise * -2.0f + 1.0f) * amp;
+                    amp *= LerpWeight(1.0f - noise, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    z *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            case FractalType_PingPong:
+                for (int i = 0; i < n.mOctaves; i++)
+                {
+                    vf noise = PingPong((GenNoiseSingle<Type>(n, seed++, x, y, z, period) + 1.0f) * n.mPingPongStrength);
+                    sum += (noise - 0.5f) * 2.0f * amp;
+                    amp *= LerpWeight(noise, n.mWeightedStrength);
+
+                    x *= n.mLacunarity;
+                    y *= n.mLacunarity;
+                    z *= n.mLacunarity;
+                    amp *= n.mGain;
+                    period = n.NextOctavePeriod(period);
+                }
+                return sum;
+            }
+        }
+
+
+        // Domain warp
+
+        static vf InterpHermite(vf t) { return t * t * (3.0f - 2.0f * t); }
+
+        static void GradCoordOut(int seed, vi xPrimed, vi yPrimed, vf& xo, vf& yo)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed) & (255 << 1);
+
+            xo = Gather(Lookup<float>::RandVecs2D, hash);
+            yo = Gather(Lookup<float>::RandVecs2D + 1, hash);
+        }
+
+        static void GradCoordOut(int seed, vi xPrimed, vi yPrimed, vi zPrimed, vf& xo, vf& yo, vf& zo)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed, zPrimed) & (255 << 2);
+
+            xo = Gather(Lookup<float>::RandVecs3D, hash);
+            yo = Gather(Lookup<float>::RandVecs3D + 1, hash);
+            zo = Gather(Lookup<float>::RandVecs3D + 2, hash);
+        }
+
+        static void GradCoordDual(int seed, vi xPrimed, vi yPrimed, vf xd, vf yd, vf& xo, vf& yo)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed);
+            vi index1 = hash & (127 << 1);
+            vi index2 = (hash >> 7) & (255 << 1);
+
+            vf value = xd * Gather(Lookup<float>::Gradients2D, index1) + yd * Gather(Lookup<float>::Gradients2D + 1, index1);
+
+            xo = value * Gather(Lookup<float>::RandVecs2D, index2);
+            yo = value * Gather(Lookup<float>::RandVecs2D + 1, index2);
+        }
+
+        static void GradCoordDual(int seed, vi xPrimed, vi yPrimed, vi zPrimed, vf xd, vf yd, vf zd, vf& xo, vf& yo, vf& zo)
+        {
+            vi hash = Hash(seed, xPrimed, yPrimed, zPrimed);
+            vi index1 = hash & (63 << 2);
+            vi index2 = (hash >> 6) & (255 << 2);
+
+            vf value = xd * Gather(Lookup<float>::Gradients3D, index1) + yd * Gather(Lookup<float>::Gradients3D + 1, index1) +
+                zd * Gather(Lookup<float>::Gradients3D + 2, index1);
+
+            xo = value * Gather(Lookup<float>::RandVecs3D, index2);
+            yo = value * Gather(Lookup<float>::RandVecs3D + 1, index2);
+            zo = value * Gather(Lookup<float>::RandVecs3D + 2, index2);
+        }
+
+        static void TransformDomainWarpCoordinate(const FastNoiseLite& n, vf& x, vf& y)
+        {
+            if (n.mDomainWarpType == DomainWarpType_OpenSimplex2 || n.mDomainWarpType == DomainWarpType_OpenSimplex2Reduced)
+            {
+                const float SQRT3 = (float)1.7320508075688772935274463415059;
+                const float F2 = 0.5f * (SQRT3 - 1);
+                vf t = (x + y) * F2;
+                x += t;
+                y += t;
+            }
+        }
+
+        static void TransformDomainWarpCoordinate(const FastNoiseLite& n, vf& x, vf& y, vf& z)
+        {
+            switch (n.mWarpTransformType3D)
+            {
+            case TransformType3D_ImproveXYPlanes:
+                {
+                    vf xy = x + y;
+                    vf s2 = xy * -(float)0.211324865405187;
+                    z *= (float)0.577350269189626;
+                    x += s2 - z;
+                    y = y + s2 - z;
+                    z += xy * (float)0.577350269189626;
+                }
+                break;
+            case TransformType3D_ImproveXZPlanes:
+                {
+                    vf xz = x + z;
+                    vf s2 = xz * -(float)0.211324865405187;
+                    y *= (float)0.577350269189626;
+                    x += s2 - y;
+                    z += s2 - y;
+                    y += xz * (float)0.577350269189626;
+                }
+                break;
+            case TransformType3D_DefaultOpenSimplex2:
+                {
+                    const float R3 = (float)(2.0 / 3.0);
+                    vf r = (x + y + z) * R3; // Rotation, not skew
+                    x = r - x;
+                    y = r - y;
+                    z = r - z;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        static void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, vf x, vf y, vf& xr, vf& yr)
+        {
+            vf xf = x * frequency;
+            vf yf = y * frequency;
+
+            vi x0 = FastFloor(xf);
+            vi y0 = FastFloor(yf);
+
+            vf xs = InterpHermite(xf - ToFloat(x0));
+            vf ys = InterpHermite(yf - ToFloat(y0));
+
+            x0 *= PrimeX;
+            y0 *= PrimeY;
+            vi x1 = x0 + PrimeX;
+            vi y1 = y0 + PrimeY;
+
+            vi hash0 = Hash(seed, x0, y0) & (255 << 1);
+            vi hash1 = Hash(seed, x1, y0) & (255 << 1);
+
+            vf lx0x = Lerp(Gather(Lookup<float>::RandVecs2D, hash0), Gather(Lookup<float>::RandVecs2D, hash1), xs);
+            vf ly0x = Lerp(Gather(Lookup<float>::RandVecs2D + 1, hash0), Gather(Lookup<float>::RandVecs2D + 1, hash1), xs);
+
+            hash0 = Hash(seed, x0, y1) & (255 << 1);
+            hash1 = Hash(seed, x1, y1) & (255 << 1);
+
+            vf lx1x = Lerp(Gather(Lookup<float>::RandVecs2D, hash0), Gather(Lookup<float>::RandVecs2D, hash1), xs);
+            vf ly1x = Lerp(Gather(Lookup<float>::RandVecs2D + 1, hash0), Gather(Lookup<float>::RandVecs2D + 1, hash1), xs);
+
+            xr += Lerp(lx0x, lx1x, ys) * warpAmp;
+            yr += Lerp(ly0x, ly1x, ys) * warpAmp;
+        }
+
+        static void SingleDomainWarpBasicGrid(int seed, float warpAmp, float frequency, vf x, vf y, vf z, vf& xr, vf& yr, vf& zr)
+        {
+            vf xf = x * frequency;
+            vf yf = y * frequency;
+            vf zf = z * frequency;
+
+            vi x0 = FastFloor(xf);
+            vi y0 = FastFloor(yf);
+            vi z0 = FastFloor(zf);
+
+            vf xs = InterpHermite(xf - ToFloat(x0));
+            vf ys = InterpHermite(yf - ToFloat(y0));
+            vf zs = InterpHermite(zf - ToFloat(z0));
+
+            x0 *= PrimeX;
+            y0 *= PrimeY;
+            z0 *= PrimeZ;
+            vi x1 = x0 + PrimeX;
+            vi y1 = y0 + PrimeY;
+            vi z1 = z0 + PrimeZ;
+
+            // Lerps the random vectors of corners (x0, y, z) and (x1, y, z) along x
+            auto lerpX = [&](vi y, vi z, vf& lx, vf& ly, vf& lz)
+            {
+                vi hash0 = Hash(seed, x0, y, z) & (255 << 2);
+                vi hash1 = Hash(seed, x1, y, z) & (255 << 2);
+
+                lx = Lerp(Gather(Lookup<float>::RandVecs3D, hash0), Gather(Lookup<float>::RandVecs3D, hash1), xs);
+                ly = Lerp(Gather(Lookup<float>::RandVecs3D + 1, hash0), Gather(Lookup<float>::RandVecs3D + 1, hash1), xs);
+                lz = Lerp(Gather(Lookup<float>::RandVecs3D + 2, hash0), Gather(Lookup<float>::RandVecs3D + 2, hash1), xs);
+            };
+
+            vf lx0x, ly0x, lz0x, lx1x, ly1x, lz1x;
+            lerpX(y0, z0, lx0x, ly0x, lz0x);
+            lerpX(y1, z0, lx1x, ly1x, lz1x);
+
+            vf lx0y = Lerp(lx0x, lx1x, ys);
+            vf ly0y = Lerp(ly0x, ly1x, ys);
+            vf lz0y = Lerp(lz0x, lz1x, ys);
+
+            lerpX(y0, z1, lx0x, ly0x, lz0x);
+            lerpX(y1, z1, lx1x, ly1x, lz1x);
+
+            xr += Lerp(lx0y, Lerp(lx0x, lx1x, ys), zs) * warpAmp;
+            yr += Lerp(ly0y, Lerp(ly0x, ly1x, ys), zs) * warpAmp;
+            zr += Lerp(lz0y, Lerp(lz0x, lz1x, ys), zs) * warpAmp;
+        }
+
+        template <bool OutGradOnly>
+        static void SingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequency, vf x, vf y, vf& xr, vf& yr)
+        {
+            const float SQRT3 = 1.7320508075688772935274463415059f;
+            const float G2 = (3 - SQRT3) / 6;
+
+            x *= frequency;
+            y *= frequency;
+
+            vi i = FastFloor(x);
+            vi j = FastFloor(y);
+            vf xi = x - ToFloat(i);
+            vf yi = y - ToFloat(j);
+
+            vf t = (xi + yi) * G2;
+            vf x0 = xi - t;
+            vf y0 = yi - t;
+
+            i *= PrimeX;
+            j *= PrimeY;
+
+            vf vx = Set(0);
+            vf vy = Set(0);
+
+            // Adds the vertex vector weighted by falloff^4 in the lanes where the falloff is positive
+            auto addVertex = [&](vf falloff, vi iv, vi jv, vf xd, vf yd)
+            {
+                vf ffff = (falloff * falloff) * (falloff * falloff);
+                vf xo, yo;
+                if (OutGradOnly)
+                    GradCoordOut(seed, iv, jv, xo, yo);
+                else
+                    GradCoordDual(seed, iv, jv, xd, yd, xo, yo);
+                vx = falloff > 0.0f ? vx + ffff * xo : vx;
+                vy = falloff > 0.0f ? vy + ffff * yo : vy;
+            };
+
+            vf a = 0.5f - x0 * x0 - y0 * y0;
+            addVertex(a, i, j, x0, y0);
+
+            vf c = (float)(2 * (1 - 2 * G2) * (1 / G2 - 2)) * t + ((float)(-2 * (1 - 2 * G2) * (1 - 2 * G2)) + a);
+            addVertex(c, i + PrimeX, j + PrimeY, x0 + (2 * (float)G2 - 1), y0 + (2 * (float)G2 - 1));
+
+            vf x1 = y0 > x0 ? x0 + (float)G2 : x0 + ((float)G2 - 1);
+            vf y1 = y0 > x0 ? y0 + ((float)G2 - 1) : y0 + (float)G2;
+            vi i1 = y0 > x0 ? i : i + PrimeX;
+            vi j1 = y0 > x0 ? j + PrimeY : j;
+            vf b = 0.5f - x1 * x1 - y1 * y1;
+            addVertex(b, i1, j1, x1, y1);
+
+            xr += vx * warpAmp;
+            yr += vy * warpAmp;
+        }
+
+        template <bool OutGradOnly>
+        static void SingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float frequency, vf x, vf y, vf z, vf& xr, vf& yr, vf& zr)
+        {
+            x *= frequency;
+            y *= frequency;
+            z *= frequency;
+
+            vi i = FastRound(x);
+            vi j = FastRound(y);
+            vi k = FastRound(z);
+            vf x0 = x - ToFloat(i);
+            vf y0 = y - ToFloat(j);
+            vf z0 = z - ToFloat(k);
+
+            vi xNSign = ToInt(-x0 - 1.0f) | 1;
+            vi yNSign = ToInt(-y0 - 1.0f) | 1;
+            vi zNSign = ToInt(-z0 - 1.0f) | 1;
+
+            vf ax0 = ToFloat(xNSign) * -x0;
+            vf ay0 = ToFloat(yNSign) * -y0;
+            vf az0 = ToFloat(zNSign) * -z0;
+
+            i *= PrimeX;
+            j *= PrimeY;
+            k *= PrimeZ;
+
+            vf vx = Set(0);
+            vf vy = Set(0);
+            vf vz = Set(0);
+
+            auto addVertex = [&](vf falloff, vi iv, vi jv, vi kv, vf xd, vf yd, vf zd)
+            {
+                vf ffff = (falloff * falloff) * (falloff * falloff);
+                vf xo, yo, zo;
+                if (OutGradOnly)
+                    GradCoordOut(seed, iv, jv, kv, xo, yo, zo);
+                else
+                    GradCoordDual(seed, iv, jv, kv, xd, yd, zd, xo, yo, zo);
+                vx = falloff > 0.0f ? vx + ffff * xo : vx;
+                vy = falloff > 0.0f ? vy + ffff * yo : vy;
+                vz = falloff > 0.0f ? vz + ffff * zo : vz;
+            };
+
+            vf a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+            for (int l = 0; l < 2; l++)
+            {
+                addVertex(a, i, j, k, x0, y0, z0);
+
+                vf b = a + 1.0f;
+
+                // Same axis selection as SingleOpenSimplex2(...)
+                vi stepX = ToInt(ax0 >= FastMax(ay0, az0) ? Set(-1) : Set(0));
+                vi stepY = ToInt(ay0 >= FastMax(ax0, az0) ? Set(-1) : Set(0)) & ~stepX;
+                vi stepZ = ~(stepX | stepY);
+
+                vf x1 = x0 + ToFloat(xNSign);
+                vf y1 = y0 + ToFloat(yNSign);
+                vf z1 = z0 + ToFloat(zNSign);
+
+                vf b1 = Blend(stepX, b - ToFloat(xNSign * 2) * x1, b);
+                b1 = Blend(stepY, b - ToFloat(yNSign * 2) * y1, b1);
+                b1 = Blend(stepZ, b - ToFloat(zNSign * 2) * z1, b1);
+
+                x1 = Blend(stepX, x1, x0);
+                y1 = Blend(stepY, y1, y0);
+                z1 = Blend(stepZ, z1, z0);
+                vi i1 = i - (xNSign * PrimeX & stepX);
+                vi j1 = j - (yNSign * PrimeY & stepY);
+                vi k1 = k - (zNSign * PrimeZ & stepZ);
+
+                addVertex(b1, i1, j1, k1, x1, y1, z1);
+
+                if (l == 1) break;
+
+                ax0 = 0.5f - ax0;
+                ay0 = 0.5f - ay0;
+                az0 = 0.5f - az0;
+
+                x0 = ToFloat(xNSign) * ax0;
+                y0 = ToFloat(yNSign) * ay0;
+                z0 = ToFloat(zNSign) * az0;
+
+                a += (0.75f - ax0) - (ay0 + az0);
+
+                i += (xNSign >> 1) & PrimeX;
+                j += (yNSign >> 1) & PrimeY;
+                k += (zNSign >> 1) & PrimeZ;
+
+                xNSign = -xNSign;
+                yNSign = -yNSign;
+                zNSign = -zNSign;
+
+                seed += 1293373;
+            }
+
+            xr += vx * warpAmp;
+            yr += vy * warpAmp;
+            zr += vz * warpAmp;
+        }
+
+        static void DoSingleDomainWarp(const FastNoiseLite& n, int seed, float amp, float freq, vf x, vf y, vf& xr, vf& yr)
+        {
+            switch (n.mDomainWarpType)
+            {
+            case DomainWarpType_OpenSimplex2:
+                SingleDomainWarpSimplexGradient<false>(seed, amp * 38.283687591552734375f, freq, x, y, xr, yr);
+                break;
+            case DomainWarpType_OpenSimplex2Reduced:
+                SingleDomainWarpSimplexGradient<true>(seed, amp * 16.0f, freq, x, y, xr, yr);
+                break;
+            case DomainWarpType_BasicGrid:
+                SingleDomainWarpBasicGrid(seed, amp, freq, x, y, xr, yr);
+                break;
+            }
+        }
+
+        static void DoSingleDomainWarp(const FastNoiseLite& n, int seed, float amp, float freq, vf x, vf y, vf z, vf& xr, vf& yr, vf& zr)
+        {
+            switch (n.mDomainWarpType)
+            {
+            case DomainWarpType_OpenSimplex2:
+                SingleDomainWarpOpenSimplex2Gradient<false>(seed, amp * 32.69428253173828125f, freq, x, y, z, xr, yr, zr);
+                break;
+            case DomainWarpType_OpenSimplex2Reduced:
+                SingleDomainWarpOpenSimplex2Gradient<true>(seed, amp * 7.71604938271605f, freq, x, y, z, xr, yr, zr);
+                break;
+            case DomainWarpType_BasicGrid:
+                SingleDomainWarpBasicGrid(seed, amp, freq, x, y, z, xr, yr, zr);
+                break;
+            }
+        }
+
+        // DomainWarp(...): the single warp is the progressive one with one octave, the independent one
+        // samples every octave at the position it started from
+        static void DomainWarp(const FastNoiseLite& n, vf& x, vf& y)
+        {
+            int octaves = n.mFractalType == FractalType_DomainWarpProgressive || n.mFractalType == FractalType_DomainWarpIndependent ? n.mOctaves : 1;
+            int seed = n.mSeed;
+            float amp = n.mDomainWarpAmp * n.mFractalBounding;
+            float freq = n.mFrequency;
+
+            vf xs = x;
+            vf ys = y;
+            TransformDomainWarpCoordinate(n, xs, ys);
+
+            for (int i = 0; i < octaves; i++)
+            {
+                if (i > 0 && n.mFractalType == FractalType_DomainWarpProgressive)
+                {
+                    xs = x;
+                    ys = y;
+                    TransformDomainWarpCoordinate(n, xs, ys);
+                }
+
+                DoSingleDomainWarp(n, seed, amp, freq, xs, ys, x, y);
+
+                seed++;
+                amp *= n.mGain;
+                freq *= n.mLacunarity;
+            }
+        }
+
+        static void DomainWarp(const FastNoiseLite& n, vf& x, vf& y, vf& z)
+        {
+            int octaves = n.mFractalType == FractalType_DomainWarpProgressive || n.mFractalType == FractalType_DomainWarpIndependent ? n.mOctaves : 1;
+            int seed = n.mSeed;
+            float amp = n.mDomainWarpAmp * n.mFractalBounding;
+            float freq = n.mFrequency;
+
+            vf xs = x;
+            vf ys = y;
+            vf zs = z;
+            TransformDomainWarpCoordinate(n, xs, ys, zs);
+
+            for (int i = 0; i < octaves; i++)
+            {
+                if (i > 0 && n.mFractalType == FractalType_DomainWarpProgressive)
+                {
+                    xs = x;
+                    ys = y;
+                    zs = z;
+                    TransformDomainWarpCoordinate(n, xs, ys, zs);
+                }
+
+                DoSingleDomainWarp(n, seed, amp, freq, xs, ys, zs, x, y, z);
+
+                seed++;
+                amp *= n.mGain;
+                freq *= n.mLacunarity;
+            }
+        }
+
+
+        // Batch loops, return the number of values written (a multiple of W)
+
+        template <NoiseType Type>
+        static int GenLoop(const FastNoiseLite& n, const float* xs, const float* ys, float* out, int count)
+        {
+            int i = 0;
+            for (; i + W <= count; i += W)
+            {
+                vf x = Load(xs + i);
+                vf y = Load(ys + i);
+                TransformNoiseCoordinate(n, x, y);
+                Store(out + i, GenFractal<Type>(n, x, y));
+            }
+            return i;
+        }
+
+        template <NoiseType Type>
+        static int GenLoop(const FastNoiseLite& n, const float* xs, const float* ys, const float* zs, float* out, int count)
+        {
+            int i = 0;
+            for (; i + W <= count; i += W)
+            {
+                vf x = Load(xs + i);
+                vf y = Load(ys + i);
+                vf z = Load(zs + i);
+                TransformNoiseCoordinate(n, x, y, z);
+                Store(out + i, GenFractal<Type>(n, x, y, z));
+            }
+            return i;
+        }
+
+        static int Gen(const FastNoiseLite& n, const float* xs, const float* ys, float* out, int count)
+        {
+            switch (n.mNoiseType)
+            {
+            case NoiseType_OpenSimplex2:
+                return GenLoop<NoiseType_OpenSimplex2>(n, xs, ys, out, count);
+            case NoiseType_Cellular:
+                return GenLoop<NoiseType_Cellular>(n, xs, ys, out, count);
+            case NoiseType_Perlin:
+                return GenLoop<NoiseType_Perlin>(n, xs, ys, out, count);
+            default:
+                return 0;
+            }
+        }
+
+        static int Gen(const FastNoiseLite& n, const float* xs, const float* ys, const float* zs, float* out, int count)
+        {
+            switch (n.mNoiseType)
+            {
+            case NoiseType_OpenSimplex2:
+                return GenLoop<NoiseType_OpenSimplex2>(n, xs, ys, zs, out, count);
+            case NoiseType_Cellular:
+                return GenLoop<NoiseType_Cellular>(n, xs, ys, zs, out, count);
+            case NoiseType_Perlin:
+                return GenLoop<NoiseType_Perlin>(n, xs, ys, zs, out, count);
+            default:
+                return 0;
+            }
+        }
+
+        static int Warp(const FastNoiseLite& n, float* xs, float* ys, int count)
+        {
+            int i = 0;
+            for (; i + W <= count; i += W)
+            {
+                vf x = Load(xs + i);
+                vf y = Load(ys + i);
+                DomainWarp(n, x, y);
+                Store(xs + i, x);
+                Store(ys + i, y);
+            }
+            return i;
+        }
+
+        static int Warp(const FastNoiseLite& n, float* xs, float* ys, float* zs, int count)
+        {
+            int i = 0;
+            for (; i + W <= count; i += W)
+            {
+                vf x = Load(xs + i);
+                vf y = Load(ys + i);
+                vf z = Load(zs + i);
+                DomainWarp(n, x, y, z);
+                Store(xs + i, x);
+                Store(ys + i, y);
+                Store(zs + i, z);
+            }
+            return i;
+        }
+    };
+
+#pragma GCC diagnostic pop
+#endif
 };
 
 template <>
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "FastNoiseLite.h"
+#include "gpu_noise.h"
+#include "shader_reader.h"
+
+//Maps of where cloudsFrag3.frag can find clouds: the generators of its weather map, and the occupancy maps its raymarcher
+//checks before sampling the density, so it steps through empty sky without paying for three texture fetches a step.
+//The density of a sample is 0 unless its shape noise beats a threshold set by the weather map coverage and the height
+//profile, so the occupancy is two bounds on coarse cells of the two textures: the highest shape value a brick of the
+//shape noise can filter to, and per weather map texel and height layer the lowest shape value its coverage lets
+//through. A step is empty when its brick's bound is below its layer's threshold. Two maps rather than one volume
+//because the shape noise repeats every 1755.62 units and the weather map every 50000, no grid is periodic in both.
+//Both maps carry mip chains of their bounds, the highest shape value of 2 x 2 x 2 bricks and the lowest threshold of
+//2 x 2 texels in each layer, so a coarse cell is only empty where every cell under it is and the raymarcher skips wide
+//spans of sky with one check.
+
+const int SHAPE_BRICK_TEXELS = 4; //shape noise texels per brick and axis
+const int COVERAGE_LAYERS = 16; //height layers of the cloud layer, the threshold of each is bounded separately
+
+//generators of the weather map, compiled into cloudNoise2DGen.comp as worley, worleyMod and perlin
+NoiseStates weatherMapNoiseStates();
+
+//the occupancy maps of cloudsFrag3.frag, baked on the GPU from the textures it samples
+class CloudOccupancy {
+public:
+    GLuint shapeBounds = 0; //highest shape noise value per brick, r8
+    GLuint coverageBounds = 0; //lowest shape noise value that makes a cloud per weather map texel and layer, r8 2D array
+    //both mipmapped down to a single cell per layer
+
+    CloudOccupancy();
+    //bakes both maps from the base levels of the weather map and the shape noise, allocated at their current sizes.
+    //globalCoverage is the gc cloudsFrag3.frag is given. Called again whenever either texture changed, e.g. when a
+    //proxy is replaced, since a map baked from other texels could hide clouds
+    void bake(GLuint weatherMap, GLuint shapeNoise, float globalCoverage);
+
+private:
+    Shader shapeBoundsShader;
+    Shader coverageBoundsShader;
+    Shader shapeBoundsReduceShader;
+    Shader coverageBoundsReduceShader;
+
+    //allocates the full mip chain of an r8 map, GL_TEXTURE_3D or GL_TEXTURE_2D_ARRAY, the level count
+    int allocate(GLenum target, GLuint texture, int width, int height, int depth);
+    //fills the levels above the base level of a map from the level below each
+    void reduce(Shader& reduceShader, GLuint texture, int levels);
+};
+
+NoiseStates weatherMapNoiseStates() {
+    FastNoiseLite weatherWorley, weatherWorleyMod, weatherPerlin;
+    weatherWorley.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
+    weatherWorley.SetFrequency(0.05);
+    weatherWorleyMod.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
+    weatherWorleyMod.SetFrequency(0.048);
+    weatherWorleyMod.SetFractalType(FastNoiseLite::FractalType_FBm);
+    weatherWorleyMod.SetFractalOctaves(3);
+    weatherWorleyMod.SetFractalGain(0.15);
+    weatherPerlin.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
+    weatherPerlin.SetFrequency(0.007);
+    weatherPerlin.SetFractalType(FastNoiseLite::FractalType_FBm);
+    weatherPerlin.SetFractalOctaves(6);
+    weatherPerlin.SetFractalLacunarity(2.18);
+    weatherPerlin.SetFractalGain(0.45);
+    weatherPerlin.SetFractalWeightedStrength(-0.4);
+    NoiseStates states;
+    states.add("worley", weatherWorley);
+    states.add("worleyMod", weatherWorleyMod);
+    states.add("perlin", weatherPerlin);
+    return states;
+}
+
+CloudOccupancy::CloudOccupancy()
+    : shapeBoundsShader("./src/shaders/cloudShapeBoundsGen.comp"),
+      coverageBoundsShader("./src/shaders/cloudCoverageBoundsGen.comp"),
+      shapeBoundsReduceShader("./src/shaders/cloudShapeBoundsReduce.comp"),
+      coverageBoundsReduceShader("./src/shaders/cloudCoverageBoundsReduce.comp") {
+    glGenTextures(1, &shapeBounds);
+    glGenTextures(1, &coverageBounds);
+    glBindTexture(GL_TEXTURE_3D, shapeBounds);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, coverageBounds);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+int CloudOccupancy::allocate(GLenum target, GLuint texture, int width, int height, int depth) {
+    glBindTexture(target, texture);
+    int levels = 0;
+    while (true) {
+        glTexImage3D(target, levels, GL_R8, width, height, depth, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+        levels++;
+        if (width == 1 && height == 1 && (depth == 1 || target == GL_TEXTURE_2D_ARRAY)) break;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+        if (target == GL_TEXTURE_3D) depth = std::max(depth / 2, 1); //the layers of an array stay
+    }
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    return levels;
+}
+
+void CloudOccupancy::reduce(Shader& reduceShader, GLuint texture, int levels) {
+    reduceShader.use();
+    for (int level=1; level<levels; level++) {
+        //the level below is written by the previous dispatch
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        GLint width, height, depth;
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_WIDTH, &width);
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_HEIGHT, &height);
+        glGetTextureLevelParameteriv(texture, level, GL_TEXTURE_DEPTH, &depth);
+        glBindImageTexture(0, texture, level - 1, GL_TRUE, 0, GL_READ_ONLY, GL_R8);
+        glBindImageTexture(1, texture, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+        dispatchCompute(reduceShader.ID, width, height, depth);
+    }
+}
+
+void CloudOccupancy::bake(GLuint weatherMap, GLuint shapeNoise, float globalCoverage) {
+    //level sizes relative to the base level, the proxies are smaller mip levels made the base level
+    GLint baseLevel, width, height, depth;
+    glGetTextureParameteriv(shapeNoise, GL_TEXTURE_BASE_LEVEL, &baseLevel);
+    glGetTextureLevelParameteriv(shapeNoise, baseLevel, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(shapeNoise, baseLevel, GL_TEXTURE_HEIGHT, &height);
+    glGetTextureLevelParameteriv(shapeNoise, baseLevel, GL_TEXTURE_DEPTH, &depth);
+    int bricksX = (width + SHAPE_BRICK_TEXELS - 1) / SHAPE_BRICK_TEXELS;
+    int bricksY = (height + SHAPE_BRICK_TEXELS - 1) / SHAPE_BRICK_TEXELS;
+    int bricksZ = (depth + SHAPE_BRICK_TEXELS - 1) / SHAPE_BRICK_TEXELS;
+    int shapeLevels = allocate(GL_TEXTURE_3D, shapeBounds, bricksX, bricksY, bricksZ);
+    glBindImageTexture(0, shapeBounds, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_3D, shapeNoise);
+    shapeBoundsShader.use();
+    shapeBoundsShader.setInt("shapeNoise", 0);
+    shapeBoundsShader.setInt("brickTexels", SHAPE_BRICK_TEXELS);
+    dispatchCompute(shapeBoundsShader.ID, bricksX, bricksY, bricksZ);
+
+    glGetTextureParameteriv(weatherMap, GL_TEXTURE_BASE_LEVEL, &baseLevel);
+    glGetTextureLevelParameteriv(weatherMap, baseLevel, GL_TEXTURE_WIDTH, &width);
+    glGetTextureLevelParameteriv(weatherMap, baseLevel, GL_TEXTURE_HEIGHT, &height);
+    int coverageLevels = allocate(GL_TEXTURE_2D_ARRAY, coverageBounds, width, height, COVERAGE_LAYERS);
+    glBindImageTexture(0, coverageBounds, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R8);
+    glBindTexture(GL_TEXTURE_2D, weatherMap);
+    coverageBoundsShader.use();
+    coverageBoundsShader.setInt("weatherMap", 0);
+    coverageBoundsShader.setFloat("globalCoverage", globalCoverage);
+    dispatchCompute(coverageBoundsShader.ID, width, height);
+
+    reduce(shapeBoundsReduceShader, shapeBounds, shapeLevels);
+    reduce(coverageBoundsReduceShader, coverageBounds, coverageLevels);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
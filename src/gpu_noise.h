@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <sstream>
+#include <string>
+
+#include "FastNoiseLite.h"
+
+//GPU side of the noise bakes: FastNoiseLite settings handed to the compute shaders once per program instead of every
+//invocation building its fnl_states with fnlCreateState, and dispatches sized from the image and the workgroup size
+//the shader declares.
+
+//fnl_states of a compute shader, declared where it says
+//    #include NoiseStates
+//and passed to Shader(computePath, noiseStates.declarations()). They become constants of the program rather than a
+//uniform block the shader reads: the compiler then folds the settings and drops the noise types and fractal modes a
+//state does not use, where states in a uniform block keep the code of every one of them live in each invocation
+class NoiseStates {
+public:
+    //declares the settings of noise as the fnl_state name
+    void add(const std::string& name, const FastNoiseLite& noise);
+    //GLSL placed after the states added so far, e.g. a function over them
+    void addFunction(const std::string& function);
+    //GLSL declarations of the states added so far
+    std::string declarations() const;
+
+private:
+    std::ostringstream glsl;
+};
+
+//value as a GLSL float literal, GLSL reads a number without a point or exponent as an int
+std::string glslFloat(float value);
+
+//dispatches the compute program in use over a width x height x depth image with as many workgroups as it takes to
+//cover it, read from the local size the program was compiled with; the shader returns early past the image edge
+void dispatchCompute(unsigned int program, int width, int height, int depth = 1);
+
+void NoiseStates::add(const std::string& name, const FastNoiseLite& noise) {
+    //the GLSL port numbers every enum like FastNoiseLite.h and orders fnl_state like this
+    glsl << "const fnl_state " << name << " = fnl_state(" << noise.mSeed << ", " << glslFloat(noise.mFrequency) << ", "
+        << noise.mPeriod << ", " << (int)noise.mNoiseType << ", " << (int)noise.mRotationType3D << ", "
+        << (int)noise.mFractalType << ", " << noise.mOctaves << ", " << glslFloat(noise.mLacunarity) << ", "
+        << glslFloat(noise.mGain) << ", " << glslFloat(noise.mWeightedStrength) << ", " << glslFloat(noise.mPingPongStrength)
+        << ", " << (int)noise.mCellularDistanceFunction << ", " << (int)noise.mCellularReturnType << ", "
+        << glslFloat(noise.mCellularJitterModifier) << ", " << (int)noise.mDomainWarpType << ", "
+        << glslFloat(noise.mDomainWarpAmp) << ");\n";
+}
+
+void NoiseStates::addFunction(const std::string& function) {
+    glsl << function;
+}
+
+std::string NoiseStates::declarations() const {
+    return glsl.str();
+}
+
+std::string glslFloat(float value) {
+    //9 digits read back as the same float
+    std::ostringstream out;
+    out.precision(9);
+    out << value;
+    std::string text = out.str();
+    if (text.find_first_of(".e") == std::string::npos) text += ".0";
+    return text;
+}
+
+void dispatchCompute(unsigned int program, int width, int height, int depth) {
+    GLint localSize[3];
+    glGetProgramiv(program, GL_COMPUTE_WORK_GROUP_SIZE, localSize);
+    glDispatchCompute((width + localSize[0] - 1) / localSize[0], (height + localSize[1] - 1) / localSize[1],
+        (depth + localSize[2] - 1) / localSize[2]);
+}
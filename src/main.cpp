@@ -2,12 +2,17 @@
 #include <algorithm>
 #include <format>
 #include <ctime>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "FastNoiseLite.h"
+#include "noise_volume.h"
+#include "gpu_noise.h"
+#include "cloud_maps.h"
+#include "sun_depth_volume.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -25,6 +30,19 @@ float FBTriangleVertices[] = {
 
 const int SCR_WIDTH = 1000;
 const int SCR_HEIGHT = 1000;
+const bool PRINT_BAKE_SCALING = false; //bake the noise volumes with 1 to N threads at startup and print the timings
+const bool USE_VOLUME_CACHE = true; //load the noise volumes from cache/ when their settings did not change since the last bake
+const char* NOISE_RECIPES_PATH = ".\\assets\\cloud_noise.txt"; //generators and channel expressions of the noise volumes
+const int WEATHER_MAP_SIZE = 512;
+const int WEATHER_PROXY_LEVEL = 2; //the weather map shows a 1/4 size proxy from this mip level until the full map is done
+const int WEATHER_ROWS_PER_FRAME = 64; //rows of the full weather map generated each frame
+const bool GPU_SHAPE_NOISE = false; //bake shape_noise with cloudNoise3DGen.comp from the recipe's generators instead of on the CPU
+const float CLOUD_COVERAGE = 0.8; //gc of cloudsFrag3.frag, scales the weather map coverage
+const bool SKIP_EMPTY_SPACE = true; //the cloud raymarcher steps through cells the occupancy maps find empty without sampling them
+const bool PRECOMPUTED_SUN_LIGHT = true; //light the clouds from the sun depth volume around the camera instead of marching to the sun
+const float DETAIL_EDGE_SHAPE = 0.6; //the detail noise erodes samples with a shape value up to this, the cores take its mean
+const float DETAIL_NOISE_DISTANCE = 4000.0; //units from the camera past which the detail noise takes its mean
+const float LOD_SCALE = 1.0; //scales the width a sample stands for when picking the mip level of the detail noise, 0 keeps the base level
 
 typedef struct {
     unsigned char r, g, b, a;
@@ -100,6 +118,46 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     
 }
 
+//the recipe called name, exits when there is none
+const NoiseVolumeBuilder &findNoiseRecipe(const std::vector<NoiseVolumeBuilder> &recipes, const char *name) {
+    auto recipe = std::find_if(recipes.begin(), recipes.end(), [&](const NoiseVolumeBuilder &r) { return r.name() == name; });
+    if (recipe == recipes.end()) {
+        std::cout << "No noise recipe called " << name << " in " << NOISE_RECIPES_PATH << std::endl;
+        exit(-1);
+    }
+    return *recipe;
+}
+
+//bakes the recipe called name (or loads it from the volume cache) into a new repeating 3D texture, exits when the recipe is missing or broken.
+//A recipe with a proxy only bakes that and adds the bake of the full volume to backgroundBakes
+unsigned int createNoiseVolumeTexture(ThreadPool &pool, const std::vector<NoiseVolumeBuilder> &recipes, const char *name,
+    std::vector<std::unique_ptr<VolumeBake>> &backgroundBakes) {
+    NoiseVolume volume;
+    if (!findNoiseRecipe(recipes, name).build(volume)) exit(-1);
+
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    std::unique_ptr<VolumeBake> bake = volume.uploadProgressive(pool, USE_VOLUME_CACHE);
+    if (bake) backgroundBakes.push_back(std::move(bake));
+    if (PRINT_BAKE_SCALING) volume.printScaling();
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture;
+}
+
+//fills rows [firstRow, firstRow + rows) of mip level level of a weather map texture, level n samples the noise every 2^n texels
+void dispatchWeatherMap(Shader &shader, unsigned int texture, int level, int firstRow, int rows) {
+    glBindImageTexture(0, texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+    shader.use();
+    shader.setInt("texelStep", 1 << level);
+    shader.setInt("firstRow", firstRow);
+    dispatchCompute(shader.ID, WEATHER_MAP_SIZE >> level, rows);
+}
+
 float weatherMapSigmoid(float x) {
     return 1.0 / (1 + exp(-8.0 * (x - 0.5)));
 }
@@ -214,12 +272,16 @@ int main() {
     worley.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
     worley.SetCellularReturnType(FastNoiseLite::CellularReturnType_Distance);
     glm::vec4 *weatherMapData = (glm::vec4*) malloc(512 * 512 * sizeof(glm::vec4));
+    std::vector<float> perlinMap(512 * 512), worleyMap(512 * 512), worleyModMap(512 * 512);
+    perlin.GenUniformGrid2D(0.0f, 0.0f, 1.0f, 512, 512, perlinMap.data());
+    worley.GenUniformGrid2D(0.0f, 0.0f, 1.0f, 512, 512, worleyMap.data());
+    worleyMod.GenUniformGrid2D(0.0f, 0.0f, 1.0f, 512, 512, worleyModMap.data());
     int index = 0;
     for (int y=0; y<512; y++) {
         for (int x=0; x<512; x++) {
             weatherMapData[index] = {
-                5.0 * (1.0 - (worley.GetNoise((float)x, (float)y) * 0.5 + 0.5)) - 4.0,
-                perlin.GetNoise((float)x, (float)y) * 0.5 + 0.5 - (worleyMod.GetNoise((float)x, (float)y) * 0.5 + 0.5) * 0.4,
+                5.0 * (1.0 - (worleyMap[index] * 0.5 + 0.5)) - 4.0,
+                perlinMap[index] * 0.5 + 0.5 - (worleyModMap[index] * 0.5 + 0.5) * 0.4,
                 1.0,
                 0.5
             };
@@ -238,119 +300,18 @@ int main() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     free(weatherMapData);*/
 
-    FastNoiseLite perlin_r, worley_r, worley_g, worley_b, worley_a;
-    perlin_r.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
-    perlin_r.SetFrequency(0.060);
-    perlin_r.SetFractalType(FastNoiseLite::FractalType_FBm);
-    perlin_r.SetFractalOctaves(5);
-    perlin_r.SetFractalGain(0.29);
-    perlin_r.SetFractalWeightedStrength(-1.73);
-    worley_r.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    worley_r.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_EuclideanSq);
-    worley_r.SetFrequency(0.04);
-    worley_g.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    worley_g.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-    worley_g.SetFractalType(FastNoiseLite::FractalType_FBm);
-    worley_g.SetFractalGain(0.22);
-    worley_g.SetFractalWeightedStrength(-1.2);
-    worley_g.SetFrequency(0.07);
-    worley_g.SetFractalOctaves(3);
-    worley_b.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    worley_b.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-    worley_b.SetFractalType(FastNoiseLite::FractalType_FBm);
-    worley_b.SetFractalGain(0.26);
-    worley_b.SetFractalWeightedStrength(-1.2);
-    worley_b.SetFrequency(0.10);
-    worley_b.SetFractalOctaves(3);
-    worley_a.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    worley_a.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-    worley_a.SetFractalType(FastNoiseLite::FractalType_FBm);
-    worley_a.SetFractalGain(0.28);
-    worley_a.SetFractalWeightedStrength(-1.2);
-    worley_a.SetFrequency(0.14);
-    worley_a.SetFractalOctaves(3);
-    glm::vec4 *perlinNoiseData = (glm::vec4*)malloc(128 * 128 * 128 * sizeof(glm::vec4));
-    int index = 0;
-    for (int z=0; z<128; z++) {
-        for (int y=0; y<128; y++) {
-            for (int x=0; x<128; x++) {
-                perlinNoiseData[index] = {
-                    (perlin_r.GetNoise((float)x, (float)y, (float)z) * 0.5f + 0.5f) * (1.0f - (worley_r.GetNoise((float)x, (float)y, (float)z) + 1.0f)),
-                    1.0f - (worley_g.GetNoise((float)x, (float)y, (float)z) + 1.0f),
-                    1.0f - (worley_b.GetNoise((float)x, (float)y, (float)z) + 1.0f),
-                    1.0f - (worley_a.GetNoise((float)x, (float)y, (float)z) + 1.0f)
-                };
-                index++;
-            }
-        }
-    }
-
-    unsigned int shapeNoiseTex;
-    glGenTextures(1, &shapeNoiseTex);
-    glBindTexture(GL_TEXTURE_3D, shapeNoiseTex);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, 128, 128, 128, 0, GL_RGBA, GL_FLOAT, perlinNoiseData);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    free(perlinNoiseData);
-
-    FastNoiseLite detailWorleyR, detailWorleyG, detailWorleyB;
-    int detailNoiseSize = 32;
-    detailWorleyR.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    detailWorleyR.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_EuclideanSq);
-    detailWorleyR.SetFrequency(0.0085 * 16);
-    detailWorleyR.SetFractalType(FastNoiseLite::FractalType_FBm);
-    detailWorleyR.SetFractalOctaves(3);
-    detailWorleyR.SetFractalGain(0.33);
-    detailWorleyR.SetFractalWeightedStrength(0.0);
-    detailWorleyG.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    detailWorleyG.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-    detailWorleyG.SetFrequency(0.012 * 16);
-    detailWorleyG.SetFractalType(FastNoiseLite::FractalType_FBm);
-    detailWorleyG.SetFractalOctaves(5);
-    detailWorleyG.SetFractalGain(0.45);
-    detailWorleyG.SetFractalWeightedStrength(-0.55);
-    detailWorleyB.SetNoiseType(FastNoiseLite::NoiseType_Cellular);
-    detailWorleyB.SetCellularDistanceFunction(FastNoiseLite::CellularDistanceFunction_Euclidean);
-    detailWorleyB.SetFrequency(0.032 * 16);
-    detailWorleyB.SetFractalType(FastNoiseLite::FractalType_FBm);
-    detailWorleyB.SetFractalOctaves(3);
-    detailWorleyB.SetFractalGain(0.39);
-    detailWorleyB.SetFractalWeightedStrength(-0.7);
-    glm::vec4 *detailNoiseData = (glm::vec4*) malloc(detailNoiseSize * detailNoiseSize * detailNoiseSize * sizeof(glm::vec4));
-    index = 0;
-    for (int z=0; z<detailNoiseSize; z++) {
-        for (int x=0; x<detailNoiseSize; x++) {
-            for (int y=0; y<detailNoiseSize; y++) {
-                detailNoiseData[index] = {
-                    1.0 - (detailWorleyR.GetNoise((float)x, (float)y, (float)z) + 1.0),
-                    1.0 - (detailWorleyG.GetNoise((float)x, (float)y, (float)z) + 1.0),
-                    1.0 - (detailWorleyB.GetNoise((float)x, (float)y, (float)z) + 1.0),
-                    0.0
-                };
-                index++;
-            }
-        }
-    }
-
-    unsigned int detailNoiseTex;
-    glGenTextures(1, &detailNoiseTex);
-    glBindTexture(GL_TEXTURE_3D, detailNoiseTex);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA, detailNoiseSize, detailNoiseSize, detailNoiseSize, 0, GL_RGBA, GL_FLOAT, detailNoiseData);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    free(detailNoiseData);
+    //NOISE VOLUMES
+    ThreadPool bakePool;
+    std::vector<NoiseVolumeBuilder> noiseRecipes;
+    if (!loadNoiseRecipes(NOISE_RECIPES_PATH, noiseRecipes)) exit(-1);
+    std::vector<std::unique_ptr<VolumeBake>> noiseVolumeBakes;
+    unsigned int shapeNoiseTex = GPU_SHAPE_NOISE ? 0 : createNoiseVolumeTexture(bakePool, noiseRecipes, "shape_noise", noiseVolumeBakes);
+    unsigned int detailNoiseTex = createNoiseVolumeTexture(bakePool, noiseRecipes, "detail_noise", noiseVolumeBakes);
 
     //DISPATCH COMPUTE SHADERS TO GENERATE NOISE
-    Shader weatherMapComputeShader = Shader(".\\src\\shaders\\cloudNoise2DGen.comp");
-    Shader shapeNoiseComputeShader = Shader(".\\src\\shaders\\cloudNoise3DGen.comp");
+    Shader weatherMapComputeShader = Shader(".\\src\\shaders\\cloudNoise2DGen.comp", weatherMapNoiseStates().declarations());
 
-    int tex_w = 512, tex_h = 512;
+    int tex_w = WEATHER_MAP_SIZE, tex_h = WEATHER_MAP_SIZE;
     GLuint weatherMapShaderTex0, weatherMapShaderTex1;
     glGenTextures(1, &weatherMapShaderTex1);
     glActiveTexture(GL_TEXTURE0);
@@ -370,10 +331,13 @@ int main() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, tex_w, tex_h, 0, GL_RGBA, GL_FLOAT, NULL);
 
-    glBindImageTexture(0, weatherMapShaderTex0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-    weatherMapComputeShader.use();
-    glDispatchCompute(tex_w, tex_h, 1);
-    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    //the proxy goes into a smaller mip level that stays the base level until the main loop generated the full map.
+    //Image stores below the base level are invalid, so the full map goes to weatherMapShaderTex1 and is copied over at the end
+    glTexImage2D(GL_TEXTURE_2D, WEATHER_PROXY_LEVEL, GL_RGBA32F, tex_w >> WEATHER_PROXY_LEVEL, tex_h >> WEATHER_PROXY_LEVEL, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, WEATHER_PROXY_LEVEL);
+    dispatchWeatherMap(weatherMapComputeShader, weatherMapShaderTex0, WEATHER_PROXY_LEVEL, 0, tex_h >> WEATHER_PROXY_LEVEL);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    int weatherMapRows = 0; //rows of the full map generated so far
 
     GLuint weatherMapFBOs[2];
     glGenFramebuffers(2, weatherMapFBOs);
@@ -404,30 +368,40 @@ int main() {
     glBindTexture(GL_TEXTURE_2D, weatherMapShaderTex0);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    int tex_d = 128;
-    tex_w = 128;
-    tex_h = 128;
-    GLuint shapeNoiseShaderTex;
-    glGenTextures(1, &shapeNoiseShaderTex);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_3D, shapeNoiseShaderTex);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA32F, tex_w, tex_h, tex_d, 0, GL_RGBA, GL_FLOAT, NULL);
-    glBindImageTexture(0, shapeNoiseShaderTex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-
-    //shapeNoiseComputeShader.use();
-    //glDispatchCompute(tex_w, tex_h, tex_d);
-    //glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-    glBindTexture(GL_TEXTURE_3D, shapeNoiseTex); //TODO TODO REPLACE WITH SHADER VERSION WHEN FIXING SHADER
+    if (GPU_SHAPE_NOISE) {
+        //cloudNoise3DGen.comp evaluates the channel expressions of the recipe, written into it as GLSL
+        const NoiseVolumeBuilder &shapeRecipe = findNoiseRecipe(noiseRecipes, "shape_noise");
+        NoiseStates shapeNoiseStates;
+        if (!shapeRecipe.glslChannels("recipeChannels", shapeNoiseStates)) exit(-1);
+        tex_w = shapeRecipe.width();
+        tex_h = shapeRecipe.height();
+        int tex_d = shapeRecipe.depth();
+        glGenTextures(1, &shapeNoiseTex);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_3D, shapeNoiseTex);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA8, tex_w, tex_h, tex_d, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        //layered, otherwise only slice 0 is bound to the image3D
+        glBindImageTexture(0, shapeNoiseTex, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        Shader shapeNoiseComputeShader = Shader(".\\src\\shaders\\cloudNoise3DGen.comp", shapeNoiseStates.declarations());
+        shapeNoiseComputeShader.use();
+        dispatchCompute(shapeNoiseComputeShader.ID, tex_w, tex_h, tex_d);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+        glDeleteProgram(shapeNoiseComputeShader.ID);
+    }
+    glBindTexture(GL_TEXTURE_3D, shapeNoiseTex);
     glGenerateMipmap(GL_TEXTURE_3D);
 
 
     glBindTexture(GL_TEXTURE_3D, detailNoiseTex);
     glGenerateMipmap(GL_TEXTURE_3D);
+    //cloudsFrag3.frag picks the detail noise's mip level by the width a sample stands for, and takes its mean from the
+    //coarsest level, textureLod only reads other levels than the base level with a mipmapped min filter
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
     //LOAD ASSETS
     int txHeight, txWidth, nrChannels;
@@ -444,12 +418,27 @@ int main() {
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, txWidth, txHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, txData);
     stbi_image_free(txData);
 
+    //OCCUPANCY MAPS, baked again below whenever the full weather map or a full noise volume replaces its proxy
+    CloudOccupancy cloudOccupancy;
+    cloudOccupancy.bake(weatherMapShaderTex0, shapeNoiseTex, CLOUD_COVERAGE);
+
     //PREP
     cloudShader.use();
     cloudShader.setInt("weatherMap", 0);
     cloudShader.setInt("shapeNoise", 1);
     cloudShader.setInt("detailNoise", 2);
     cloudShader.setInt("blueNoise", 3);
+    cloudShader.setInt("shapeBounds", 4);
+    cloudShader.setInt("coverageBounds", 5);
+    cloudShader.setInt("sunOpticalDepth", 6);
+    cloudShader.setFloat("globalCoverage", CLOUD_COVERAGE);
+    cloudShader.setBool("skipEmptySpace", SKIP_EMPTY_SPACE);
+    cloudShader.setInt("shapeBrickTexels", SHAPE_BRICK_TEXELS);
+    cloudShader.setBool("precomputedSunLight", PRECOMPUTED_SUN_LIGHT);
+    cloudShader.setFloat("sunDepthTexelSize", SUN_DEPTH_TEXEL_SIZE);
+    cloudShader.setFloat("detailEdgeShape", DETAIL_EDGE_SHAPE);
+    cloudShader.setFloat("detailNoiseDistance", DETAIL_NOISE_DISTANCE);
+    cloudShader.setFloat("lodScale", LOD_SCALE);
     cloudShader.setVec2("resolution", glm::vec2((float)SCR_WIDTH, (float)SCR_HEIGHT));
     cloudShader.setFloat("invAspectRatio", ((float)SCR_HEIGHT / (float)SCR_WIDTH));
     cloudReprojShader.use();
@@ -459,6 +448,10 @@ int main() {
     float detailScale = 134.74; //29.2; //1502.29;
     float hg = 0.8;
 
+    //SUN DEPTH VOLUME, baked again with the occupancy maps and moved with the camera every frame
+    SunDepthVolume sunDepths;
+    sunDepths.bake(weatherMapShaderTex0, shapeNoiseTex, detailNoiseTex, CLOUD_COVERAGE, detailScale, DETAIL_EDGE_SHAPE);
+
     //MAIN LOOP
     glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
     float prevTime = 0.0;
@@ -466,11 +459,33 @@ int main() {
     float deltaTime;
     int cloudFrame = 0; //0 - 15, for motion re-projection
     short whichCloudReprojFBO = 0;
+    bool firstFrame = true;
     while (!glfwWindowShouldClose(window)) {
         currentTime = glfwGetTime();
         deltaTime = currentTime - prevTime;
         prevTime = currentTime;
 
+        //full resolution noise replaces the proxies as it gets done, one volume bake at a time since they share bakePool
+        if (!noiseVolumeBakes.empty() && noiseVolumeBakes.front()->update(bakePool)) {
+            noiseVolumeBakes.erase(noiseVolumeBakes.begin());
+            cloudOccupancy.bake(weatherMapShaderTex0, shapeNoiseTex, CLOUD_COVERAGE);
+            sunDepths.bake(weatherMapShaderTex0, shapeNoiseTex, detailNoiseTex, CLOUD_COVERAGE, detailScale, DETAIL_EDGE_SHAPE);
+        }
+        if (weatherMapRows < WEATHER_MAP_SIZE) {
+            int rows = std::min(WEATHER_ROWS_PER_FRAME, WEATHER_MAP_SIZE - weatherMapRows);
+            dispatchWeatherMap(weatherMapComputeShader, weatherMapShaderTex1, 0, weatherMapRows, rows);
+            weatherMapRows += rows;
+            if (weatherMapRows == WEATHER_MAP_SIZE) {
+                glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                glCopyImageSubData(weatherMapShaderTex1, GL_TEXTURE_2D, 0, 0, 0, 0, weatherMapShaderTex0, GL_TEXTURE_2D, 0, 0, 0, 0,
+                    WEATHER_MAP_SIZE, WEATHER_MAP_SIZE, 1);
+                glTextureParameteri(weatherMapShaderTex0, GL_TEXTURE_BASE_LEVEL, 0);
+                glGenerateTextureMipmap(weatherMapShaderTex0);
+                cloudOccupancy.bake(weatherMapShaderTex0, shapeNoiseTex, CLOUD_COVERAGE);
+                sunDepths.bake(weatherMapShaderTex0, shapeNoiseTex, detailNoiseTex, CLOUD_COVERAGE, detailScale, DETAIL_EDGE_SHAPE);
+            }
+        }
+
         cam.forward = glm::normalize(glm::vec3(
             sin(glm::radians(cam.angle.x)) * cos(glm::radians(cam.angle.y)),
             sin(glm::radians(cam.angle.y)),
@@ -520,6 +535,7 @@ int main() {
         hg = std::max(-1.0f, std::min(1.0f, hg));
 
         updateCameraBuffer(camUBO, cam);
+        if (PRECOMPUTED_SUN_LIGHT) sunDepths.follow(cam.pos);
 
         glViewport(0, 0, SCR_WIDTH/4, SCR_HEIGHT/4);
         glBindFramebuffer(GL_FRAMEBUFFER, cloudFBO);
@@ -533,11 +549,21 @@ int main() {
         glBindTexture(GL_TEXTURE_3D, detailNoiseTex);
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, blueNoiseTexture);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_3D, cloudOccupancy.shapeBounds);
+        glActiveTexture(GL_TEXTURE5);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, cloudOccupancy.coverageBounds);
+        glActiveTexture(GL_TEXTURE6);
+        glBindTexture(GL_TEXTURE_3D, sunDepths.opticalDepth);
         cloudShader.use();
         cloudShader.setInt("weatherMap", 0);
         cloudShader.setInt("shapeNoise", 1);
         cloudShader.setInt("detailNoise", 2);
         cloudShader.setInt("blueNoise", 3);
+        cloudShader.setInt("shapeBounds", 4);
+        cloudShader.setInt("coverageBounds", 5);
+        cloudShader.setInt("sunOpticalDepth", 6);
+        glUniform4fv(glGetUniformLocation(cloudShader.ID, "sunDepthBounds"), 1, glm::value_ptr(sunDepths.bounds()));
         cloudShader.setFloat("b", testSampleHeight);
         cloudShader.setFloat("exposure", exposure);
         cloudShader.setFloat("detailScale", detailScale);
@@ -572,6 +598,8 @@ int main() {
         glDrawArrays(GL_TRIANGLES, 0, 3);
 
         glfwSwapBuffers(window);
+        if (firstFrame) std::cout << "First frame after " << glfwGetTime() * 1000.0 << " ms\n";
+        firstFrame = false;
         cam.motion = glm::vec2();
         glfwPollEvents();
         
@@ -584,6 +612,7 @@ int main() {
     std::cout << "exposure = " << exposure << std::endl;
     std::cout << "detail scale = " << detailScale << std::endl;
     std::cout << "hg = " << hg << std::endl;
+    noiseVolumeBakes.clear(); //stops a bake still running while its GL objects can be deleted
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "thread_pool.h"
+
+//Splits a volume into bricks (a run of rows inside one z slice) and fills them on a ThreadPool.
+//Every texel is written by exactly one brick and only depends on its own coordinates,
+//so the result is bit-identical no matter how many threads run or which thread takes which brick.
+
+struct VolumeBrick {
+    int x, y, z;
+    int width, height, depth;
+};
+
+const int BAKE_BRICK_ROWS = 16;
+
+//calls fillBrick(const VolumeBrick&) for every brick of the z slices [zFirst, zFirst + zCount) of a width x height volume
+template <typename FillFn>
+void bakeSlab(ThreadPool& pool, int width, int height, int zFirst, int zCount, FillFn& fillBrick) {
+    int bricksPerSlice = (height + BAKE_BRICK_ROWS - 1) / BAKE_BRICK_ROWS;
+    pool.parallelFor(bricksPerSlice * zCount, [&](int brickIndex) {
+        VolumeBrick brick;
+        brick.x = 0;
+        brick.y = (brickIndex % bricksPerSlice) * BAKE_BRICK_ROWS;
+        brick.z = zFirst + brickIndex / bricksPerSlice;
+        brick.width = width;
+        brick.height = std::min(BAKE_BRICK_ROWS, height - brick.y);
+        brick.depth = 1;
+        fillBrick(brick);
+    });
+}
+
+//calls fillBrick(const VolumeBrick&) for every brick of a width x height x depth volume, returns the bake time in ms
+template <typename FillFn>
+double bakeVolume(ThreadPool& pool, int width, int height, int depth, FillFn& fillBrick) {
+    auto start = std::chrono::steady_clock::now();
+    bakeSlab(pool, width, height, 0, depth, fillBrick);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void printBakeTime(const char* name, int width, int height, int depth, double ms, int threads) {
+    std::cout << "Baked " << name << " (" << width << "x" << height << "x" << depth << ") in "
+        << ms << " ms on " << threads << (threads == 1 ? " thread" : " threads") << "\n";
+}
+
+//bakes the same volume with 1 to N threads and prints the time and speedup of each run
+template <typename FillFn>
+void printBakeScaling(const char* name, int width, int height, int depth, FillFn& fillBrick) {
+    int maxThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    double singleThreadMs = 0.0;
+    std::cout << "Bake scaling for " << name << ":\n";
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        ThreadPool pool(threads);
+        double ms = bakeVolume(pool, width, height, depth, fillBrick);
+        if (threads == 1) singleThreadMs = ms;
+        std::cout << "    " << threads << (threads == 1 ? " thread:  " : " threads: ") << ms << " ms, "
+            << singleThreadMs / ms << "x\n";
+    }
+}
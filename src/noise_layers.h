@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <glm/gtc/packing.hpp>
+
+#include "FastNoiseLite.h"
+
+//Evaluates several FastNoiseLite configs ("layers") over the same regular grid and writes them interleaved,
+//e.g. straight into an RGBA upload buffer, so the bake needs no per channel buffers or combine pass.
+//Each layer runs on its fastest path: lattice noise walks the whole block with GenUniformGrid3D, while noise with
+//a SIMD kernel (cellular) runs row by row through GetNoiseBatch on sample rows built once and shared by all those layers.
+//Layers share those rows and one blend and store pass per row, not work inside the noise: each layer still runs its
+//own coordinate transform, rounding and neighbourhood walk, the per-seed hashes, jitter lookups and distances dominate
+//a walk even where octaves of two layers land on the same cells. Layer values are identical to the layer's own GetNoise.
+//Texels can be written as floats, half floats or 8 bit unorm, so the bake fills a buffer already in the upload
+//format: each channel is remapped from its range to [0, 1] and quantized row by row while the volume is generated.
+
+enum LayerBlend {LAYER_REPLACE, LAYER_MULTIPLY};
+//per channel storage of a texel: TEXEL_UNORM8 with 4 channels uploads as GL_RGBA8, with 1 channel as GL_R8,
+//TEXEL_HALF with 4 channels as GL_RGBA16F (type GL_HALF_FLOAT)
+enum TexelFormat {TEXEL_FLOAT, TEXEL_HALF, TEXEL_UNORM8};
+
+//values of a channel in [min, max] are stored as [0, 1]
+struct ChannelRange {
+    float min, max;
+};
+
+//value range of one channel before remapping, clipped counts the texels an 8 bit format had to clamp to [0, 1]
+struct ChannelStats {
+    float min = INFINITY;
+    float max = -INFINITY;
+    long long clipped = 0;
+
+    void merge(const ChannelStats& other);
+};
+
+int texelBytes(TexelFormat format, int channels);
+//round to nearest, the same conversion GL does when it stores floats in a unorm texture
+unsigned char quantizeUnorm8(float value);
+void printChannelStats(const char* name, const ChannelStats* stats, int channels);
+//remaps a row of xSize interleaved float texels in place from each channel's range to [0, 1], merges their values
+//into stats (one per channel) and writes them to out in format
+void storeTexelRow(float* texels, int xSize, int channels, const ChannelRange* ranges, TexelFormat format, unsigned char* out, ChannelStats* stats);
+
+class NoiseLayers {
+public:
+    NoiseLayers(int channels);
+    //channel receives noise * scale + bias, replacing or multiplying what earlier layers wrote to it
+    void addLayer(const FastNoiseLite& noise, int channel, float scale = 1.0f, float bias = 0.0f, LayerBlend blend = LAYER_REPLACE);
+    int channelCount() const;
+    //channel values in [min, max] are stored as [0, 1], the default range [0, 1] stores them unchanged
+    void setChannelRange(int channel, float min, float max);
+    //texel axes x, y and z sample noise axes xAxis, yAxis and zAxis (0 = x, 1 = y, 2 = z), e.g. 1, 0, 2 runs rows along noise y.
+    //Swapped axes always take the row path
+    void setAxes(int xAxis, int yAxis, int zAxis);
+    //out[((z * ySize + y) * xSize + x) * channels + channel] for the samples (xOrigin + x * step, yOrigin + y * step, zOrigin + z * step),
+    //origins and sizes are along the texel axes
+    void genUniformGrid3D(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize, float* out) const;
+    //the same texels stored in format, stats (one per channel, may be null) are merged with the block's channel ranges
+    void genUniformGrid3D(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize,
+        TexelFormat format, void* out, ChannelStats* stats = nullptr) const;
+
+private:
+    friend class VolumeCacheKey;
+
+    struct Layer {
+        FastNoiseLite noise;
+        int channel;
+        float scale, bias;
+        LayerBlend blend;
+    };
+
+    int channels;
+    std::vector<Layer> layers;
+    std::vector<ChannelRange> ranges;
+    int axes[3] = {0, 1, 2};
+
+    bool usesGrid(const FastNoiseLite& noise) const;
+};
+
+void ChannelStats::merge(const ChannelStats& other) {
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    clipped += other.clipped;
+}
+
+int texelBytes(TexelFormat format, int channels) {
+    switch (format) {
+    case TEXEL_HALF:
+        return channels * 2;
+    case TEXEL_UNORM8:
+        return channels;
+    default:
+        return channels * 4;
+    }
+}
+
+unsigned char quantizeUnorm8(float value) {
+    return (unsigned char)(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void printChannelStats(const char* name, const ChannelStats* stats, int channels) {
+    for (int c=0; c<channels; c++) {
+        std::cout << "    " << name << " channel " << c << ": [" << stats[c].min << ", " << stats[c].max << "]";
+        if (stats[c].clipped > 0) std::cout << ", " << stats[c].clipped << " texels clipped";
+        std::cout << "\n";
+    }
+}
+
+void storeTexelRow(float* texels, int xSize, int channels, const ChannelRange* ranges, TexelFormat format, unsigned char* out, ChannelStats* stats) {
+    for (int c=0; c<channels; c++) {
+        float rangeMin = ranges[c].min;
+        float invRange = 1.0f / (ranges[c].max - ranges[c].min);
+        ChannelStats& channelStats = stats[c];
+        for (int x=0; x<xSize; x++) {
+            float& v = texels[x * channels + c];
+            channelStats.min = std::min(channelStats.min, v);
+            channelStats.max = std::max(channelStats.max, v);
+            v = (v - rangeMin) * invRange;
+            if (format == TEXEL_UNORM8 && (v < 0.0f || v > 1.0f)) channelStats.clipped++;
+        }
+    }
+
+    int values = xSize * channels;
+    switch (format) {
+    case TEXEL_FLOAT:
+        std::copy(texels, texels + values, (float*)out);
+        break;
+    case TEXEL_HALF:
+        for (int i=0; i<values; i++) {
+            uint16_t half = glm::packHalf1x16(texels[i]);
+            memcpy(out + i * 2, &half, 2);
+        }
+        break;
+    case TEXEL_UNORM8:
+        for (int i=0; i<values; i++) out[i] = quantizeUnorm8(texels[i]);
+        break;
+    }
+}
+
+NoiseLayers::NoiseLayers(int channels) : channels(channels), ranges(channels, {0.0f, 1.0f}) {}
+
+void NoiseLayers::addLayer(const FastNoiseLite& noise, int channel, float scale, float bias, LayerBlend blend) {
+    assert(channel >= 0 && channel < channels);
+    layers.push_back({noise, channel, scale, bias, blend});
+}
+
+int NoiseLayers::channelCount() const {
+    return channels;
+}
+
+void NoiseLayers::setChannelRange(int channel, float min, float max) {
+    assert(channel >= 0 && channel < channels && max > min);
+    ranges[channel] = {min, max};
+}
+
+void NoiseLayers::setAxes(int xAxis, int yAxis, int zAxis) {
+    assert(xAxis != yAxis && xAxis != zAxis && yAxis != zAxis && std::min({xAxis, yAxis, zAxis}) >= 0 && std::max({xAxis, yAxis, zAxis}) <= 2);
+    axes[0] = xAxis;
+    axes[1] = yAxis;
+    axes[2] = zAxis;
+}
+
+//the grid walk wins for lattice noise, cellular only gains from it when there is no SIMD kernel to run instead
+bool NoiseLayers::usesGrid(const FastNoiseLite& noise) const {
+    if (!noise.GridSupported() || noise.mTransformType3D != FastNoiseLite::TransformType3D_None) return false;
+    if (axes[0] != 0 || axes[1] != 1) return false;
+    return !noise.GridUsesBatchRows(true);
+}
+
+void NoiseLayers::genUniformGrid3D(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize, float* out) const {
+    genUniformGrid3D(xOrigin, yOrigin, zOrigin, step, xSize, ySize, zSize, TEXEL_FLOAT, out);
+}
+
+void NoiseLayers::genUniformGrid3D(float xOrigin, float yOrigin, float zOrigin, float step, int xSize, int ySize, int zSize,
+    TexelFormat format, void* out, ChannelStats* stats) const {
+    if (xSize <= 0 || ySize <= 0 || zSize <= 0) return;
+    int count = xSize * ySize * zSize;
+
+    //grid layers fill a whole plane up front, batch layers get one row buffer each, slot indexes either
+    std::vector<bool> grid(layers.size());
+    std::vector<int> slot(layers.size());
+    int gridLayers = 0, rowLayers = 0;
+    for (int l=0; l<(int)layers.size(); l++) {
+        grid[l] = usesGrid(layers[l].noise);
+        slot[l] = grid[l] ? gridLayers++ : rowLayers++;
+    }
+
+    std::vector<float> planes((size_t)gridLayers * count);
+    for (int l=0; l<(int)layers.size(); l++) {
+        if (grid[l]) layers[l].noise.GenUniformGrid3D(xOrigin, yOrigin, zOrigin, step, xSize, ySize, zSize, &planes[(size_t)slot[l] * count]);
+    }
+
+    //channels blend into one float row, which is then remapped and stored in the output format.
+    //Row samples along texel x vary along noise axis axes[0], texel y and z pick the other two
+    std::vector<float> coords[3] = {std::vector<float>(xSize), std::vector<float>(xSize), std::vector<float>(xSize)};
+    std::vector<float> rows((size_t)rowLayers * xSize), texels((size_t)xSize * channels);
+    std::vector<ChannelStats> blockStats(channels);
+    for (int x=0; x<xSize; x++) coords[axes[0]][x] = xOrigin + x * step;
+    for (int z=0; z<zSize; z++) {
+        for (int y=0; y<ySize; y++) {
+            int rowStart = (z * ySize + y) * xSize;
+            if (rowLayers > 0) {
+                std::fill(coords[axes[1]].begin(), coords[axes[1]].end(), yOrigin + y * step);
+                std::fill(coords[axes[2]].begin(), coords[axes[2]].end(), zOrigin + z * step);
+                for (int l=0; l<(int)layers.size(); l++) {
+                    if (!grid[l]) layers[l].noise.GetNoiseBatch(coords[0].data(), coords[1].data(), coords[2].data(), &rows[(size_t)slot[l] * xSize], xSize);
+                }
+            }
+
+            //layers blend in the order they were added, channels no layer writes stay 0
+            std::fill(texels.begin(), texels.end(), 0.0f);
+            for (int l=0; l<(int)layers.size(); l++) {
+                const Layer& layer = layers[l];
+                const float* value = grid[l] ? &planes[(size_t)slot[l] * count + rowStart] : &rows[(size_t)slot[l] * xSize];
+                float* texel = texels.data() + layer.channel;
+                for (int x=0; x<xSize; x++) {
+                    float v = value[x] * layer.scale + layer.bias;
+                    texel[x * channels] = layer.blend == LAYER_MULTIPLY ? texel[x * channels] * v : v;
+                }
+            }
+            storeTexelRow(texels.data(), xSize, channels, ranges.data(), format, (unsigned char*)out + (size_t)rowStart * texelBytes(format, channels), blockStats.data());
+        }
+    }
+
+    if (stats != nullptr) {
+        for (int c=0; c<channels; c++) stats[c].merge(blockStats[c]);
+    }
+}
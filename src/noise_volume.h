@@ -0,0 +1,1040 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FastNoiseLite.h"
+#include "gpu_noise.h"
+#include "noise_bake.h"
+#include "noise_layers.h"
+#include "thread_pool.h"
+#include "volume_cache.h"
+#include "volume_stream.h"
+
+//Noise volumes described as data: named FastNoiseLite generators and one combine expression per texel channel,
+//e.g. "(perlin * 0.5 + 0.5) * -worley", set up in code or read from a recipe file, so a recipe changes without a rebuild.
+//Building a recipe plans its bake: every generator the expressions use runs once per texel on its fastest path
+//(grid walk or SIMD rows, through NoiseLayers), all channels are combined and stored in the upload format in one pass
+//over the same rows, bricks bake on the ThreadPool while finished slabs stream to the GPU, and the volume cache key
+//covers the whole recipe, so any edit bakes again and an unchanged recipe loads from the cache.
+//A recipe with a proxy is shown at a fraction of its size first: the proxy bakes in a few ms into a smaller mip level
+//of the texture, which stays the base level until the full volume baked in the background and filled level 0.
+
+//bump when the evaluation below changes what a recipe bakes
+const int NOISE_VOLUME_VERSION = 1;
+
+//a compiled expression runs over a whole row at a time on a stack of rows, operators pop their operands and push the result
+enum ExpressionOpKind {EXPR_NOISE, EXPR_CONSTANT, EXPR_NEGATE, EXPR_ABS, EXPR_ADD, EXPR_SUBTRACT, EXPR_MULTIPLY, EXPR_DIVIDE,
+    EXPR_MIN, EXPR_MAX, EXPR_CLAMP};
+
+struct ExpressionOp {
+    ExpressionOpKind kind;
+    int noise = 0; //generator slot of EXPR_NOISE
+    float constant = 0.0f; //value of EXPR_CONSTANT
+};
+
+//upload format and type of a volume stored in format with 1 to 4 channels, and the internal format that keeps it as is
+GLenum texelUploadFormat(int channels);
+GLenum texelUploadType(TexelFormat format);
+GLenum texelInternalFormat(TexelFormat format, int channels);
+
+class VolumeBake;
+
+class NoiseVolume {
+public:
+    const std::string& name() const;
+    int channelCount() const;
+    //fills a brick at texels, rows width * texel size apart; stats (one per channel, may be null) are merged with its channel ranges
+    void fillBrick(const VolumeBrick& brick, void* texels, ChannelStats* stats = nullptr) const;
+    VolumeCacheKey cacheKey() const;
+    //allocates and fills the storage of the GL_TEXTURE_3D bound when called: mapped from the volume cache when useCache
+    //finds the recipe there, otherwise baked on pool and uploaded slab by slab (and stored in the cache when useCache).
+    //While another process bakes the same recipe it waits for that one to publish it instead of baking it again
+    void upload(ThreadPool& pool, bool useCache) const;
+    //like upload, but a volume with a proxy that is not in the cache only bakes the proxy, into mip level proxyLevel,
+    //which becomes the base level; the bake of level 0 is returned for the caller to update once a frame
+    std::unique_ptr<VolumeBake> uploadProgressive(ThreadPool& pool, bool useCache) const;
+    //bakes the whole volume with 1 to N threads and prints the timings
+    void printScaling() const;
+
+private:
+    friend class NoiseVolumeBuilder;
+    friend class VolumeBake;
+
+    std::string volumeName;
+    int width = 0, height = 0, depth = 0;
+    TexelFormat format = TEXEL_UNORM8;
+    int proxyLevel = 0; //the proxy is 2^proxyLevel times smaller in every axis, 0 = no proxy
+    int sampleStep = 1; //noise texels per texel, 2^proxyLevel while baking the proxy
+    //one channel per generator the expressions use, in the order they first appear
+    NoiseLayers generators = NoiseLayers(0);
+    std::vector<std::vector<ExpressionOp>> programs;
+    std::vector<ChannelRange> ranges;
+    int stackDepth = 1;
+
+    size_t rowBytes() const;
+    //fills level 0 of texture from the cache, false when the cache does not have the volume
+    bool uploadFromCache(const VolumeCacheKey& key, GLuint texture) const;
+    //allocates level 0 of the GL_TEXTURE_3D bound and returns its name
+    GLuint allocateTexture() const;
+    void uploadProxy(ThreadPool& pool) const;
+};
+
+//Bakes a volume into level 0 of its texture while the renderer runs, see NoiseVolume::uploadProgressive. update()
+//uploads the slabs finished since its last call; after the last one a texture that showed a proxy gets level 0 back
+//as its base level and its mipmaps rebuilt from it, so the full volume replaces the proxy under the same texture name.
+//With the cache on, the bake first takes the volume's VolumeCacheLock: while another process holds it update() only
+//checks the lock again, and once it is free a volume that process published is loaded instead of baked.
+class VolumeBake {
+public:
+    //level 0 of texture has to be allocated already, useCache stores the bake in the volume cache
+    VolumeBake(const NoiseVolume& volume, GLuint texture, bool useCache);
+    //starts the bake on pool when called first, pool stays busy until it returned true; with wait it only returns
+    //once the bake is done, otherwise right after uploading what is ready, which keeps it cheap enough for every frame
+    bool update(ThreadPool& pool, bool wait = false);
+
+private:
+    NoiseVolume volume;
+    GLuint texture;
+    std::vector<ChannelStats> stats;
+    std::mutex statsMutex;
+    std::unique_ptr<VolumeCacheLock> cacheLock;
+    std::unique_ptr<VolumeCacheWriter> cacheWriter;
+    bool waiting = false; //another process holds the lock
+    std::chrono::steady_clock::time_point startTime;
+    //last, so it is destroyed first: its destructor joins the producer thread, which fills from volume into stats and
+    //the cacheWriter until then
+    std::unique_ptr<VolumeStreamer> streamer;
+
+    bool finish();
+};
+
+class NoiseVolumeBuilder {
+public:
+    NoiseVolumeBuilder(const std::string& name, int width, int height, int depth);
+    const std::string& name() const;
+    int width() const;
+    int height() const;
+    int depth() const;
+    //a generator expressions refer to by name, a generator added again under the same name replaces it
+    NoiseVolumeBuilder& noise(const std::string& name, const FastNoiseLite& noise);
+    //the generator called name, null when there is none
+    const FastNoiseLite* findNoise(const std::string& name) const;
+    //channels the volume stores, by default one past the highest channel given an expression
+    NoiseVolumeBuilder& channels(int channels);
+    //channel receives expression over generator names and constants with + - * /, parentheses and the functions
+    //min(a, b), max(a, b), abs(a) and clamp(a, low, high); channels without an expression store 0
+    NoiseVolumeBuilder& channel(int channel, const std::string& expression);
+    //channel values in [min, max] are stored as [0, 1], the default range [0, 1] stores them unchanged
+    NoiseVolumeBuilder& channelRange(int channel, float min, float max);
+    NoiseVolumeBuilder& format(TexelFormat format);
+    //texel axes x, y and z sample noise axes xAxis, yAxis and zAxis, see NoiseLayers::setAxes
+    NoiseVolumeBuilder& axes(int xAxis, int yAxis, int zAxis);
+    //shows the volume at 1 / divisor of its size while the full volume bakes, divisor is a power of two that divides
+    //every side, 1 = no proxy
+    NoiseVolumeBuilder& proxy(int divisor);
+    //compiles the expressions and plans the bake, prints what is wrong with the recipe and returns false if it can not be built
+    bool build(NoiseVolume& volume) const;
+    //the recipe for a compute shader: the generators the expressions use are added to states under their names,
+    //followed by vec4 function(vec3 texel), the values the CPU bake stores at texel before it converts them to the
+    //format (0 past the channel count). Prints what is wrong with the recipe and returns false if it can not be built
+    bool glslChannels(const std::string& function, NoiseStates& states) const;
+
+private:
+    std::string volumeName;
+    int volumeWidth, volumeHeight, volumeDepth;
+    std::vector<std::pair<std::string, FastNoiseLite>> noises;
+    int channelCount = 0;
+    std::vector<std::string> expressions;
+    std::vector<std::pair<int, ChannelRange>> channelRanges;
+    TexelFormat texelFormat = TEXEL_UNORM8;
+    int axisOrder[3] = {0, 1, 2};
+    int proxyDivisor = 1;
+
+    //compiles every channel's expression, slotNoises gets the index into noises of each generator slot
+    bool compileChannels(int channels, std::vector<std::vector<ExpressionOp>>& programs, std::vector<int>& slotNoises,
+        int& stackDepth, std::string& error) const;
+};
+
+//period whole noise cells across size texels, so a volume sampled with GL_REPEAT wraps without a seam
+void setTilingFrequency(FastNoiseLite& noise, int period, int size);
+
+//Reads the noise volume recipes of a text file, see assets/cloud_noise.txt for the format. Prints the line of the
+//first error and returns false when the file is missing or malformed
+bool loadNoiseRecipes(const char* path, std::vector<NoiseVolumeBuilder>& recipes);
+
+GLenum texelUploadFormat(int channels) {
+    const GLenum formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
+    return formats[channels - 1];
+}
+
+GLenum texelUploadType(TexelFormat format) {
+    switch (format) {
+    case TEXEL_HALF:
+        return GL_HALF_FLOAT;
+    case TEXEL_UNORM8:
+        return GL_UNSIGNED_BYTE;
+    default:
+        return GL_FLOAT;
+    }
+}
+
+GLenum texelInternalFormat(TexelFormat format, int channels) {
+    const GLenum unorm8[] = {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8};
+    const GLenum half[] = {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F};
+    const GLenum full[] = {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F};
+    switch (format) {
+    case TEXEL_HALF:
+        return half[channels - 1];
+    case TEXEL_UNORM8:
+        return unorm8[channels - 1];
+    default:
+        return full[channels - 1];
+    }
+}
+
+//the value of one operator, also used to fold operators whose operands are all constants
+float applyExpressionOp(ExpressionOpKind kind, float a, float b, float c) {
+    switch (kind) {
+    case EXPR_NEGATE:
+        return -a;
+    case EXPR_ABS:
+        return std::abs(a);
+    case EXPR_ADD:
+        return a + b;
+    case EXPR_SUBTRACT:
+        return a - b;
+    case EXPR_MULTIPLY:
+        return a * b;
+    case EXPR_DIVIDE:
+        return a / b;
+    case EXPR_MIN:
+        return std::min(a, b);
+    case EXPR_MAX:
+        return std::max(a, b);
+    case EXPR_CLAMP:
+        return std::min(std::max(a, b), c);
+    default:
+        return a;
+    }
+}
+
+int expressionOperands(ExpressionOpKind kind) {
+    switch (kind) {
+    case EXPR_NOISE:
+    case EXPR_CONSTANT:
+        return 0;
+    case EXPR_NEGATE:
+    case EXPR_ABS:
+        return 1;
+    case EXPR_CLAMP:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+//runs program over n samples, noiseRows holds one row of n values per generator slot, the result ends up in stack[0, n)
+void runExpression(const std::vector<ExpressionOp>& program, const float* noiseRows, int n, float* stack) {
+    int top = 0;
+    for (const ExpressionOp& op : program) {
+        int operands = expressionOperands(op.kind);
+        top -= operands;
+        float* a = stack + (size_t)top * n;
+        const float* b = a + n;
+        const float* c = b + n;
+        switch (op.kind) {
+        case EXPR_NOISE:
+            std::copy_n(noiseRows + (size_t)op.noise * n, n, a);
+            break;
+        case EXPR_CONSTANT:
+            std::fill_n(a, n, op.constant);
+            break;
+        case EXPR_NEGATE:
+            for (int i=0; i<n; i++) a[i] = -a[i];
+            break;
+        case EXPR_ABS:
+            for (int i=0; i<n; i++) a[i] = std::abs(a[i]);
+            break;
+        case EXPR_ADD:
+            for (int i=0; i<n; i++) a[i] = a[i] + b[i];
+            break;
+        case EXPR_SUBTRACT:
+            for (int i=0; i<n; i++) a[i] = a[i] - b[i];
+            break;
+        case EXPR_MULTIPLY:
+            for (int i=0; i<n; i++) a[i] = a[i] * b[i];
+            break;
+        case EXPR_DIVIDE:
+            for (int i=0; i<n; i++) a[i] = a[i] / b[i];
+            break;
+        case EXPR_MIN:
+            for (int i=0; i<n; i++) a[i] = std::min(a[i], b[i]);
+            break;
+        case EXPR_MAX:
+            for (int i=0; i<n; i++) a[i] = std::max(a[i], b[i]);
+            break;
+        case EXPR_CLAMP:
+            for (int i=0; i<n; i++) a[i] = std::min(std::max(a[i], b[i]), c[i]);
+            break;
+        }
+        top++;
+    }
+}
+
+//Recursive descent over one channel expression, emitting postfix ops. Generators get a slot the first time any
+//expression of the volume names them, operators on constants only are folded while emitting
+class ExpressionCompiler {
+public:
+    ExpressionCompiler(const std::vector<std::pair<std::string, FastNoiseLite>>& noises, std::vector<int>& slotNoises);
+    //error describes the first problem when it returns false
+    bool compile(const std::string& expression, std::vector<ExpressionOp>& program, int& stackDepth, std::string& error);
+
+private:
+    const std::vector<std::pair<std::string, FastNoiseLite>>& noises;
+    std::vector<int>& slotNoises; //index into noises of every slot
+    std::string text;
+    size_t pos = 0;
+    std::vector<ExpressionOp>* out = nullptr;
+    int depth = 0, maxDepth = 0;
+    std::string problem;
+
+    void skipSpace();
+    bool accept(char c);
+    bool parseSum();
+    bool parseProduct();
+    bool parseUnary();
+    bool parsePrimary();
+    bool parseCall(const std::string& function);
+    void emit(ExpressionOp op);
+    bool fail(const std::string& message);
+};
+
+ExpressionCompiler::ExpressionCompiler(const std::vector<std::pair<std::string, FastNoiseLite>>& noises, std::vector<int>& slotNoises)
+    : noises(noises), slotNoises(slotNoises) {}
+
+bool ExpressionCompiler::compile(const std::string& expression, std::vector<ExpressionOp>& program, int& stackDepth, std::string& error) {
+    text = expression;
+    pos = 0;
+    out = &program;
+    depth = maxDepth = 0;
+    program.clear();
+    bool compiled = parseSum();
+    skipSpace();
+    if (compiled && pos < text.size()) compiled = fail(std::string("unexpected '") + text[pos] + "'");
+    if (!compiled) error = problem;
+    stackDepth = std::max(stackDepth, maxDepth);
+    return compiled;
+}
+
+void ExpressionCompiler::skipSpace() {
+    while (pos < text.size() && isspace((unsigned char)text[pos])) pos++;
+}
+
+bool ExpressionCompiler::accept(char c) {
+    skipSpace();
+    if (pos >= text.size() || text[pos] != c) return false;
+    pos++;
+    return true;
+}
+
+bool ExpressionCompiler::parseSum() {
+    if (!parseProduct()) return false;
+    while (true) {
+        if (accept('+')) {
+            if (!parseProduct()) return false;
+            emit({EXPR_ADD});
+        } else if (accept('-')) {
+            if (!parseProduct()) return false;
+            emit({EXPR_SUBTRACT});
+        } else {
+            return true;
+        }
+    }
+}
+
+bool ExpressionCompiler::parseProduct() {
+    if (!parseUnary()) return false;
+    while (true) {
+        if (accept('*')) {
+            if (!parseUnary()) return false;
+            emit({EXPR_MULTIPLY});
+        } else if (accept('/')) {
+            if (!parseUnary()) return false;
+            emit({EXPR_DIVIDE});
+        } else {
+            return true;
+        }
+    }
+}
+
+bool ExpressionCompiler::parseUnary() {
+    if (accept('-')) {
+        if (!parseUnary()) return false;
+        emit({EXPR_NEGATE});
+        return true;
+    }
+    if (accept('+')) return parseUnary();
+    return parsePrimary();
+}
+
+bool ExpressionCompiler::parsePrimary() {
+    skipSpace();
+    if (pos >= text.size()) return fail("expression ends early");
+    if (accept('(')) {
+        if (!parseSum()) return false;
+        return accept(')') ? true : fail("missing ')'");
+    }
+
+    char c = text[pos];
+    if (isdigit((unsigned char)c) || c == '.') {
+        const char* start = text.c_str() + pos;
+        char* end;
+        float value = strtof(start, &end);
+        if (end == start) return fail("bad number");
+        pos += end - start;
+        ExpressionOp op = {EXPR_CONSTANT};
+        op.constant = value;
+        emit(op);
+        return true;
+    }
+    if (!isalpha((unsigned char)c) && c != '_') return fail(std::string("unexpected '") + c + "'");
+
+    size_t start = pos;
+    while (pos < text.size() && (isalnum((unsigned char)text[pos]) || text[pos] == '_')) pos++;
+    std::string name = text.substr(start, pos - start);
+    if (accept('(')) return parseCall(name);
+
+    int index = -1;
+    for (int i=0; i<(int)noises.size(); i++) {
+        if (noises[i].first == name) index = i;
+    }
+    if (index < 0) return fail("unknown noise '" + name + "'");
+    int slot = (int)(std::find(slotNoises.begin(), slotNoises.end(), index) - slotNoises.begin());
+    if (slot == (int)slotNoises.size()) slotNoises.push_back(index);
+    ExpressionOp op = {EXPR_NOISE};
+    op.noise = slot;
+    emit(op);
+    return true;
+}
+
+//the opening parenthesis is already read
+bool ExpressionCompiler::parseCall(const std::string& function) {
+    ExpressionOpKind kind;
+    if (function == "min") kind = EXPR_MIN;
+    else if (function == "max") kind = EXPR_MAX;
+    else if (function == "abs") kind = EXPR_ABS;
+    else if (function == "clamp") kind = EXPR_CLAMP;
+    else return fail("unknown function '" + function + "'");
+
+    int arguments = expressionOperands(kind);
+    for (int i=0; i<arguments; i++) {
+        if (i > 0 && !accept(',')) return fail(function + " takes " + std::to_string(arguments) + " arguments");
+        if (!parseSum()) return false;
+    }
+    if (!accept(')')) return fail("missing ')' after the arguments of " + function);
+    emit({kind});
+    return true;
+}
+
+void ExpressionCompiler::emit(ExpressionOp op) {
+    std::vector<ExpressionOp>& program = *out;
+    int operands = expressionOperands(op.kind);
+    bool constant = operands > 0 && (int)program.size() >= operands;
+    for (int i=0; constant && i<operands; i++) constant = program[program.size() - 1 - i].kind == EXPR_CONSTANT;
+    if (constant) {
+        float values[3] = {0.0f, 0.0f, 0.0f};
+        for (int i=0; i<operands; i++) values[i] = program[program.size() - operands + i].constant;
+        program.resize(program.size() - operands);
+        depth -= operands;
+        ExpressionOp folded = {EXPR_CONSTANT};
+        folded.constant = applyExpressionOp(op.kind, values[0], values[1], values[2]);
+        op = folded;
+        operands = 0;
+    }
+    program.push_back(op);
+    depth += 1 - operands;
+    maxDepth = std::max(maxDepth, depth);
+}
+
+bool ExpressionCompiler::fail(const std::string& message) {
+    if (problem.empty()) problem = message;
+    return false;
+}
+
+NoiseVolumeBuilder::NoiseVolumeBuilder(const std::string& name, int width, int height, int depth)
+    : volumeName(name), volumeWidth(width), volumeHeight(height), volumeDepth(depth) {}
+
+const std::string& NoiseVolumeBuilder::name() const {
+    return volumeName;
+}
+
+int NoiseVolumeBuilder::width() const {
+    return volumeWidth;
+}
+
+int NoiseVolumeBuilder::height() const {
+    return volumeHeight;
+}
+
+int NoiseVolumeBuilder::depth() const {
+    return volumeDepth;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::noise(const std::string& name, const FastNoiseLite& noise) {
+    for (auto& entry : noises) {
+        if (entry.first == name) {
+            entry.second = noise;
+            return *this;
+        }
+    }
+    noises.push_back({name, noise});
+    return *this;
+}
+
+const FastNoiseLite* NoiseVolumeBuilder::findNoise(const std::string& name) const {
+    for (const auto& entry : noises) {
+        if (entry.first == name) return &entry.second;
+    }
+    return nullptr;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::channels(int channels) {
+    channelCount = channels;
+    return *this;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::channel(int channel, const std::string& expression) {
+    if (channel >= (int)expressions.size()) expressions.resize(std::max(channel + 1, 0));
+    if (channel >= 0) expressions[channel] = expression;
+    return *this;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::channelRange(int channel, float min, float max) {
+    channelRanges.push_back({channel, {min, max}});
+    return *this;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::format(TexelFormat format) {
+    texelFormat = format;
+    return *this;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::axes(int xAxis, int yAxis, int zAxis) {
+    axisOrder[0] = xAxis;
+    axisOrder[1] = yAxis;
+    axisOrder[2] = zAxis;
+    return *this;
+}
+
+NoiseVolumeBuilder& NoiseVolumeBuilder::proxy(int divisor) {
+    proxyDivisor = divisor;
+    return *this;
+}
+
+bool NoiseVolumeBuilder::build(NoiseVolume& volume) const {
+    auto fail = [&](const std::string& message) {
+        std::cout << "Noise volume " << volumeName << ": " << message << "\n";
+        return false;
+    };
+    int channels = channelCount > 0 ? channelCount : (int)expressions.size();
+    if (volumeWidth <= 0 || volumeHeight <= 0 || volumeDepth <= 0) return fail("the size has to be positive");
+    if (channels < 1 || channels > 4) return fail("needs 1 to 4 channels, has " + std::to_string(channels));
+    if ((int)expressions.size() > channels) return fail("channel " + std::to_string(expressions.size() - 1) + " is past its channel count");
+    bool permutation = axisOrder[0] != axisOrder[1] && axisOrder[0] != axisOrder[2] && axisOrder[1] != axisOrder[2];
+    if (!permutation || std::min({axisOrder[0], axisOrder[1], axisOrder[2]}) < 0 || std::max({axisOrder[0], axisOrder[1], axisOrder[2]}) > 2) {
+        return fail("the axes have to be an order of x, y and z");
+    }
+    int proxyLevel = 0;
+    while ((1 << proxyLevel) < proxyDivisor) proxyLevel++;
+    if ((1 << proxyLevel) != proxyDivisor || proxyLevel > 30) return fail("the proxy divisor has to be a power of two");
+    if (volumeWidth % proxyDivisor != 0 || volumeHeight % proxyDivisor != 0 || volumeDepth % proxyDivisor != 0) {
+        return fail("the proxy divisor " + std::to_string(proxyDivisor) + " does not divide the size");
+    }
+
+    std::vector<int> slotNoises;
+    volume.stackDepth = 1;
+    std::string error;
+    if (!compileChannels(channels, volume.programs, slotNoises, volume.stackDepth, error)) return fail(error);
+
+    volume.ranges.assign(channels, {0.0f, 1.0f});
+    for (const auto& range : channelRanges) {
+        if (range.first < 0 || range.first >= channels) return fail("range for missing channel " + std::to_string(range.first));
+        if (!(range.second.max > range.second.min)) return fail("range of channel " + std::to_string(range.first) + " is empty");
+        volume.ranges[range.first] = range.second;
+    }
+
+    //generators nothing refers to are never evaluated
+    volume.generators = NoiseLayers((int)slotNoises.size());
+    for (int slot=0; slot<(int)slotNoises.size(); slot++) volume.generators.addLayer(noises[slotNoises[slot]].second, slot);
+    volume.generators.setAxes(axisOrder[0], axisOrder[1], axisOrder[2]);
+    volume.volumeName = volumeName;
+    volume.width = volumeWidth;
+    volume.height = volumeHeight;
+    volume.depth = volumeDepth;
+    volume.format = texelFormat;
+    volume.proxyLevel = proxyLevel;
+    return true;
+}
+
+bool NoiseVolumeBuilder::glslChannels(const std::string& function, NoiseStates& states) const {
+    NoiseVolume volume;
+    if (!build(volume)) return false;
+    std::vector<std::vector<ExpressionOp>> programs;
+    std::vector<int> slotNoises;
+    int stackDepth = 1;
+    std::string error;
+    compileChannels(volume.channelCount(), programs, slotNoises, stackDepth, error);
+    for (int noise : slotNoises) states.add(noises[noise].first, noises[noise].second);
+
+    std::ostringstream glsl;
+    glsl << "vec4 " << function << "(vec3 texel) {\n";
+    //noise axis axisOrder[i] runs along texel axis i, like NoiseLayers::setAxes
+    const char* texelAxes[3];
+    for (int i=0; i<3; i++) texelAxes[axisOrder[i]] = i == 0 ? "texel.x" : i == 1 ? "texel.y" : "texel.z";
+    glsl << "    vec3 coords = vec3(" << texelAxes[0] << ", " << texelAxes[1] << ", " << texelAxes[2] << ");\n";
+    for (int c=0; c<volume.channelCount(); c++) {
+        //the postfix program back to infix, fully parenthesized, min(max()) rather than clamp for a low above high
+        std::vector<std::string> stack;
+        for (const ExpressionOp& op : programs[c]) {
+            int operands = expressionOperands(op.kind);
+            std::string first, second, third;
+            if (operands > 0) first = stack[stack.size() - operands];
+            if (operands > 1) second = stack[stack.size() - operands + 1];
+            if (operands > 2) third = stack[stack.size() - operands + 2];
+            stack.resize(stack.size() - operands);
+            switch (op.kind) {
+            case EXPR_NOISE:
+                stack.push_back("fnlGetNoise3D(" + noises[slotNoises[op.noise]].first + ", coords.x, coords.y, coords.z)");
+                break;
+            case EXPR_CONSTANT:
+                stack.push_back("(" + glslFloat(op.constant) + ")");
+                break;
+            case EXPR_NEGATE:
+                stack.push_back("(-" + first + ")");
+                break;
+            case EXPR_ABS:
+                stack.push_back("abs(" + first + ")");
+                break;
+            case EXPR_ADD:
+                stack.push_back("(" + first + " + " + second + ")");
+                break;
+            case EXPR_SUBTRACT:
+                stack.push_back("(" + first + " - " + second + ")");
+                break;
+            case EXPR_MULTIPLY:
+                stack.push_back("(" + first + " * " + second + ")");
+                break;
+            case EXPR_DIVIDE:
+                stack.push_back("(" + first + " / " + second + ")");
+                break;
+            case EXPR_MIN:
+                stack.push_back("min(" + first + ", " + second + ")");
+                break;
+            case EXPR_MAX:
+                stack.push_back("max(" + first + ", " + second + ")");
+                break;
+            case EXPR_CLAMP:
+                stack.push_back("min(max(" + first + ", " + second + "), " + third + ")");
+                break;
+            }
+        }
+        //precise, so the shader rounds every step like runExpression instead of fusing them
+        glsl << "    precise float channel" << c << " = " << stack[0] << ";\n";
+        const ChannelRange& range = volume.ranges[c];
+        if (range.min != 0.0f || range.max != 1.0f) {
+            glsl << "    channel" << c << " = (channel" << c << " - " << glslFloat(range.min) << ") * "
+                << glslFloat(1.0f / (range.max - range.min)) << ";\n";
+        }
+    }
+    glsl << "    return vec4(";
+    for (int c=0; c<4; c++) glsl << (c > 0 ? ", " : "") << (c < volume.channelCount() ? "channel" + std::to_string(c) : "0.0");
+    glsl << ");\n}\n";
+    states.addFunction(glsl.str());
+    return true;
+}
+
+bool NoiseVolumeBuilder::compileChannels(int channels, std::vector<std::vector<ExpressionOp>>& programs, std::vector<int>& slotNoises,
+    int& stackDepth, std::string& error) const {
+    ExpressionCompiler compiler(noises, slotNoises);
+    programs.assign(channels, {});
+    for (int c=0; c<channels; c++) {
+        std::string expression = c < (int)expressions.size() && !expressions[c].empty() ? expressions[c] : "0";
+        if (!compiler.compile(expression, programs[c], stackDepth, error)) {
+            error = "channel " + std::to_string(c) + ": " + error + " in \"" + expression + "\"";
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string& NoiseVolume::name() const {
+    return volumeName;
+}
+
+int NoiseVolume::channelCount() const {
+    return (int)programs.size();
+}
+
+size_t NoiseVolume::rowBytes() const {
+    return (size_t)width * texelBytes(format, channelCount());
+}
+
+void NoiseVolume::fillBrick(const VolumeBrick& brick, void* texels, ChannelStats* stats) const {
+    int channels = channelCount();
+    int slots = generators.channelCount();
+    int n = brick.width;
+    std::vector<float> values((size_t)n * brick.height * brick.depth * slots);
+    float step = (float)sampleStep;
+    generators.genUniformGrid3D(brick.x * step, brick.y * step, brick.z * step, step, n, brick.height, brick.depth, values.data());
+
+    //each row is split into one run per generator, every channel's expression runs over them and the results are
+    //interleaved into one row of texels
+    std::vector<float> noiseRows((size_t)slots * n), stack((size_t)stackDepth * n), row((size_t)n * channels);
+    std::vector<ChannelStats> brickStats(channels);
+    for (int z=0; z<brick.depth; z++) {
+        for (int y=0; y<brick.height; y++) {
+            const float* value = &values[((size_t)z * brick.height + y) * n * slots];
+            for (int slot=0; slot<slots; slot++) {
+                for (int x=0; x<n; x++) noiseRows[(size_t)slot * n + x] = value[(size_t)x * slots + slot];
+            }
+            for (int c=0; c<channels; c++) {
+                runExpression(programs[c], noiseRows.data(), n, stack.data());
+                for (int x=0; x<n; x++) row[(size_t)x * channels + c] = stack[x];
+            }
+            unsigned char* out = (unsigned char*)texels + ((size_t)z * height + y) * rowBytes();
+            storeTexelRow(row.data(), n, channels, ranges.data(), format, out, brickStats.data());
+        }
+    }
+
+    if (stats != nullptr) {
+        for (int c=0; c<channels; c++) stats[c].merge(brickStats[c]);
+    }
+}
+
+VolumeCacheKey NoiseVolume::cacheKey() const {
+    int channels = channelCount();
+    VolumeCacheKey key(volumeName.c_str(), width, height, depth, texelUploadFormat(channels), texelUploadType(format), texelBytes(format, channels));
+    key.add(NOISE_VOLUME_VERSION).add(generators);
+    for (int c=0; c<channels; c++) {
+        key.add((int)programs[c].size());
+        for (const ExpressionOp& op : programs[c]) key.add((int)op.kind).add(op.noise).add(op.constant);
+        key.add(ranges[c].min).add(ranges[c].max);
+    }
+    return key;
+}
+
+bool NoiseVolume::uploadFromCache(const VolumeCacheKey& key, GLuint texture) const {
+    auto cacheStart = std::chrono::steady_clock::now();
+    MappedVolume cache(key);
+    if (!cache.valid()) return false;
+    std::chrono::duration<double, std::milli> loadMs = std::chrono::steady_clock::now() - cacheStart;
+    printCacheLoadTime(volumeName.c_str(), width, height, depth, loadMs.count());
+    int channels = channelCount();
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTextureSubImage3D(texture, 0, 0, 0, 0, width, height, depth, texelUploadFormat(channels), texelUploadType(format), cache.texels());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    return true;
+}
+
+GLuint NoiseVolume::allocateTexture() const {
+    int channels = channelCount();
+    glTexImage3D(GL_TEXTURE_3D, 0, texelInternalFormat(format, channels), width, height, depth, 0,
+        texelUploadFormat(channels), texelUploadType(format), NULL);
+    GLint texture;
+    glGetIntegerv(GL_TEXTURE_BINDING_3D, &texture);
+    return (GLuint)texture;
+}
+
+void NoiseVolume::upload(ThreadPool& pool, bool useCache) const {
+    //baked straight into the upload format and uploaded slab by slab while the next slabs bake
+    VolumeBake bake(*this, allocateTexture(), useCache);
+    bake.update(pool, true);
+}
+
+std::unique_ptr<VolumeBake> NoiseVolume::uploadProgressive(ThreadPool& pool, bool useCache) const {
+    GLuint texture = allocateTexture();
+    auto bake = std::make_unique<VolumeBake>(*this, texture, useCache);
+    if (proxyLevel == 0) {
+        bake->update(pool, true);
+        return nullptr;
+    }
+    //a volume already in the cache needs no proxy, its lock only matters once it has to be baked
+    if (useCache && uploadFromCache(cacheKey(), texture)) return nullptr;
+    uploadProxy(pool);
+    return bake;
+}
+
+void NoiseVolume::uploadProxy(ThreadPool& pool) const {
+    //the same noise sampled every 2^proxyLevel texels, a texel of the proxy is the texel of the full volume at its corner
+    NoiseVolume proxy = *this;
+    proxy.width = width >> proxyLevel;
+    proxy.height = height >> proxyLevel;
+    proxy.depth = depth >> proxyLevel;
+    proxy.sampleStep = 1 << proxyLevel;
+    std::vector<unsigned char> texels(proxy.rowBytes() * proxy.height * proxy.depth);
+    auto fillProxy = [&](const VolumeBrick& brick) {
+        proxy.fillBrick(brick, &texels[((size_t)brick.z * proxy.height + brick.y) * proxy.rowBytes()]);
+    };
+    double bakeMs = bakeVolume(pool, proxy.width, proxy.height, proxy.depth, fillProxy);
+    printBakeTime((volumeName + " proxy").c_str(), proxy.width, proxy.height, proxy.depth, bakeMs, pool.threadCount());
+
+    int channels = channelCount();
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_3D, proxyLevel, texelInternalFormat(format, channels), proxy.width, proxy.height, proxy.depth, 0,
+        texelUploadFormat(channels), texelUploadType(format), texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, proxyLevel);
+}
+
+VolumeBake::VolumeBake(const NoiseVolume& volume, GLuint texture, bool useCache)
+    : volume(volume), texture(texture), stats(volume.channelCount()) {
+    if (useCache) cacheLock = std::make_unique<VolumeCacheLock>(volume.cacheKey());
+}
+
+bool VolumeBake::update(ThreadPool& pool, bool wait) {
+    int channels = volume.channelCount();
+    if (!streamer) {
+        if (cacheLock) {
+            if (!(wait ? cacheLock->lock() : cacheLock->tryLock())) {
+                if (!waiting) std::cout << "Waiting for another process to bake " << volume.volumeName << "\n";
+                waiting = true;
+                return false;
+            }
+            //the last holder published the volume, or failed and left it to this process
+            VolumeCacheKey key = volume.cacheKey();
+            if (volume.uploadFromCache(key, texture)) return finish();
+            cacheWriter = std::make_unique<VolumeCacheWriter>(key);
+        }
+        auto fill = [this, channels](const VolumeBrick& brick, void* texels) {
+            std::vector<ChannelStats> brickStats(channels);
+            volume.fillBrick(brick, texels, brickStats.data());
+            std::lock_guard<std::mutex> lock(statsMutex);
+            for (int c=0; c<channels; c++) stats[c].merge(brickStats[c]);
+        };
+        auto storeSlab = [this](const void* texels, size_t bytes) {
+            if (cacheWriter) cacheWriter->write(texels, bytes);
+        };
+        startTime = std::chrono::steady_clock::now();
+        streamer = std::make_unique<VolumeStreamer>(volume.width, volume.height, volume.depth, texelUploadFormat(channels),
+            texelUploadType(volume.format), texelBytes(volume.format, channels));
+        streamer->start(pool, fill, storeSlab, texture);
+    }
+    if (!streamer->update(wait)) return false;
+
+    std::chrono::duration<double, std::milli> bakeMs = std::chrono::steady_clock::now() - startTime;
+    printBakeTime(volume.volumeName.c_str(), volume.width, volume.height, volume.depth, bakeMs.count(), pool.threadCount());
+    printChannelStats(volume.volumeName.c_str(), stats.data(), channels);
+    if (cacheWriter) cacheWriter->commit();
+    return finish();
+}
+
+bool VolumeBake::finish() {
+    //published, the processes waiting for the lock find the volume in the cache now
+    cacheLock.reset();
+    GLint baseLevel;
+    glGetTextureParameteriv(texture, GL_TEXTURE_BASE_LEVEL, &baseLevel);
+    if (baseLevel != 0) {
+        glTextureParameteri(texture, GL_TEXTURE_BASE_LEVEL, 0);
+        glGenerateTextureMipmap(texture);
+    }
+    return true;
+}
+
+void NoiseVolume::printScaling() const {
+    //bricks are whole rows, so a brick is one contiguous run of texels in a whole volume buffer
+    std::vector<unsigned char> texels(rowBytes() * height * depth);
+    auto fillVolume = [&](const VolumeBrick& brick) {
+        fillBrick(brick, &texels[((size_t)brick.z * height + brick.y) * rowBytes() + (size_t)brick.x * texelBytes(format, channelCount())]);
+    };
+    printBakeScaling(volumeName.c_str(), width, height, depth, fillVolume);
+}
+
+void setTilingFrequency(FastNoiseLite& noise, int period, int size) {
+    noise.SetPeriod(period);
+    noise.SetFrequency((float)period / size);
+}
+
+//index of word in names, -1 when it is none of them
+int findName(const char* const* names, int count, const std::string& word) {
+    for (int i=0; i<count; i++) {
+        if (word == names[i]) return i;
+    }
+    return -1;
+}
+
+//applies one "<setting> <value>" line of a noise section, error describes what is wrong when it returns false
+bool applyNoiseSetting(FastNoiseLite& noise, const std::string& setting, std::istringstream& line, int volumeWidth, std::string& error) {
+    typedef FastNoiseLite FNL;
+    const char* noiseTypes[] = {"opensimplex2", "opensimplex2s", "cellular", "perlin", "valuecubic", "value"};
+    const char* rotationTypes[] = {"none", "improvexy", "improvexz"};
+    const char* fractalTypes[] = {"none", "fbm", "ridged", "pingpong"};
+    const char* distanceFunctions[] = {"euclidean", "euclideansq", "manhattan", "hybrid"};
+    const char* returnTypes[] = {"cellvalue", "distance", "distance2", "distance2add", "distance2sub", "distance2mul", "distance2div"};
+
+    std::string word;
+    float number = 0.0f;
+    bool isName = setting == "type" || setting == "rotation" || setting == "fractal" || setting == "distance" || setting == "return";
+    bool parsed = isName ? (bool)(line >> word) : (bool)(line >> number);
+    if (!parsed) {
+        error = "missing value for " + setting;
+        return false;
+    }
+
+    int index = 0;
+    if (setting == "type" && (index = findName(noiseTypes, 6, word)) >= 0) noise.SetNoiseType((FNL::NoiseType)index);
+    else if (setting == "rotation" && (index = findName(rotationTypes, 3, word)) >= 0) noise.SetRotationType3D((FNL::RotationType3D)index);
+    else if (setting == "fractal" && (index = findName(fractalTypes, 4, word)) >= 0) noise.SetFractalType((FNL::FractalType)index);
+    else if (setting == "distance" && (index = findName(distanceFunctions, 4, word)) >= 0) noise.SetCellularDistanceFunction((FNL::CellularDistanceFunction)index);
+    else if (setting == "return" && (index = findName(returnTypes, 7, word)) >= 0) noise.SetCellularReturnType((FNL::CellularReturnType)index);
+    else if (isName) {
+        error = "unknown " + setting + " '" + word + "'";
+        return false;
+    }
+    else if (setting == "seed") noise.SetSeed((int)number);
+    else if (setting == "frequency") noise.SetFrequency(number);
+    else if (setting == "period") setTilingFrequency(noise, (int)number, volumeWidth);
+    else if (setting == "octaves") noise.SetFractalOctaves((int)number);
+    else if (setting == "lacunarity") noise.SetFractalLacunarity(number);
+    else if (setting == "gain") noise.SetFractalGain(number);
+    else if (setting == "weighted_strength") noise.SetFractalWeightedStrength(number);
+    else if (setting == "ping_pong_strength") noise.SetFractalPingPongStrength(number);
+    else if (setting == "jitter") noise.SetCellularJitter(number);
+    else {
+        error = "unknown setting '" + setting + "'";
+        return false;
+    }
+    return true;
+}
+
+bool loadNoiseRecipes(const char* path, std::vector<NoiseVolumeBuilder>& recipes) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Failed to open noise recipes " << path << "\n";
+        return false;
+    }
+
+    //a noise section collects settings until the next section starts, then joins its volume
+    std::string noiseName, noiseType;
+    FastNoiseLite noise;
+    bool inNoise = false, hasFrequency = false;
+    int periodLine = 0; //line of the section's period, 0 = none
+    std::string line, error;
+    int lineNumber = 0;
+    auto endNoise = [&]() {
+        //the type may follow the period, so it is checked once the section is complete
+        if (inNoise && periodLine > 0 && error.empty() && (noiseType == "opensimplex2" || noiseType == "opensimplex2s")) {
+            error = "noise " + noiseName + ": " + noiseType + " ignores period, set a frequency instead";
+            lineNumber = periodLine;
+        }
+        if (inNoise) recipes.back().noise(noiseName, noise);
+        inNoise = false;
+    };
+
+    while (error.empty() && std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue;
+
+        if (key == "volume") {
+            endNoise();
+            std::string name;
+            int width = 0, height = 0, depth = 0;
+            if (!(fields >> name >> width >> height >> depth)) error = "expected volume <name> <width> <height> <depth>";
+            else recipes.emplace_back(name, width, height, depth);
+            continue;
+        }
+        if (recipes.empty()) {
+            error = "'" + key + "' before the first volume";
+            continue;
+        }
+        NoiseVolumeBuilder& recipe = recipes.back();
+
+        if (key == "noise") {
+            endNoise();
+            if (!(fields >> noiseName)) error = "expected noise <name>";
+            noise = FastNoiseLite();
+            noiseType = "opensimplex2";
+            inNoise = true;
+            hasFrequency = false;
+            periodLine = 0;
+        } else if (key == "channel") {
+            endNoise();
+            int channel;
+            std::string equals, expression;
+            if (!(fields >> channel >> equals) || equals != "=" || channel < 0) error = "expected channel <index> = <expression>";
+            else if (std::getline(fields, expression)) recipe.channel(channel, expression);
+            else recipe.channel(channel, "");
+        } else if (key == "channels") {
+            int channels;
+            if (!(fields >> channels)) error = "expected channels <count>";
+            else recipe.channels(channels);
+        } else if (key == "format") {
+            const char* formats[] = {"float", "half", "unorm8"};
+            std::string name;
+            fields >> name;
+            int format = findName(formats, 3, name);
+            if (format < 0) error = "unknown format '" + name + "'";
+            else recipe.format((TexelFormat)format);
+        } else if (key == "axes") {
+            std::string order;
+            fields >> order;
+            if (order.size() != 3) error = "expected axes like xyz or yxz";
+            int axes[3];
+            for (int i=0; i<3 && error.empty(); i++) {
+                axes[i] = order[i] - 'x';
+                if (axes[i] < 0 || axes[i] > 2) error = "expected axes like xyz or yxz";
+            }
+            if (error.empty()) recipe.axes(axes[0], axes[1], axes[2]);
+        } else if (key == "proxy") {
+            int divisor;
+            if (!(fields >> divisor)) error = "expected proxy <divisor>";
+            else recipe.proxy(divisor);
+        } else if (key == "range") {
+            int channel;
+            float min, max;
+            if (!(fields >> channel >> min >> max)) error = "expected range <channel> <min> <max>";
+            else recipe.channelRange(channel, min, max);
+        } else if (inNoise) {
+            //the period sets the frequency that tiles the width, which has to tile the height and depth as well
+            if ((key == "period" && hasFrequency) || (key == "frequency" && periodLine > 0)) {
+                error = "noise " + noiseName + " has both a period and a frequency, the period sets the frequency";
+            } else if (key == "period" && (recipe.height() % recipe.width() != 0 || recipe.depth() % recipe.width() != 0)) {
+                error = "period tiles the volume width, its height and depth have to be multiples of the width";
+            } else if (applyNoiseSetting(noise, key, fields, recipe.width(), error) && key == "type") {
+                std::istringstream(line) >> key >> noiseType;
+            }
+            hasFrequency |= key == "frequency";
+            if (key == "period") periodLine = lineNumber;
+        } else {
+            error = "unknown key '" + key + "'";
+        }
+    }
+    endNoise();
+
+    if (!error.empty()) {
+        std::cout << path << ":" << lineNumber << ": " << error << "\n";
+        return false;
+    }
+    return true;
+}
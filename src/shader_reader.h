@@ -35,6 +35,8 @@ public:
 	Shader(const char* vertexPath, const char* fragmentPath);
 	Shader(const char* vertexPath, const char* geoPath, const char* fragmentPath);
 	Shader(const char* computePath);
+	//a compute shader with noiseStates in place of its #include NoiseStates, see gpu_noise.h
+	Shader(const char* computePath, const std::string& noiseStates);
 	void use();
 	void setBool(const std::string& name, bool value) const;
 	void setInt(const std::string& name, int value) const;
@@ -67,6 +69,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
 	catch(std::ifstream::failure e) {
 		std::cout << "ERROR::SHADER1::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
 	}
+	fragmentCode = preprocessString(fragmentCode, "#include CloudDensity", readStringFromFile("./src/shaders/cloudDensity.glsl"));
 	const char* vShaderCode = vertexCode.c_str();
 	const char* fShaderCode = fragmentCode.c_str();
 
@@ -200,14 +203,18 @@ Shader::Shader(const char* vertexPath, const char* geoPath, const char* fragment
 	glDeleteShader(fragment);
 }
 
-Shader::Shader(const char* computePath) {
+Shader::Shader(const char* computePath) : Shader(computePath, std::string()) {}
+
+Shader::Shader(const char* computePath, const std::string& noiseStates) {
 	std::string computeCode;
 	std::ifstream cShaderFile;
 
 	computeCode = readStringFromFile(computePath);
 
 	//TODO REMOVE HARDCODED PREPROCESSING
-	computeCode = preprocessString(computeCode, "#include FastNoiseLite", readStringFromFile(".\\src\\shaders\\FastNoiseLite.glsl"));
+	computeCode = preprocessString(computeCode, "#include FastNoiseLite", readStringFromFile("./src/shaders/FastNoiseLite.glsl"));
+	computeCode = preprocessString(computeCode, "#include NoiseStates", noiseStates);
+	computeCode = preprocessString(computeCode, "#include CloudDensity", readStringFromFile("./src/shaders/cloudDensity.glsl"));
 	//std::cout << computeCode.substr(0, 512) << std::endl;
 
 	const char* cShaderCode = computeCode.c_str();
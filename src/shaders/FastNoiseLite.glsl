@@ -108,6 +108,11 @@ struct fnl_state
     // @remark Default: 0.01
     float frequency;
 
+    // Period in noise cells after which Perlin, Value, ValueCubic and Cellular noise repeat, 0 for no repetition.
+    // Fractal octaves repeat after the previous period times lacunarity (rounded).
+    // @remark Default: 0
+    int period;
+
     // The noise algorithm to be used by GetNoise(...).
     // @remark Default: FNL_NOISE_OPENSIMPLEX2
     fnl_noise_type noise_type;
@@ -343,6 +348,22 @@ const int PRIME_X = 501125321;
 const int PRIME_Y = 1136930381;
 const int PRIME_Z = 1720413743;
 
+// Primed lattice coordinate, wrapped into [0, period) first when the noise is periodic
+int _fnlPrimeCell(int cell, int prime, int period)
+{
+    // % is undefined for negative operands in GLSL
+    if (period > 0)
+    {
+        cell = cell >= 0 ? cell % period : period - 1 - (-1 - cell) % period;
+    }
+    return cell * prime;
+}
+
+int _fnlNextOctavePeriod(fnl_state state, int period)
+{
+    return period > 0 ? int(float(period) * state.lacunarity + 0.5f) : 0;
+}
+
 int _fnlHash2D(int seed, int xPrimed, int yPrimed)
 {
     int hash = seed ^ xPrimed ^ yPrimed;
@@ -1015,7 +1036,40 @@ float _fnlSingleOpenSimplex2S3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
 }
 
 // Cellular Noise
-float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
+// Cellular noise value for the return type from the two smallest distances to feature points and the hash of the closest
+float _fnlCellularValue(fnl_state state, float distance0, float distance1, int closestHash)
+{
+    if (state.cellular_distance_func == FNL_CELLULAR_DISTANCE_EUCLIDEAN && state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE)
+    {
+        distance0 = _fnlFastSqrt(distance0);
+        if (state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE2)
+        {
+            distance1 = _fnlFastSqrt(distance1);
+        }
+    }
+
+    switch (state.cellular_return_type)
+    {
+        case FNL_CELLULAR_RETURN_TYPE_CELLVALUE:
+            return float(closestHash) * (1.f / 2147483648.f);
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE:
+            return distance0 - 1.f;
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2:
+            return distance1 - 1.f;
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2ADD:
+            return (distance1 + distance0) * 0.5f - 1.f;
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2SUB:
+            return distance1 - distance0 - 1.f;
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2MUL:
+            return distance1 * distance0 * 0.5f - 1.f;
+        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2DIV:
+            return distance0 / distance1 - 1.f;
+        default:
+            return 0.f;
+    }
+}
+
+float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y, int period)
 {
     int xr = _fnlFastRound(x);
     int yr = _fnlFastRound(y);
@@ -1026,8 +1080,12 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
 
     float cellularJitter = 0.43701595f * state.cellular_jitter_mod;
 
-    int xPrimed = (xr - 1) * PRIME_X;
-    int yPrimedBase = (yr - 1) * PRIME_Y;
+    int xPrimes[3], yPrimes[3];
+    for (int i = 0; i < 3; i++)
+    {
+        xPrimes[i] = _fnlPrimeCell(xr - 1 + i, PRIME_X, period);
+        yPrimes[i] = _fnlPrimeCell(yr - 1 + i, PRIME_Y, period);
+    }
 
     switch (state.cellular_distance_func)
     {
@@ -1035,11 +1093,9 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
         {
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = _fnlHash2D(seed, xPrimed, yPrimed);
+                    int hash = _fnlHash2D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = float(xi) - x + RAND_VECS_2D[idx] * cellularJitter;
@@ -1053,9 +1109,7 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PRIME_Y;
                 }
-                xPrimed += PRIME_X;
             }
             break;
         }
@@ -1063,10 +1117,9 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
         {
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = _fnlHash2D(seed, xPrimed, yPrimed);
+                    int hash = _fnlHash2D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = float(xi) - x + RAND_VECS_2D[idx] * cellularJitter;
@@ -1080,9 +1133,7 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PRIME_Y;
                 }
-                xPrimed += PRIME_X;
             }
             break;
         }
@@ -1092,11 +1143,9 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
         {
             for (int xi = xr - 1; xi <= xr + 1; xi++)
             {
-                int yPrimed = yPrimedBase;
-
                 for (int yi = yr - 1; yi <= yr + 1; yi++)
                 {
-                    int hash = _fnlHash2D(seed, xPrimed, yPrimed);
+                    int hash = _fnlHash2D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1]);
                     int idx = hash & (255 << 1);
 
                     float vecX = float(xi) - x + RAND_VECS_2D[idx] * cellularJitter;
@@ -1110,45 +1159,16 @@ float _fnlSingleCellular2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    yPrimed += PRIME_Y;
                 }
-                xPrimed += PRIME_X;
             }
             break;
         }
     }
 
-    if (state.cellular_distance_func == FNL_CELLULAR_DISTANCE_EUCLIDEAN && state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE)
-    {
-        distance0 = _fnlFastSqrt(distance0);
-        if (state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE2)
-		{			
-            distance1 = _fnlFastSqrt(distance1);
-		}
-    }
-
-    switch (state.cellular_return_type)
-    {
-        case FNL_CELLULAR_RETURN_TYPE_CELLVALUE:
-            return float(closestHash) * (1.f / 2147483648.f);
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE:
-            return distance0 - 1.f;
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2:
-            return distance1 - 1.f;
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2ADD:
-            return (distance1 + distance0) * 0.5f - 1.f;
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2SUB:
-            return distance1 - distance0 - 1.f;
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2MUL:
-            return distance1 * distance0 * 0.5f - 1.f;
-        case FNL_CELLULAR_RETURN_TYPE_DISTANCE2DIV:
-            return distance0 / distance1 - 1.f;
-        default:
-            return 0.f;
-    }
+    return _fnlCellularValue(state, distance0, distance1, closestHash);
 }
 
-float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FNLfloat z)
+float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period)
 {
     int xr = _fnlFastRound(x);
     int yr = _fnlFastRound(y);
@@ -1160,9 +1180,13 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
 
     float cellularJitter = 0.39614353 * state.cellular_jitter_mod;
 
-    int xPrimed = (xr - 1) * PRIME_X;
-    int yPrimedBase = (yr - 1) * PRIME_Y;
-    int zPrimedBase = (zr - 1) * PRIME_Z;
+    int xPrimes[3], yPrimes[3], zPrimes[3];
+    for (int i = 0; i < 3; i++)
+    {
+        xPrimes[i] = _fnlPrimeCell(xr - 1 + i, PRIME_X, period);
+        yPrimes[i] = _fnlPrimeCell(yr - 1 + i, PRIME_Y, period);
+        zPrimes[i] = _fnlPrimeCell(zr - 1 + i, PRIME_Z, period);
+    }
 
     switch (state.cellular_distance_func)
     {
@@ -1170,15 +1194,11 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
     {
         for (int xi = xr - 1; xi <= xr + 1; xi++)
         {
-            int yPrimed = yPrimedBase;
-
             for (int yi = yr - 1; yi <= yr + 1; yi++)
             {
-                int zPrimed = zPrimedBase;
-
                 for (int zi = zr - 1; zi <= zr + 1; zi++)
                 {
-                    int hash = _fnlHash3D(seed, xPrimed, yPrimed, zPrimed);
+                    int hash = _fnlHash3D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                     int idx = hash & (255 << 2);
 
                     float vecX = float(xi) - x + RAND_VECS_3D[idx] * cellularJitter;
@@ -1193,11 +1213,8 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    zPrimed += PRIME_Z;
                 }
-                yPrimed += PRIME_Y;
             }
-            xPrimed += PRIME_X;
         }
         break;
     }
@@ -1205,15 +1222,11 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
     {
         for (int xi = xr - 1; xi <= xr + 1; xi++)
         {
-            int yPrimed = yPrimedBase;
-
             for (int yi = yr - 1; yi <= yr + 1; yi++)
             {
-                int zPrimed = zPrimedBase;
-
                 for (int zi = zr - 1; zi <= zr + 1; zi++)
                 {
-                    int hash = _fnlHash3D(seed, xPrimed, yPrimed, zPrimed);
+                    int hash = _fnlHash3D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                     int idx = hash & (255 << 2);
 
                     float vecX = float(xi) - x + RAND_VECS_3D[idx] * cellularJitter;
@@ -1228,11 +1241,8 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    zPrimed += PRIME_Z;
                 }
-                yPrimed += PRIME_Y;
             }
-            xPrimed += PRIME_X;
         }
         break;
     }
@@ -1242,15 +1252,11 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
     {
         for (int xi = xr - 1; xi <= xr + 1; xi++)
         {
-            int yPrimed = yPrimedBase;
-
             for (int yi = yr - 1; yi <= yr + 1; yi++)
             {
-                int zPrimed = zPrimedBase;
-
                 for (int zi = zr - 1; zi <= zr + 1; zi++)
                 {
-                    int hash = _fnlHash3D(seed, xPrimed, yPrimed, zPrimed);
+                    int hash = _fnlHash3D(seed, xPrimes[xi - xr + 1], yPrimes[yi - yr + 1], zPrimes[zi - zr + 1]);
                     int idx = hash & (255 << 2);
 
                     float vecX = float(xi) - x + RAND_VECS_3D[idx] * cellularJitter;
@@ -1265,48 +1271,18 @@ float _fnlSingleCellular3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
                         distance0 = newDistance;
                         closestHash = hash;
                     }
-                    zPrimed += PRIME_Z;
                 }
-                yPrimed += PRIME_Y;
             }
-            xPrimed += PRIME_X;
         }
         break;
     }
     }
 
-    if (state.cellular_distance_func == FNL_CELLULAR_DISTANCE_EUCLIDEAN && state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE)
-    {
-        distance0 = _fnlFastSqrt(distance0);
-        if (state.cellular_return_type >= FNL_CELLULAR_RETURN_TYPE_DISTANCE2)
-		{
-            distance1 = _fnlFastSqrt(distance1);
-		}
-    }
-
-    switch (state.cellular_return_type)
-    {
-    case FNL_CELLULAR_RETURN_TYPE_CELLVALUE:
-        return float(closestHash) * (1.f / 2147483648.f);
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE:
-        return distance0 - 1.f;
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE2:
-        return distance1 - 1.f;
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE2ADD:
-        return (distance1 + distance0) * 0.5f - 1.f;
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE2SUB:
-        return distance1 - distance0 - 1.f;
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE2MUL:
-        return distance1 * distance0 * 0.5f - 1.f;
-    case FNL_CELLULAR_RETURN_TYPE_DISTANCE2DIV:
-        return distance0 / distance1 - 1.f;
-    default:
-        return 0.f;
-    }
+    return _fnlCellularValue(state, distance0, distance1, closestHash);
 }
 
 // Perlin Noise
-float _fnlSinglePerlin2D(int seed, FNLfloat x, FNLfloat y)
+float _fnlSinglePerlin2D(int seed, FNLfloat x, FNLfloat y, int period)
 {
     int x0 = _fnlFastFloor(x);
     int y0 = _fnlFastFloor(y);
@@ -1319,10 +1295,10 @@ float _fnlSinglePerlin2D(int seed, FNLfloat x, FNLfloat y)
     float xs = _fnlInterpQuintic(xd0);
     float ys = _fnlInterpQuintic(yd0);
 
-    x0 *= PRIME_X;
-    y0 *= PRIME_Y;
-    int x1 = x0 + PRIME_X;
-    int y1 = y0 + PRIME_Y;
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
 
     float xf0 = _fnlLerp(_fnlGradCoord2D(seed, x0, y0, xd0, yd0), _fnlGradCoord2D(seed, x1, y0, xd1, yd0), xs);
     float xf1 = _fnlLerp(_fnlGradCoord2D(seed, x0, y1, xd0, yd1), _fnlGradCoord2D(seed, x1, y1, xd1, yd1), xs);
@@ -1330,7 +1306,7 @@ float _fnlSinglePerlin2D(int seed, FNLfloat x, FNLfloat y)
     return _fnlLerp(xf0, xf1, ys) * 1.4247691104677813;
 }
 
-float _fnlSinglePerlin3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
+float _fnlSinglePerlin3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period)
 {
     int x0 = _fnlFastFloor(x);
     int y0 = _fnlFastFloor(y);
@@ -1347,12 +1323,12 @@ float _fnlSinglePerlin3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
     float ys = _fnlInterpQuintic(yd0);
     float zs = _fnlInterpQuintic(zd0);
 
-    x0 *= PRIME_X;
-    y0 *= PRIME_Y;
-    z0 *= PRIME_Z;
-    int x1 = x0 + PRIME_X;
-    int y1 = y0 + PRIME_Y;
-    int z1 = z0 + PRIME_Z;
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    int z1 = _fnlPrimeCell(z0 + 1, PRIME_Z, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+    z0 = _fnlPrimeCell(z0, PRIME_Z, period);
 
     float xf00 = _fnlLerp(_fnlGradCoord3D(seed, x0, y0, z0, xd0, yd0, zd0), _fnlGradCoord3D(seed, x1, y0, z0, xd1, yd0, zd0), xs);
     float xf10 = _fnlLerp(_fnlGradCoord3D(seed, x0, y1, z0, xd0, yd1, zd0), _fnlGradCoord3D(seed, x1, y1, z0, xd1, yd1, zd0), xs);
@@ -1367,7 +1343,7 @@ float _fnlSinglePerlin3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
 
 
 // Value Cubic
-float _fnlSingleValueCubic2D(int seed, FNLfloat x, FNLfloat y)
+float _fnlSingleValueCubic2D(int seed, FNLfloat x, FNLfloat y, int period)
 {
     int x1 = _fnlFastFloor(x);
     int y1 = _fnlFastFloor(y);
@@ -1375,15 +1351,14 @@ float _fnlSingleValueCubic2D(int seed, FNLfloat x, FNLfloat y)
     float xs = x - float(x1);
     float ys = y - float(y1);
 
-    x1 *= PRIME_X;
-    y1 *= PRIME_Y;
-
-    int x0 = x1 - PRIME_X;
-    int y0 = y1 - PRIME_Y;
-    int x2 = x1 + PRIME_X;
-    int y2 = y1 + PRIME_Y;
-    int x3 = x1 + PRIME_X * 2;
-    int y3 = y1 + PRIME_Y * 2;
+    int x0 = _fnlPrimeCell(x1 - 1, PRIME_X, period);
+    int y0 = _fnlPrimeCell(y1 - 1, PRIME_Y, period);
+    int x2 = _fnlPrimeCell(x1 + 1, PRIME_X, period);
+    int y2 = _fnlPrimeCell(y1 + 1, PRIME_Y, period);
+    int x3 = _fnlPrimeCell(x1 + 2, PRIME_X, period);
+    int y3 = _fnlPrimeCell(y1 + 2, PRIME_Y, period);
+    x1 = _fnlPrimeCell(x1, PRIME_X, period);
+    y1 = _fnlPrimeCell(y1, PRIME_Y, period);
 
     return _fnlCubicLerp(
         _fnlCubicLerp(_fnlValCoord2D(seed, x0, y0), _fnlValCoord2D(seed, x1, y0), _fnlValCoord2D(seed, x2, y0), _fnlValCoord2D(seed, x3, y0),
@@ -1397,7 +1372,7 @@ float _fnlSingleValueCubic2D(int seed, FNLfloat x, FNLfloat y)
         ys) * (1.f / (1.5f * 1.5f));
 }
 
-float _fnlSingleValueCubic3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
+float _fnlSingleValueCubic3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period)
 {
     int x1 = _fnlFastFloor(x);
     int y1 = _fnlFastFloor(y);
@@ -1407,19 +1382,18 @@ float _fnlSingleValueCubic3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
     float ys = y - float(y1);
     float zs = z - float(z1);
 
-    x1 *= PRIME_X;
-    y1 *= PRIME_Y;
-    z1 *= PRIME_Z;
-
-    int x0 = x1 - PRIME_X;
-    int y0 = y1 - PRIME_Y;
-    int z0 = z1 - PRIME_Z;
-    int x2 = x1 + PRIME_X;
-    int y2 = y1 + PRIME_Y;
-    int z2 = z1 + PRIME_Z;
-    int x3 = x1 + PRIME_X * 2;
-    int y3 = y1 + PRIME_Y * 2;
-    int z3 = z1 + PRIME_Z * 2;
+    int x0 = _fnlPrimeCell(x1 - 1, PRIME_X, period);
+    int y0 = _fnlPrimeCell(y1 - 1, PRIME_Y, period);
+    int z0 = _fnlPrimeCell(z1 - 1, PRIME_Z, period);
+    int x2 = _fnlPrimeCell(x1 + 1, PRIME_X, period);
+    int y2 = _fnlPrimeCell(y1 + 1, PRIME_Y, period);
+    int z2 = _fnlPrimeCell(z1 + 1, PRIME_Z, period);
+    int x3 = _fnlPrimeCell(x1 + 2, PRIME_X, period);
+    int y3 = _fnlPrimeCell(y1 + 2, PRIME_Y, period);
+    int z3 = _fnlPrimeCell(z1 + 2, PRIME_Z, period);
+    x1 = _fnlPrimeCell(x1, PRIME_X, period);
+    y1 = _fnlPrimeCell(y1, PRIME_Y, period);
+    z1 = _fnlPrimeCell(z1, PRIME_Z, period);
 
     return _fnlCubicLerp(
         _fnlCubicLerp(
@@ -1451,7 +1425,7 @@ float _fnlSingleValueCubic3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
 
 
 // Value noise
-float _fnlSingleValue2D(int seed, FNLfloat x, FNLfloat y)
+float _fnlSingleValue2D(int seed, FNLfloat x, FNLfloat y, int period)
 {
     int x0 = _fnlFastFloor(x);
     int y0 = _fnlFastFloor(y);
@@ -1459,10 +1433,10 @@ float _fnlSingleValue2D(int seed, FNLfloat x, FNLfloat y)
     float xs = _fnlInterpHermite(x - float(x0));
     float ys = _fnlInterpHermite(y - float(y0));
 
-    x0 *= PRIME_X;
-    y0 *= PRIME_Y;
-    int x1 = x0 + PRIME_X;
-    int y1 = y0 + PRIME_Y;
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
 
     float xf0 = _fnlLerp(_fnlValCoord2D(seed, x0, y0), _fnlValCoord2D(seed, x1, y0), xs);
     float xf1 = _fnlLerp(_fnlValCoord2D(seed, x0, y1), _fnlValCoord2D(seed, x1, y1), xs);
@@ -1470,7 +1444,7 @@ float _fnlSingleValue2D(int seed, FNLfloat x, FNLfloat y)
     return _fnlLerp(xf0, xf1, ys);
 }
 
-float _fnlSingleValue3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
+float _fnlSingleValue3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period)
 {
     int x0 = _fnlFastFloor(x);
     int y0 = _fnlFastFloor(y);
@@ -1480,12 +1454,12 @@ float _fnlSingleValue3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
     float ys = _fnlInterpHermite(y - float(y0));
     float zs = _fnlInterpHermite(z - float(z0));
 
-    x0 *= PRIME_X;
-    y0 *= PRIME_Y;
-    z0 *= PRIME_Z;
-    int x1 = x0 + PRIME_X;
-    int y1 = y0 + PRIME_Y;
-    int z1 = z0 + PRIME_Z;
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    int z1 = _fnlPrimeCell(z0 + 1, PRIME_Z, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+    z0 = _fnlPrimeCell(z0, PRIME_Z, period);
 
     float xf00 = _fnlLerp(_fnlValCoord3D(seed, x0, y0, z0), _fnlValCoord3D(seed, x1, y0, z0), xs);
     float xf10 = _fnlLerp(_fnlValCoord3D(seed, x0, y1, z0), _fnlValCoord3D(seed, x1, y1, z0), xs);
@@ -1499,7 +1473,7 @@ float _fnlSingleValue3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z)
 }
 
 // Generic Noise Gen
-float _fnlGenNoiseSingle2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
+float _fnlGenNoiseSingle2D(fnl_state state, int seed, FNLfloat x, FNLfloat y, int period)
 {
     switch (state.noise_type)
     {
@@ -1508,19 +1482,19 @@ float _fnlGenNoiseSingle2D(fnl_state state, int seed, FNLfloat x, FNLfloat y)
         case FNL_NOISE_OPENSIMPLEX2S:
             return _fnlSingleOpenSimplex2S2D(seed, x, y);
         case FNL_NOISE_CELLULAR:
-            return _fnlSingleCellular2D(state, seed, x, y);
+            return _fnlSingleCellular2D(state, seed, x, y, period);
         case FNL_NOISE_PERLIN:
-            return _fnlSinglePerlin2D(seed, x, y);
+            return _fnlSinglePerlin2D(seed, x, y, period);
         case FNL_NOISE_VALUE_CUBIC:
-            return _fnlSingleValueCubic2D(seed, x, y);
+            return _fnlSingleValueCubic2D(seed, x, y, period);
         case FNL_NOISE_VALUE:
-            return _fnlSingleValue2D(seed, x, y);
+            return _fnlSingleValue2D(seed, x, y, period);
         default:
             return 0.f;
     }
 }
 
-float _fnlGenNoiseSingle3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FNLfloat z)
+float _fnlGenNoiseSingle3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period)
 {
     switch (state.noise_type)
     {
@@ -1529,34 +1503,38 @@ float _fnlGenNoiseSingle3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FN
         case FNL_NOISE_OPENSIMPLEX2S:
             return _fnlSingleOpenSimplex2S3D(seed, x, y, z);
         case FNL_NOISE_CELLULAR:
-            return _fnlSingleCellular3D(state, seed, x, y, z);
+            return _fnlSingleCellular3D(state, seed, x, y, z, period);
         case FNL_NOISE_PERLIN:
-            return _fnlSinglePerlin3D(seed, x, y, z);
+            return _fnlSinglePerlin3D(seed, x, y, z, period);
         case FNL_NOISE_VALUE_CUBIC:
-            return _fnlSingleValueCubic3D(seed, x, y, z);
+            return _fnlSingleValueCubic3D(seed, x, y, z, period);
         case FNL_NOISE_VALUE:
-            return _fnlSingleValue3D(seed, x, y, z);
+            return _fnlSingleValue3D(seed, x, y, z, period);
         default:
             return 0.f;
     }
 }
 
 // Fractal FBm
+// Fractal sums and weights are precise here and in the gradient and clamped variants: the compiler may not fuse or
+// reorder their arithmetic, so the octaves of a state sum to the same bits in every shader that evaluates it
 float _fnlGenFractalFBM2D(fnl_state state, FNLfloat x, FNLfloat y)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlGenNoiseSingle2D(state, seed++, x, y);
+        float noise = _fnlGenNoiseSingle2D(state, seed++, x, y, period);
         sum += noise * amp;
         amp *= _fnlLerp(1.f, _fnlFastMin(noise + 1.f, 2.f) * 0.5f, state.weighted_strength);
 
         x *= state.lacunarity;
         y *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1565,12 +1543,13 @@ float _fnlGenFractalFBM2D(fnl_state state, FNLfloat x, FNLfloat y)
 float _fnlGenFractalFBM3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlGenNoiseSingle3D(state, seed++, x, y, z);
+        float noise = _fnlGenNoiseSingle3D(state, seed++, x, y, z, period);
         sum += noise * amp;
         amp *= _fnlLerp(1.f, (noise + 1.f) * 0.5f, state.weighted_strength);
 
@@ -1578,6 +1557,7 @@ float _fnlGenFractalFBM3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
         y *= state.lacunarity;
         z *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1587,18 +1567,20 @@ float _fnlGenFractalFBM3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
 float _fnlGenFractalRidged2D(fnl_state state, FNLfloat x, FNLfloat y)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlFastAbs(_fnlGenNoiseSingle2D(state, seed++, x, y));
+        float noise = _fnlFastAbs(_fnlGenNoiseSingle2D(state, seed++, x, y, period));
         sum += (noise * -2.f + 1.f) * amp;
         amp *= _fnlLerp(1.f, 1.f - noise, state.weighted_strength);
 
         x *= state.lacunarity;
         y *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1607,12 +1589,13 @@ float _fnlGenFractalRidged2D(fnl_state state, FNLfloat x, FNLfloat y)
 float _fnlGenFractalRidged3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlFastAbs(_fnlGenNoiseSingle3D(state, seed++, x, y, z));
+        float noise = _fnlFastAbs(_fnlGenNoiseSingle3D(state, seed++, x, y, z, period));
         sum += (noise * -2.f + 1.f) * amp;
         amp *= _fnlLerp(1.f, 1.f - noise, state.weighted_strength);
 
@@ -1620,6 +1603,7 @@ float _fnlGenFractalRidged3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z
         y *= state.lacunarity;
         z *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1629,18 +1613,20 @@ float _fnlGenFractalRidged3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z
 float _fnlGenFractalPingPong2D(fnl_state state, FNLfloat x, FNLfloat y)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlPingPong((_fnlGenNoiseSingle2D(state, seed++, x, y) + 1.f) * state.ping_pong_strength);
+        float noise = _fnlPingPong((_fnlGenNoiseSingle2D(state, seed++, x, y, period) + 1.f) * state.ping_pong_strength);
         sum += (noise - 0.5f) * 2.f * amp;
         amp *= _fnlLerp(1.f, noise, state.weighted_strength);
 
         x *= state.lacunarity;
         y *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1649,12 +1635,13 @@ float _fnlGenFractalPingPong2D(fnl_state state, FNLfloat x, FNLfloat y)
 float _fnlGenFractalPingPong3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
 {
     int seed = state.seed;
-    float sum = 0.f;
-    float amp = _fnlCalculateFractalBounding(state);
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
 
     for (int i = 0; i < state.octaves; i++)
     {
-        float noise = _fnlPingPong((_fnlGenNoiseSingle3D(state, seed++, x, y, z) + 1.f) * state.ping_pong_strength);
+        float noise = _fnlPingPong((_fnlGenNoiseSingle3D(state, seed++, x, y, z, period) + 1.f) * state.ping_pong_strength);
         sum += (noise - 0.5f) * 2.f * amp;
         amp *= _fnlLerp(1.f, noise, state.weighted_strength);
 
@@ -1662,6 +1649,7 @@ float _fnlGenFractalPingPong3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat
         y *= state.lacunarity;
         z *= state.lacunarity;
         amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
     }
 
     return sum;
@@ -1669,20 +1657,53 @@ float _fnlGenFractalPingPong3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat
 
 
 
-// Domain Warp Simplex/OpenSimplex2
-void _fnlSingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequency, FNLfloat x, FNLfloat y, inout FNLfloat xr, inout FNLfloat yr, bool outGradOnly)
+// Noise With Gradient
+// Each function returns the value of its noise counterpart, computed the same way, together with its gradient
+// over the noise coordinates: Perlin and Value differentiate the interpolation weights, OpenSimplex2 differentiates
+// the falloff of each vertex. Fractals and coordinate transforms apply the chain rule.
+float _fnlInterpHermiteDerivative(float t) { return t * (6.f - t * 6.f); }
+
+float _fnlInterpQuinticDerivative(float t) { return t * t * (t * (t * 30.f - 60.f) + 30.f); }
+
+float _fnlPingPongSlope(float t)
 {
-    const float SQRT3 = 1.7320508075688772935274463415059;
-    const float G2 = (3.f - SQRT3) / 6.f;
+    t -= float(int(t * 0.5f)) * 2.f;
+    return t < 1.f ? 1.f : -1.f;
+}
 
-    x *= frequency;
-    y *= frequency;
+float _fnlGradCoordWithGradient2D(int seed, int xPrimed, int yPrimed, float xd, float yd, out vec2 g)
+{
+    int hash = _fnlHash2D(seed, xPrimed, yPrimed);
+    hash ^= hash >> 15;
+    hash &= 127 << 1;
+    g = vec2(GRADIENTS_2D[hash], GRADIENTS_2D[hash | 1]);
+    return xd * g.x + yd * g.y;
+}
 
-    // --- Skew moved to TransformNoiseCoordinate method ---
-    // const FNLfloat F2 = 0.5f * (SQRT3 - 1);
-    // FNLfloat s = (x + y) * F2;
-    // x += s; y += s;
+float _fnlGradCoordWithGradient3D(int seed, int xPrimed, int yPrimed, int zPrimed, float xd, float yd, float zd, out vec3 g)
+{
+    int hash = _fnlHash3D(seed, xPrimed, yPrimed, zPrimed);
+    hash ^= hash >> 15;
+    hash &= 63 << 2;
+    g = vec3(GRADIENTS_3D[hash], GRADIENTS_3D[hash | 1], GRADIENTS_3D[hash | 2]);
+    return xd * g.x + yd * g.y + zd * g.z;
+}
+
+// Derivative of falloff^4 * (g . d), with falloff = r - |d|^2
+vec2 _fnlFalloffGradient2D(float falloff, float value, vec2 g, vec2 d)
+{
+    return falloff * falloff * falloff * (falloff * g - 8.f * value * d);
+}
+
+vec3 _fnlFalloffGradient3D(float falloff, float value, vec3 g, vec3 d)
+{
+    return falloff * falloff * falloff * (falloff * g - 8.f * value * d);
+}
 
+float _fnlSingleSimplexWithGradient2D(int seed, FNLfloat x, FNLfloat y, out vec2 gradient)
+{
+    const float SQRT3 = 1.7320508075688772935274463415059;
+    const float G2 = (3.f - SQRT3) / 6.f;
 
     int i = _fnlFastFloor(x);
     int j = _fnlFastFloor(y);
@@ -1696,104 +1717,71 @@ void _fnlSingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequenc
     i *= PRIME_X;
     j *= PRIME_Y;
 
-    float vx, vy;
-    vx = vy = 0.f;
+    // Gradient over the vertex offsets, which all move like (x0, y0)
+    vec2 o = vec2(0.f);
+    vec2 g;
+    float n0, n1, n2;
 
     float a = 0.5f - x0 * x0 - y0 * y0;
-    if (a > 0.f)
+    if (a <= 0.f)
     {
-        float aaaa = (a * a) * (a * a);
-        float xo, yo;
-        if (outGradOnly)
-		{
-            _fnlGradCoordOut2D(seed, i, j, xo, yo);
-		}
-        else
-        {
-			_fnlGradCoordDual2D(seed, i, j, x0, y0, xo, yo);
-		}
-        vx += aaaa * xo;
-        vy += aaaa * yo;
+        n0 = 0.f;
+    }
+    else
+    {
+        float v = _fnlGradCoordWithGradient2D(seed, i, j, x0, y0, g);
+        n0 = (a * a) * (a * a) * v;
+        o += _fnlFalloffGradient2D(a, v, g, vec2(x0, y0));
     }
 
     float c = (2.f * (1.f - 2.f * G2) * (1.f / G2 - 2.f)) * t + ((-2.f * (1.f - 2.f * G2) * (1.f - 2.f * G2)) + a);
-    if (c > 0.f)
+    if (c <= 0.f)
+    {
+        n2 = 0.f;
+    }
+    else
     {
         float x2 = x0 + (2.f * G2 - 1.f);
         float y2 = y0 + (2.f * G2 - 1.f);
-        float cccc = (c * c) * (c * c);
-        float xo, yo;
-        if (outGradOnly)
-		{
-            _fnlGradCoordOut2D(seed, i + PRIME_X, j + PRIME_Y, xo, yo);
-		}
-        else
-		{
-            _fnlGradCoordDual2D(seed, i + PRIME_X, j + PRIME_Y, x2, y2, xo, yo);
-		}
-        vx += cccc * xo;
-        vy += cccc * yo;
+        float v = _fnlGradCoordWithGradient2D(seed, i + PRIME_X, j + PRIME_Y, x2, y2, g);
+        n2 = (c * c) * (c * c) * v;
+        o += _fnlFalloffGradient2D(c, v, g, vec2(x2, y2));
     }
 
+    float x1, y1;
+    int i1 = i, j1 = j;
     if (y0 > x0)
     {
-        float x1 = x0 + G2;
-        float y1 = y0 + (G2 - 1.f);
-        float b = 0.5f - x1 * x1 - y1 * y1;
-        if (b > 0.f)
-        {
-            float bbbb = (b * b) * (b * b);
-            float xo, yo;
-            if (outGradOnly)
-			{
-                _fnlGradCoordOut2D(seed, i, j + PRIME_Y, xo, yo);
-			}
-            else
-			{
-                _fnlGradCoordDual2D(seed, i, j + PRIME_Y, x1, y1, xo, yo);
-			}
-            vx += bbbb * xo;
-            vy += bbbb * yo;
-        }
+        x1 = x0 + G2;
+        y1 = y0 + G2 - 1.f;
+        j1 += PRIME_Y;
     }
     else
     {
-        float x1 = x0 + (G2 - 1.f);
-        float y1 = y0 + G2;
-        float b = 0.5f - x1 * x1 - y1 * y1;
-        if (b > 0.f)
-        {
-            float bbbb = (b * b) * (b * b);
-            float xo, yo;
-            if (outGradOnly)
-			{
-                _fnlGradCoordOut2D(seed, i + PRIME_X, j, xo, yo);
-			}
-            else
-            {
-				_fnlGradCoordDual2D(seed, i + PRIME_X, j, x1, y1, xo, yo);
-			}
-            vx += bbbb * xo;
-            vy += bbbb * yo;
-        }
+        x1 = x0 + (G2 - 1.f);
+        y1 = y0 + G2;
+        i1 += PRIME_X;
+    }
+    float b = 0.5f - x1 * x1 - y1 * y1;
+    if (b <= 0.f)
+    {
+        n1 = 0.f;
+    }
+    else
+    {
+        float v = _fnlGradCoordWithGradient2D(seed, i1, j1, x1, y1, g);
+        n1 = (b * b) * (b * b) * v;
+        o += _fnlFalloffGradient2D(b, v, g, vec2(x1, y1));
     }
 
-    xr += vx * warpAmp;
-    yr += vy * warpAmp;
+    // The unskew (x0, y0) = (xi, yi) - (xi + yi) * G2 is symmetric
+    gradient = (o - (o.x + o.y) * G2) * 99.83685446303647;
+
+    return (n0 + n1 + n2) * 99.83685446303647;
 }
 
-void _fnlSingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float frequency, FNLfloat x, FNLfloat y, FNLfloat z, inout FNLfloat xr, inout FNLfloat yr, inout FNLfloat zr, bool outGradOnly)
+float _fnlSingleOpenSimplex2WithGradient3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, out vec3 gradient)
 {
-    x *= frequency;
-    y *= frequency;
-    z *= frequency;
-
-    // --- Rotation moved to TransformDomainWarpCoordinate method ---
-    // const FNLfloat R3 = (FNLfloat)(2.f / 3.f);
-    // FNLfloat r = (x + y + z) * R3; // Rotation, not skew
-    // x = r - x; y = r - y; z = r - z;
-
-
     int i = _fnlFastRound(x);
     int j = _fnlFastRound(y);
     int k = _fnlFastRound(z);
@@ -1801,9 +1789,9 @@ void _fnlSingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float fre
     float y0 = y - float(j);
     float z0 = z - float(k);
 
-    int xNSign = int(-x0 - 1.f) | 1;
-    int yNSign = int(-y0 - 1.f) | 1;
-    int zNSign = int(-z0 - 1.f) | 1;
+    int xNSign = int(-1.f - x0) | 1;
+    int yNSign = int(-1.f - y0) | 1;
+    int zNSign = int(-1.f - z0) | 1;
 
     float ax0 = float(xNSign) * -x0;
     float ay0 = float(yNSign) * -y0;
@@ -1813,15 +1801,713 @@ void _fnlSingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float fre
     j *= PRIME_Y;
     k *= PRIME_Z;
 
-    float vx, vy, vz;
-    vx = vy = vz = 0.f;
-
+    // Every vertex offset moves like (x, y, z), so the gradient over the offsets is the result
+    gradient = vec3(0.f);
+    vec3 g;
+    float value = 0.f;
     float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
-    for (int l = 0; l < 2; l++)
+
+    for (int l = 0; ; l++)
     {
         if (a > 0.f)
         {
-            float aaaa = (a * a) * (a * a);
+            float v = _fnlGradCoordWithGradient3D(seed, i, j, k, x0, y0, z0, g);
+            value += (a * a) * (a * a) * v;
+            gradient += _fnlFalloffGradient3D(a, v, g, vec3(x0, y0, z0));
+        }
+
+        float b = a + 1.f;
+        int i1 = i;
+        int j1 = j;
+        int k1 = k;
+        float x1 = x0;
+        float y1 = y0;
+        float z1 = z0;
+        if (ax0 >= ay0 && ax0 >= az0)
+        {
+            x1 += float(xNSign);
+            b -= float(xNSign) * 2.f * x1;
+            i1 -= xNSign * PRIME_X;
+        }
+        else if (ay0 > ax0 && ay0 >= az0)
+        {
+            y1 += float(yNSign);
+            b -= float(yNSign) * 2.f * y1;
+            j1 -= yNSign * PRIME_Y;
+        }
+        else
+        {
+            z1 += float(zNSign);
+            b -= float(zNSign) * 2.f * z1;
+            k1 -= zNSign * PRIME_Z;
+        }
+
+        if (b > 0.f)
+        {
+            float v = _fnlGradCoordWithGradient3D(seed, i1, j1, k1, x1, y1, z1, g);
+            value += (b * b) * (b * b) * v;
+            gradient += _fnlFalloffGradient3D(b, v, g, vec3(x1, y1, z1));
+        }
+
+        if (l == 1) break;
+
+        ax0 = 0.5f - ax0;
+        ay0 = 0.5f - ay0;
+        az0 = 0.5f - az0;
+
+        x0 = float(xNSign) * ax0;
+        y0 = float(yNSign) * ay0;
+        z0 = float(zNSign) * az0;
+
+        a += (0.75f - ax0) - (ay0 + az0);
+
+        i += (xNSign >> 1) & PRIME_X;
+        j += (yNSign >> 1) & PRIME_Y;
+        k += (zNSign >> 1) & PRIME_Z;
+
+        xNSign = -xNSign;
+        yNSign = -yNSign;
+        zNSign = -zNSign;
+
+        seed = ~seed;
+    }
+
+    gradient *= 32.69428253173828125;
+
+    return value * 32.69428253173828125;
+}
+
+float _fnlSinglePerlinWithGradient2D(int seed, FNLfloat x, FNLfloat y, int period, out vec2 gradient)
+{
+    int x0 = _fnlFastFloor(x);
+    int y0 = _fnlFastFloor(y);
+
+    float xd0 = x - float(x0);
+    float yd0 = y - float(y0);
+    float xd1 = xd0 - 1.f;
+    float yd1 = yd0 - 1.f;
+
+    float xs = _fnlInterpQuintic(xd0);
+    float ys = _fnlInterpQuintic(yd0);
+
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+
+    vec2 g00, g10, g01, g11;
+    float v00 = _fnlGradCoordWithGradient2D(seed, x0, y0, xd0, yd0, g00);
+    float v10 = _fnlGradCoordWithGradient2D(seed, x1, y0, xd1, yd0, g10);
+    float v01 = _fnlGradCoordWithGradient2D(seed, x0, y1, xd0, yd1, g01);
+    float v11 = _fnlGradCoordWithGradient2D(seed, x1, y1, xd1, yd1, g11);
+
+    float xf0 = _fnlLerp(v00, v10, xs);
+    float xf1 = _fnlLerp(v01, v11, xs);
+
+    vec2 slope = vec2(_fnlLerp(v10 - v00, v11 - v01, ys) * _fnlInterpQuinticDerivative(xd0), (xf1 - xf0) * _fnlInterpQuinticDerivative(yd0));
+    gradient = (mix(mix(g00, g10, xs), mix(g01, g11, xs), ys) + slope) * 1.4247691104677813;
+
+    return _fnlLerp(xf0, xf1, ys) * 1.4247691104677813;
+}
+
+float _fnlSinglePerlinWithGradient3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period, out vec3 gradient)
+{
+    int x0 = _fnlFastFloor(x);
+    int y0 = _fnlFastFloor(y);
+    int z0 = _fnlFastFloor(z);
+
+    float xd0 = x - float(x0);
+    float yd0 = y - float(y0);
+    float zd0 = z - float(z0);
+    float xd1 = xd0 - 1.f;
+    float yd1 = yd0 - 1.f;
+    float zd1 = zd0 - 1.f;
+
+    float xs = _fnlInterpQuintic(xd0);
+    float ys = _fnlInterpQuintic(yd0);
+    float zs = _fnlInterpQuintic(zd0);
+
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    int z1 = _fnlPrimeCell(z0 + 1, PRIME_Z, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+    z0 = _fnlPrimeCell(z0, PRIME_Z, period);
+
+    vec3 g000, g100, g010, g110, g001, g101, g011, g111;
+    float v000 = _fnlGradCoordWithGradient3D(seed, x0, y0, z0, xd0, yd0, zd0, g000);
+    float v100 = _fnlGradCoordWithGradient3D(seed, x1, y0, z0, xd1, yd0, zd0, g100);
+    float v010 = _fnlGradCoordWithGradient3D(seed, x0, y1, z0, xd0, yd1, zd0, g010);
+    float v110 = _fnlGradCoordWithGradient3D(seed, x1, y1, z0, xd1, yd1, zd0, g110);
+    float v001 = _fnlGradCoordWithGradient3D(seed, x0, y0, z1, xd0, yd0, zd1, g001);
+    float v101 = _fnlGradCoordWithGradient3D(seed, x1, y0, z1, xd1, yd0, zd1, g101);
+    float v011 = _fnlGradCoordWithGradient3D(seed, x0, y1, z1, xd0, yd1, zd1, g011);
+    float v111 = _fnlGradCoordWithGradient3D(seed, x1, y1, z1, xd1, yd1, zd1, g111);
+
+    float xf00 = _fnlLerp(v000, v100, xs);
+    float xf10 = _fnlLerp(v010, v110, xs);
+    float xf01 = _fnlLerp(v001, v101, xs);
+    float xf11 = _fnlLerp(v011, v111, xs);
+
+    float yf0 = _fnlLerp(xf00, xf10, ys);
+    float yf1 = _fnlLerp(xf01, xf11, ys);
+
+    vec3 corners = mix(mix(mix(g000, g100, xs), mix(g010, g110, xs), ys), mix(mix(g001, g101, xs), mix(g011, g111, xs), ys), zs);
+    float xSlope = _fnlLerp(_fnlLerp(v100 - v000, v110 - v010, ys), _fnlLerp(v101 - v001, v111 - v011, ys), zs);
+    vec3 slope = vec3(xSlope * _fnlInterpQuinticDerivative(xd0),
+        _fnlLerp(xf10 - xf00, xf11 - xf01, zs) * _fnlInterpQuinticDerivative(yd0),
+        (yf1 - yf0) * _fnlInterpQuinticDerivative(zd0));
+    gradient = (corners + slope) * 0.964921414852142333984375;
+
+    return _fnlLerp(yf0, yf1, zs) * 0.964921414852142333984375;
+}
+
+float _fnlSingleValueWithGradient2D(int seed, FNLfloat x, FNLfloat y, int period, out vec2 gradient)
+{
+    int x0 = _fnlFastFloor(x);
+    int y0 = _fnlFastFloor(y);
+
+    float xd = x - float(x0);
+    float yd = y - float(y0);
+    float xs = _fnlInterpHermite(xd);
+    float ys = _fnlInterpHermite(yd);
+
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+
+    float v00 = _fnlValCoord2D(seed, x0, y0);
+    float v10 = _fnlValCoord2D(seed, x1, y0);
+    float v01 = _fnlValCoord2D(seed, x0, y1);
+    float v11 = _fnlValCoord2D(seed, x1, y1);
+
+    float xf0 = _fnlLerp(v00, v10, xs);
+    float xf1 = _fnlLerp(v01, v11, xs);
+
+    gradient = vec2(_fnlLerp(v10 - v00, v11 - v01, ys) * _fnlInterpHermiteDerivative(xd), (xf1 - xf0) * _fnlInterpHermiteDerivative(yd));
+
+    return _fnlLerp(xf0, xf1, ys);
+}
+
+float _fnlSingleValueWithGradient3D(int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period, out vec3 gradient)
+{
+    int x0 = _fnlFastFloor(x);
+    int y0 = _fnlFastFloor(y);
+    int z0 = _fnlFastFloor(z);
+
+    float xd = x - float(x0);
+    float yd = y - float(y0);
+    float zd = z - float(z0);
+    float xs = _fnlInterpHermite(xd);
+    float ys = _fnlInterpHermite(yd);
+    float zs = _fnlInterpHermite(zd);
+
+    int x1 = _fnlPrimeCell(x0 + 1, PRIME_X, period);
+    int y1 = _fnlPrimeCell(y0 + 1, PRIME_Y, period);
+    int z1 = _fnlPrimeCell(z0 + 1, PRIME_Z, period);
+    x0 = _fnlPrimeCell(x0, PRIME_X, period);
+    y0 = _fnlPrimeCell(y0, PRIME_Y, period);
+    z0 = _fnlPrimeCell(z0, PRIME_Z, period);
+
+    float v000 = _fnlValCoord3D(seed, x0, y0, z0);
+    float v100 = _fnlValCoord3D(seed, x1, y0, z0);
+    float v010 = _fnlValCoord3D(seed, x0, y1, z0);
+    float v110 = _fnlValCoord3D(seed, x1, y1, z0);
+    float v001 = _fnlValCoord3D(seed, x0, y0, z1);
+    float v101 = _fnlValCoord3D(seed, x1, y0, z1);
+    float v011 = _fnlValCoord3D(seed, x0, y1, z1);
+    float v111 = _fnlValCoord3D(seed, x1, y1, z1);
+
+    float xf00 = _fnlLerp(v000, v100, xs);
+    float xf10 = _fnlLerp(v010, v110, xs);
+    float xf01 = _fnlLerp(v001, v101, xs);
+    float xf11 = _fnlLerp(v011, v111, xs);
+
+    float yf0 = _fnlLerp(xf00, xf10, ys);
+    float yf1 = _fnlLerp(xf01, xf11, ys);
+
+    float xSlope = _fnlLerp(_fnlLerp(v100 - v000, v110 - v010, ys), _fnlLerp(v101 - v001, v111 - v011, ys), zs);
+    gradient = vec3(xSlope * _fnlInterpHermiteDerivative(xd),
+        _fnlLerp(xf10 - xf00, xf11 - xf01, zs) * _fnlInterpHermiteDerivative(yd),
+        (yf1 - yf0) * _fnlInterpHermiteDerivative(zd));
+
+    return _fnlLerp(yf0, yf1, zs);
+}
+
+bool _fnlGradientSupported(fnl_state state)
+{
+    return state.noise_type == FNL_NOISE_OPENSIMPLEX2 || state.noise_type == FNL_NOISE_PERLIN || state.noise_type == FNL_NOISE_VALUE;
+}
+
+float _fnlGenNoiseSingleWithGradient2D(fnl_state state, int seed, FNLfloat x, FNLfloat y, int period, out vec2 gradient)
+{
+    switch (state.noise_type)
+    {
+        case FNL_NOISE_OPENSIMPLEX2:
+            return _fnlSingleSimplexWithGradient2D(seed, x, y, gradient);
+        case FNL_NOISE_PERLIN:
+            return _fnlSinglePerlinWithGradient2D(seed, x, y, period, gradient);
+        default:
+            return _fnlSingleValueWithGradient2D(seed, x, y, period, gradient);
+    }
+}
+
+float _fnlGenNoiseSingleWithGradient3D(fnl_state state, int seed, FNLfloat x, FNLfloat y, FNLfloat z, int period, out vec3 gradient)
+{
+    switch (state.noise_type)
+    {
+        case FNL_NOISE_OPENSIMPLEX2:
+            return _fnlSingleOpenSimplex2WithGradient3D(seed, x, y, z, gradient);
+        case FNL_NOISE_PERLIN:
+            return _fnlSinglePerlinWithGradient3D(seed, x, y, z, period, gradient);
+        default:
+            return _fnlSingleValueWithGradient3D(seed, x, y, z, period, gradient);
+    }
+}
+
+// One octave of the FBm, Ridged or PingPong fractal, also carrying the gradients of the sum and of the amplitude,
+// which depends on earlier octaves through the weighted strength. 2D gradients leave z at 0
+void _fnlAddOctaveWithGradient(fnl_state state, bool is2D, float noise, vec3 noiseGrad, inout float sum, inout vec3 sumGrad, inout float amp, inout vec3 ampGrad)
+{
+    float weight, weightSlope;
+
+    switch (state.fractal_type)
+    {
+        default:
+            sumGrad += noiseGrad * amp + noise * ampGrad;
+            sum += noise * amp;
+            weight = _fnlLerp(1.f, (is2D ? _fnlFastMin(noise + 1.f, 2.f) : noise + 1.f) * 0.5f, state.weighted_strength);
+            weightSlope = is2D && noise > 1.f ? 0.f : 0.5f * state.weighted_strength;
+            break;
+        case FNL_FRACTAL_RIDGED:
+            noiseGrad *= noise < 0.f ? -1.f : 1.f;
+            noise = _fnlFastAbs(noise);
+            sumGrad += noiseGrad * -2.f * amp + (noise * -2.f + 1.f) * ampGrad;
+            sum += (noise * -2.f + 1.f) * amp;
+            weight = _fnlLerp(1.f, 1.f - noise, state.weighted_strength);
+            weightSlope = -state.weighted_strength;
+            break;
+        case FNL_FRACTAL_PINGPONG:
+        {
+            float t = (noise + 1.f) * state.ping_pong_strength;
+            noiseGrad *= _fnlPingPongSlope(t) * state.ping_pong_strength;
+            noise = _fnlPingPong(t);
+            sumGrad += noiseGrad * 2.f * amp + (noise - 0.5f) * 2.f * ampGrad;
+            sum += (noise - 0.5f) * 2.f * amp;
+            weight = _fnlLerp(1.f, noise, state.weighted_strength);
+            weightSlope = state.weighted_strength;
+        }
+        break;
+    }
+
+    ampGrad = (ampGrad * weight + amp * weightSlope * noiseGrad) * state.gain;
+    amp *= weight;
+    amp *= state.gain;
+}
+
+float _fnlGenFractalWithGradient2D(fnl_state state, FNLfloat x, FNLfloat y, out vec2 gradient)
+{
+    if (state.fractal_type != FNL_FRACTAL_FBM && state.fractal_type != FNL_FRACTAL_RIDGED && state.fractal_type != FNL_FRACTAL_PINGPONG)
+    {
+        precise float value = _fnlGenNoiseSingleWithGradient2D(state, state.seed, x, y, state.period, gradient);
+        return value;
+    }
+
+    int seed = state.seed;
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
+    float frequency = 1.f;
+    vec3 sumGrad = vec3(0.f);
+    vec3 ampGrad = vec3(0.f);
+
+    for (int i = 0; i < state.octaves; i++)
+    {
+        vec2 noiseGrad;
+        float noise = _fnlGenNoiseSingleWithGradient2D(state, seed++, x, y, period, noiseGrad);
+        _fnlAddOctaveWithGradient(state, true, noise, vec3(noiseGrad * frequency, 0.f), sum, sumGrad, amp, ampGrad);
+
+        x *= state.lacunarity;
+        y *= state.lacunarity;
+        frequency *= state.lacunarity;
+        period = _fnlNextOctavePeriod(state, period);
+    }
+
+    gradient = sumGrad.xy;
+    return sum;
+}
+
+float _fnlGenFractalWithGradient3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z, out vec3 gradient)
+{
+    if (state.fractal_type != FNL_FRACTAL_FBM && state.fractal_type != FNL_FRACTAL_RIDGED && state.fractal_type != FNL_FRACTAL_PINGPONG)
+    {
+        precise float value = _fnlGenNoiseSingleWithGradient3D(state, state.seed, x, y, z, state.period, gradient);
+        return value;
+    }
+
+    int seed = state.seed;
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
+    float frequency = 1.f;
+    gradient = vec3(0.f);
+    vec3 ampGrad = vec3(0.f);
+
+    for (int i = 0; i < state.octaves; i++)
+    {
+        vec3 noiseGrad;
+        float noise = _fnlGenNoiseSingleWithGradient3D(state, seed++, x, y, z, period, noiseGrad);
+        _fnlAddOctaveWithGradient(state, false, noise, noiseGrad * frequency, sum, gradient, amp, ampGrad);
+
+        x *= state.lacunarity;
+        y *= state.lacunarity;
+        z *= state.lacunarity;
+        frequency *= state.lacunarity;
+        period = _fnlNextOctavePeriod(state, period);
+    }
+
+    return sum;
+}
+
+// Transpose of _fnlTransformNoiseCoordinate2D: turns a gradient over noise coordinates into one over input coordinates
+vec2 _fnlTransformNoiseGradient2D(fnl_state state, vec2 gradient)
+{
+    switch (state.noise_type)
+    {
+        case FNL_NOISE_OPENSIMPLEX2:
+        case FNL_NOISE_OPENSIMPLEX2S:
+        {
+            // The skew is symmetric
+            const float SQRT3 = 1.7320508075688772935274463415059;
+            const float F2 = 0.5f * (SQRT3 - 1.f);
+            gradient += (gradient.x + gradient.y) * F2;
+        }
+        break;
+        default:
+            break;
+    }
+
+    return gradient * state.frequency;
+}
+
+vec3 _fnlTransformNoiseGradient3D(fnl_state state, vec3 gradient)
+{
+    switch (state.rotation_type_3d)
+    {
+        case FNL_ROTATION_IMPROVE_XY_PLANES:
+        {
+            float s2 = (gradient.x + gradient.y) * -0.211324865405187f;
+            float zs = gradient.z * 0.577350269189626f;
+            gradient = vec3(gradient.x + s2 + zs, gradient.y + s2 + zs, (gradient.z - gradient.x - gradient.y) * 0.577350269189626f);
+        }
+        break;
+        case FNL_ROTATION_IMPROVE_XZ_PLANES:
+        {
+            float s2 = (gradient.x + gradient.z) * -0.211324865405187f;
+            float ys = gradient.y * 0.577350269189626f;
+            gradient = vec3(gradient.x + s2 + ys, (gradient.y - gradient.x - gradient.z) * 0.577350269189626f, gradient.z + s2 + ys);
+        }
+        break;
+        default:
+            switch (state.noise_type)
+            {
+            case FNL_NOISE_OPENSIMPLEX2:
+            case FNL_NOISE_OPENSIMPLEX2S:
+            {
+                // The rotation is symmetric
+                const float R3 = 2.f / 3.f;
+                gradient = (gradient.x + gradient.y + gradient.z) * R3 - gradient;
+            }
+            break;
+            default:
+                break;
+            }
+            break;
+    }
+
+    return gradient * state.frequency;
+}
+
+
+
+// Octave Culling
+// The culled fractals add the same terms as the fractals above in the same order. Every octave adds at most its
+// amplitude once the single noise is within [-1, 1], and the weighting scales the amplitude by at most
+// max(1, |1 - weighted strength|) per octave, which bounds what the octaves left can still add.
+bool _fnlOctaveCullingSupported(fnl_state state)
+{
+    if (state.fractal_type != FNL_FRACTAL_FBM && state.fractal_type != FNL_FRACTAL_RIDGED && state.fractal_type != FNL_FRACTAL_PINGPONG)
+    {
+        return false;
+    }
+    return state.noise_type != FNL_NOISE_CELLULAR || state.cellular_return_type == FNL_CELLULAR_RETURN_TYPE_CELLVALUE;
+}
+
+float _fnlClampNoise(float value, float lo, float hi)
+{
+    return value < lo ? lo : (hi < value ? hi : value);
+}
+
+// Bound on the sum of the last remaining octaves per unit of the next octave's amplitude,
+// with some headroom for single noise that rounds slightly past 1
+float _fnlRemainingOctavesBound(fnl_state state, int remaining)
+{
+    float octaveScale = _fnlFastMax(1.f, _fnlFastAbs(1.f - state.weighted_strength)) * _fnlFastAbs(state.gain);
+    float bound = 0.f;
+    for (int i = 0; i < remaining; i++)
+    {
+        bound = bound * octaveScale + 1.f;
+    }
+    return bound * 1.001f;
+}
+
+// Term one octave adds to the fractal sum, amp receives the weighting for the next octave
+float _fnlFractalOctave(fnl_state state, bool is2D, float noise, inout float amp)
+{
+    float value;
+    switch (state.fractal_type)
+    {
+        case FNL_FRACTAL_RIDGED:
+            noise = _fnlFastAbs(noise);
+            value = (noise * -2.f + 1.f) * amp;
+            amp *= _fnlLerp(1.f, 1.f - noise, state.weighted_strength);
+            break;
+        case FNL_FRACTAL_PINGPONG:
+            noise = _fnlPingPong((noise + 1.f) * state.ping_pong_strength);
+            value = (noise - 0.5f) * 2.f * amp;
+            amp *= _fnlLerp(1.f, noise, state.weighted_strength);
+            break;
+        default:
+            value = noise * amp;
+            amp *= _fnlLerp(1.f, (is2D ? _fnlFastMin(noise + 1.f, 2.f) : noise + 1.f) * 0.5f, state.weighted_strength);
+            break;
+    }
+    return value;
+}
+
+// True with value lo or hi once the sum so far is further outside [lo, hi] than the octaves left
+// (and the rounding of their additions) can reach
+bool _fnlCullOctaves(fnl_state state, float sum, float amp, int remaining, float lo, float hi, out float value)
+{
+    float reach = _fnlFastAbs(amp) * _fnlRemainingOctavesBound(state, remaining) + 1e-6f;
+    if (sum - reach >= hi)
+    {
+        value = hi;
+        return true;
+    }
+    value = lo;
+    return sum + reach <= lo;
+}
+
+float _fnlGenFractalClamped2D(fnl_state state, FNLfloat x, FNLfloat y, float lo, float hi)
+{
+    int seed = state.seed;
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
+
+    for (int i = 0; i < state.octaves; i++)
+    {
+        sum += _fnlFractalOctave(state, true, _fnlGenNoiseSingle2D(state, seed++, x, y, period), amp);
+
+        x *= state.lacunarity;
+        y *= state.lacunarity;
+        amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
+
+        float culled;
+        if (i + 1 < state.octaves && _fnlCullOctaves(state, sum, amp, state.octaves - 1 - i, lo, hi, culled))
+        {
+            return culled;
+        }
+    }
+
+    return _fnlClampNoise(sum, lo, hi);
+}
+
+float _fnlGenFractalClamped3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z, float lo, float hi)
+{
+    int seed = state.seed;
+    int period = state.period;
+    precise float sum = 0.f;
+    precise float amp = _fnlCalculateFractalBounding(state);
+
+    for (int i = 0; i < state.octaves; i++)
+    {
+        sum += _fnlFractalOctave(state, false, _fnlGenNoiseSingle3D(state, seed++, x, y, z, period), amp);
+
+        x *= state.lacunarity;
+        y *= state.lacunarity;
+        z *= state.lacunarity;
+        amp *= state.gain;
+        period = _fnlNextOctavePeriod(state, period);
+
+        float culled;
+        if (i + 1 < state.octaves && _fnlCullOctaves(state, sum, amp, state.octaves - 1 - i, lo, hi, culled))
+        {
+            return culled;
+        }
+    }
+
+    return _fnlClampNoise(sum, lo, hi);
+}
+
+
+
+// Domain Warp Simplex/OpenSimplex2
+void _fnlSingleDomainWarpSimplexGradient(int seed, float warpAmp, float frequency, FNLfloat x, FNLfloat y, inout FNLfloat xr, inout FNLfloat yr, bool outGradOnly)
+{
+    const float SQRT3 = 1.7320508075688772935274463415059;
+    const float G2 = (3.f - SQRT3) / 6.f;
+
+    x *= frequency;
+    y *= frequency;
+
+    // --- Skew moved to TransformNoiseCoordinate method ---
+    // const FNLfloat F2 = 0.5f * (SQRT3 - 1);
+    // FNLfloat s = (x + y) * F2;
+    // x += s; y += s;
+
+
+    int i = _fnlFastFloor(x);
+    int j = _fnlFastFloor(y);
+    float xi = x - float(i);
+    float yi = y - float(j);
+
+    float t = (xi + yi) * G2;
+    float x0 = xi - t;
+    float y0 = yi - t;
+
+    i *= PRIME_X;
+    j *= PRIME_Y;
+
+    float vx, vy;
+    vx = vy = 0.f;
+
+    float a = 0.5f - x0 * x0 - y0 * y0;
+    if (a > 0.f)
+    {
+        float aaaa = (a * a) * (a * a);
+        float xo, yo;
+        if (outGradOnly)
+		{
+            _fnlGradCoordOut2D(seed, i, j, xo, yo);
+		}
+        else
+        {
+			_fnlGradCoordDual2D(seed, i, j, x0, y0, xo, yo);
+		}
+        vx += aaaa * xo;
+        vy += aaaa * yo;
+    }
+
+    float c = (2.f * (1.f - 2.f * G2) * (1.f / G2 - 2.f)) * t + ((-2.f * (1.f - 2.f * G2) * (1.f - 2.f * G2)) + a);
+    if (c > 0.f)
+    {
+        float x2 = x0 + (2.f * G2 - 1.f);
+        float y2 = y0 + (2.f * G2 - 1.f);
+        float cccc = (c * c) * (c * c);
+        float xo, yo;
+        if (outGradOnly)
+		{
+            _fnlGradCoordOut2D(seed, i + PRIME_X, j + PRIME_Y, xo, yo);
+		}
+        else
+		{
+            _fnlGradCoordDual2D(seed, i + PRIME_X, j + PRIME_Y, x2, y2, xo, yo);
+		}
+        vx += cccc * xo;
+        vy += cccc * yo;
+    }
+
+    if (y0 > x0)
+    {
+        float x1 = x0 + G2;
+        float y1 = y0 + (G2 - 1.f);
+        float b = 0.5f - x1 * x1 - y1 * y1;
+        if (b > 0.f)
+        {
+            float bbbb = (b * b) * (b * b);
+            float xo, yo;
+            if (outGradOnly)
+			{
+                _fnlGradCoordOut2D(seed, i, j + PRIME_Y, xo, yo);
+			}
+            else
+			{
+                _fnlGradCoordDual2D(seed, i, j + PRIME_Y, x1, y1, xo, yo);
+			}
+            vx += bbbb * xo;
+            vy += bbbb * yo;
+        }
+    }
+    else
+    {
+        float x1 = x0 + (G2 - 1.f);
+        float y1 = y0 + G2;
+        float b = 0.5f - x1 * x1 - y1 * y1;
+        if (b > 0.f)
+        {
+            float bbbb = (b * b) * (b * b);
+            float xo, yo;
+            if (outGradOnly)
+			{
+                _fnlGradCoordOut2D(seed, i + PRIME_X, j, xo, yo);
+			}
+            else
+            {
+				_fnlGradCoordDual2D(seed, i + PRIME_X, j, x1, y1, xo, yo);
+			}
+            vx += bbbb * xo;
+            vy += bbbb * yo;
+        }
+    }
+
+    xr += vx * warpAmp;
+    yr += vy * warpAmp;
+}
+
+void _fnlSingleDomainWarpOpenSimplex2Gradient(int seed, float warpAmp, float frequency, FNLfloat x, FNLfloat y, FNLfloat z, inout FNLfloat xr, inout FNLfloat yr, inout FNLfloat zr, bool outGradOnly)
+{
+    x *= frequency;
+    y *= frequency;
+    z *= frequency;
+
+    // --- Rotation moved to TransformDomainWarpCoordinate method ---
+    // const FNLfloat R3 = (FNLfloat)(2.f / 3.f);
+    // FNLfloat r = (x + y + z) * R3; // Rotation, not skew
+    // x = r - x; y = r - y; z = r - z;
+
+
+    int i = _fnlFastRound(x);
+    int j = _fnlFastRound(y);
+    int k = _fnlFastRound(z);
+    float x0 = x - float(i);
+    float y0 = y - float(j);
+    float z0 = z - float(k);
+
+    int xNSign = int(-x0 - 1.f) | 1;
+    int yNSign = int(-y0 - 1.f) | 1;
+    int zNSign = int(-z0 - 1.f) | 1;
+
+    float ax0 = float(xNSign) * -x0;
+    float ay0 = float(yNSign) * -y0;
+    float az0 = float(zNSign) * -z0;
+
+    i *= PRIME_X;
+    j *= PRIME_Y;
+    k *= PRIME_Z;
+
+    float vx, vy, vz;
+    vx = vy = vz = 0.f;
+
+    float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+    for (int l = 0; l < 2; l++)
+    {
+        if (a > 0.f)
+        {
+            float aaaa = (a * a) * (a * a);
             float xo, yo, zo;
             if (outGradOnly)
 			{
@@ -2154,6 +2840,7 @@ fnl_state fnlCreateState(int seed)
     fnl_state newState;
     newState.seed = seed;
     newState.frequency = 0.01f;
+    newState.period = 0;
     newState.noise_type = FNL_NOISE_OPENSIMPLEX2;
     newState.rotation_type_3d = FNL_ROTATION_NONE;
     newState.fractal_type = FNL_FRACTAL_NONE;
@@ -2179,7 +2866,11 @@ float fnlGetNoise2D(fnl_state state, FNLfloat x, FNLfloat y)
     switch (state.fractal_type)
     {
         default:
-            return _fnlGenNoiseSingle2D(state, state.seed, x, y);
+        {
+            // precise like the fractal sums, so fnlGetNoiseWithGradient2D returns the same bits
+            precise float value = _fnlGenNoiseSingle2D(state, state.seed, x, y, state.period);
+            return value;
+        }
         case FNL_FRACTAL_FBM:
             return _fnlGenFractalFBM2D(state, x, y);
         case FNL_FRACTAL_RIDGED:
@@ -2199,7 +2890,11 @@ float fnlGetNoise3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
     switch (state.fractal_type)
     {
         default:
-            return _fnlGenNoiseSingle3D(state, state.seed, x, y, z);
+        {
+            // precise like the fractal sums, so fnlGetNoiseWithGradient3D returns the same bits
+            precise float value = _fnlGenNoiseSingle3D(state, state.seed, x, y, z, state.period);
+            return value;
+        }
         case FNL_FRACTAL_FBM:
             return _fnlGenFractalFBM3D(state, x, y, z);
         case FNL_FRACTAL_RIDGED:
@@ -2209,6 +2904,80 @@ float fnlGetNoise3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z)
     }
 }
 
+// 2D noise and its gradient at given position using the state settings
+// @remark gradient receives the derivative of the noise along x and y, per unit of input coordinate.
+// Perlin, Value and OpenSimplex2 noise are differentiated analytically in the same pass, other noise types use central differences.
+// @returns Noise output bounded between -1 and 1, the value of fnlGetNoise2D.
+float fnlGetNoiseWithGradient2D(fnl_state state, FNLfloat x, FNLfloat y, out vec2 gradient)
+{
+    if (!_fnlGradientSupported(state))
+    {
+        // A thousandth of a noise cell
+        FNLfloat h = 0.001f / state.frequency;
+        gradient = vec2(fnlGetNoise2D(state, x + h, y) - fnlGetNoise2D(state, x - h, y),
+            fnlGetNoise2D(state, x, y + h) - fnlGetNoise2D(state, x, y - h)) / (2.f * h);
+        return fnlGetNoise2D(state, x, y);
+    }
+
+    _fnlTransformNoiseCoordinate2D(state, x, y);
+    float value = _fnlGenFractalWithGradient2D(state, x, y, gradient);
+    gradient = _fnlTransformNoiseGradient2D(state, gradient);
+    return value;
+}
+
+// 3D noise and its gradient at given position using the state settings
+// @remark gradient receives the derivative of the noise along x, y and z, per unit of input coordinate.
+// Perlin, Value and OpenSimplex2 noise are differentiated analytically in the same pass, other noise types use central differences.
+// @returns Noise output bounded between -1 and 1, the value of fnlGetNoise3D.
+float fnlGetNoiseWithGradient3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z, out vec3 gradient)
+{
+    if (!_fnlGradientSupported(state))
+    {
+        FNLfloat h = 0.001f / state.frequency;
+        gradient = vec3(fnlGetNoise3D(state, x + h, y, z) - fnlGetNoise3D(state, x - h, y, z),
+            fnlGetNoise3D(state, x, y + h, z) - fnlGetNoise3D(state, x, y - h, z),
+            fnlGetNoise3D(state, x, y, z + h) - fnlGetNoise3D(state, x, y, z - h)) / (2.f * h);
+        return fnlGetNoise3D(state, x, y, z);
+    }
+
+    _fnlTransformNoiseCoordinate3D(state, x, y, z);
+    float value = _fnlGenFractalWithGradient3D(state, x, y, z, gradient);
+    gradient = _fnlTransformNoiseGradient3D(state, gradient);
+    return value;
+}
+
+// 2D noise at given position using the state settings, clamped to [lo, hi]
+// @remark FBm, Ridged and PingPong fractals stop adding octaves once the octaves left can no longer bring the sum
+// back into the interval, so samples that saturate skip their fine octaves.
+// Cellular noise only culls with FNL_CELLULAR_RETURN_TYPE_CELLVALUE, the distance returns are not bounded by 1.
+// @returns clamp(fnlGetNoise2D(state, x, y), lo, hi)
+float fnlGetNoiseClamped2D(fnl_state state, FNLfloat x, FNLfloat y, float lo, float hi)
+{
+    if (!_fnlOctaveCullingSupported(state))
+    {
+        return _fnlClampNoise(fnlGetNoise2D(state, x, y), lo, hi);
+    }
+
+    _fnlTransformNoiseCoordinate2D(state, x, y);
+    return _fnlGenFractalClamped2D(state, x, y, lo, hi);
+}
+
+// 3D noise at given position using the state settings, clamped to [lo, hi]
+// @remark FBm, Ridged and PingPong fractals stop adding octaves once the octaves left can no longer bring the sum
+// back into the interval, so samples that saturate skip their fine octaves.
+// Cellular noise only culls with FNL_CELLULAR_RETURN_TYPE_CELLVALUE, the distance returns are not bounded by 1.
+// @returns clamp(fnlGetNoise3D(state, x, y, z), lo, hi)
+float fnlGetNoiseClamped3D(fnl_state state, FNLfloat x, FNLfloat y, FNLfloat z, float lo, float hi)
+{
+    if (!_fnlOctaveCullingSupported(state))
+    {
+        return _fnlClampNoise(fnlGetNoise3D(state, x, y, z), lo, hi);
+    }
+
+    _fnlTransformNoiseCoordinate3D(state, x, y, z);
+    return _fnlGenFractalClamped3D(state, x, y, z, lo, hi);
+}
+
 // 2D warps the input position using current domain warp settings.
 // 
 // Example usage with fnlGetNoise2D:
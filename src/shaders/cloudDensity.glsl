@@ -0,0 +1,100 @@
+//The density of the cloud layer, shared by cloudsFrag3.frag and cloudSunDepthGen.comp so the sun depth the compute
+//shader bakes is the one the raymarcher would march. The shader places it with
+//    #include CloudDensity
+//after declaring the samplers weatherMap, shapeNoise and detailNoise and the uniforms detailScale and detailEdgeShape,
+//and calls setUpDetailNoise before the first cloudDensity. COUNT_DENSITY_SAMPLES counts the samples into the atomic
+//counters bench/cloud_bench.cpp declares in cloudsFrag3.frag
+
+//the cloud layer and the steps toward the sun
+const float cloudMinHeight = 400.0;
+const float cloudMaxHeight = 1000.0;
+const int sunSteps = 8;
+const float sunStepLength = ((cloudMaxHeight - cloudMinHeight) * 0.5) / float(sunSteps);
+const vec3 sunDir = normalize(vec3(1.0, 0.5, 0.0));
+
+float remap(float val, float l0, float h0, float ln, float hn) {
+    return ln + ((val - l0) * (hn - ln)) / (h0 - l0);
+}
+
+float cloudBottomShape(float ph) {
+    return clamp(remap(ph, 0.0, 0.07, 0.0, 1.0), 0.0, 1.0);
+}
+
+float cloudTopShape(float ph, float wh) {
+    wh = clamp(wh + 0.12, 0.0, 1.0);
+    return clamp(remap(ph, wh * 0.2, wh, 1.0, 0.0), 0.0, 1.0);
+}
+
+float cloudShapeAlter(float ph, float wh) {
+    return cloudBottomShape(ph) * cloudTopShape(ph, wh);
+}
+
+float cloudBottomDensity(float ph) {
+    return clamp(remap(ph, 0, 0.2, 0, 1), 0.0, 1.0);
+}
+
+float cloudTopDensity(float ph) {
+    return clamp(remap(ph, 0.9, 1.0, 1.0, 0.0), 0.0, 1.0);
+}
+
+float cloudDensityAlter(float ph, float gd, float wd) {
+    return gd * cloudBottomDensity(ph) * cloudTopDensity(ph) * wd * 2.0;
+}
+
+float sampleShapeNoise(vec3 coords, float mipmapLevel) {
+    vec4 SNsample = textureLod(shapeNoise, coords / 1755.62, mipmapLevel);
+    return remap(SNsample.r, dot(SNsample.gba, vec3(0.625, 0.25, 0.125)) - 1.0, 1.0, 0.0, 1.0);
+}
+
+float detailErosion(vec4 DNsample, float gc, float ph) {
+    float dn = dot(DNsample.rgb, vec3(0.625, 0.25, 0.125));
+    return 0.35 * exp(-gc * 0.75) * mix(dn, 1 - dn, clamp(ph * 5.0, 0.0, 1.0));
+}
+
+float sampleDetailNoise(vec3 coords, float mipmapLevel, float gc, float ph) {
+    return detailErosion(textureLod(detailNoise, coords / detailScale, mipmapLevel), gc, ph);
+}
+
+float detailTexelSize; //in units
+float coarsestDetailLevel;
+vec4 detailNoiseMean; //its coarsest level, a single texel
+
+//sets detailTexelSize, coarsestDetailLevel and detailNoiseMean from the texture bound to detailNoise
+void setUpDetailNoise() {
+    detailTexelSize = detailScale / float(textureSize(detailNoise, 0).x);
+    coarsestDetailLevel = float(textureQueryLevels(detailNoise) - 1);
+    detailNoiseMean = textureLod(detailNoise, vec3(0.5), coarsestDetailLevel);
+}
+
+//footprint is the width in units a sample stands for, along the ray or across a pixel, and picks the mip level of the
+//detail noise. The shape noise and the weather map stay at their base levels, the occupancy maps bound those
+float cloudDensity(vec3 coords, float footprint, float gc, float gd, float cloudMinHeight, float cloudMaxHeight) {
+#ifdef COUNT_DENSITY_SAMPLES
+    atomicCounterIncrement(densitySamples);
+#endif
+    vec4 weatherMapSampleVal = textureLod(weatherMap, coords.xz / 50000.0, 0.0);
+    float coverage = max(weatherMapSampleVal.r, clamp(gc - 0.5, 0.0, 1.0) * weatherMapSampleVal.g * 2);
+    float wh = weatherMapSampleVal.b;
+    float wd = weatherMapSampleVal.a;
+    float ph = clamp((coords.y - cloudMinHeight) / (cloudMaxHeight - cloudMinHeight), 0.0, 1.0); //percentage of ray height between cloud height bounds
+    //CHEAP FIRST, NO NOISE WHERE THE HEIGHT PROFILES OR THE WEATHER MAP LEAVE NO DENSITY AND NO DETAIL WHERE THE SHAPE DOESN'T
+    float densityAlter = cloudDensityAlter(ph, gd, wd);
+    float shapeAlter = cloudShapeAlter(ph, wh);
+    if (densityAlter <= 0.0 || shapeAlter <= 0.0) return 0.0;
+#ifdef COUNT_DENSITY_SAMPLES
+    atomicCounterIncrement(shapeNoiseSamples);
+#endif
+    float sn = clamp(remap(sampleShapeNoise(coords, 0.0) * shapeAlter, 1 - gc * coverage, 1.0, 0.0, 1.0), 0.0, 1.0);
+    if (sn <= 0.0) return 0.0;
+    float detailLevel = log2(max(footprint, 1e-6) / detailTexelSize);
+    float erosion;
+    if (sn <= detailEdgeShape && detailLevel < coarsestDetailLevel) {
+#ifdef COUNT_DENSITY_SAMPLES
+        atomicCounterIncrement(detailNoiseSamples);
+#endif
+        erosion = sampleDetailNoise(coords, max(detailLevel, 0.0), gc, ph);
+    } else {
+        erosion = detailErosion(detailNoiseMean, gc, ph);
+    }
+    return clamp(remap(sn, erosion, 1.0, 0.0, 1.0), 0.0, 1.0) * densityAlter;
+}
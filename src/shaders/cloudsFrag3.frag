@@ -10,11 +10,27 @@ uniform sampler2D weatherMap;
 uniform sampler3D shapeNoise;
 uniform sampler3D detailNoise;
 uniform sampler2D blueNoise;
+uniform sampler3D shapeBounds; //occupancy maps, see src/cloud_maps.h
+uniform sampler2DArray coverageBounds;
+uniform sampler3D sunOpticalDepth; //see src/sun_depth_volume.h
 
 uniform float b;
 uniform float exposure;
 uniform float detailScale;
 uniform float hg;
+uniform float globalCoverage = 0.8; //gc of cloudDensity, the occupancy maps have to be baked with the same
+uniform bool skipEmptySpace = true; //step through cells the occupancy maps rule clouds out of without sampling them
+uniform int shapeBrickTexels = 4; //shape noise texels per brick of shapeBounds
+uniform int occupancyLevels = 16; //mip levels of the occupancy maps the raymarcher climbs, 1 checks base level cells only
+uniform bool precomputedSunLight = true; //look the steps toward the sun up in sunOpticalDepth where its window reaches
+uniform vec4 sunDepthBounds; //x and z of the first and last corner of where sunOpticalDepth only filters its window
+uniform float sunDepthTexelSize = 50.0;
+//quality of the density: the detail noise only erodes samples whose shape value is at most detailEdgeShape, closer than
+//detailNoiseDistance to the camera, at the mip level of the width a sample stands for times lodScale. Other samples
+//take its mean. 1, 1e10 and 0 sample it everywhere at its base level, as before
+uniform float detailEdgeShape = 0.6;
+uniform float detailNoiseDistance = 4000.0;
+uniform float lodScale = 1.0;
 
 uniform int cloudFrame; //0 - 15
 uniform vec2 resolution; //WIDTH, HEIGHT
@@ -25,6 +41,16 @@ layout (std140, binding = 0) uniform camera {
     vec3 camPos;
 };
 
+#ifdef COUNT_DENSITY_SAMPLES
+//bench/cloud_bench.cpp compiles the shader with this defined to count the cloudDensity calls, all and those toward the sun,
+//the occupancy checks and the noise samples
+layout (binding = 0, offset = 0) uniform atomic_uint densitySamples;
+layout (binding = 0, offset = 4) uniform atomic_uint sunDensitySamples;
+layout (binding = 0, offset = 8) uniform atomic_uint occupancyChecks; //cloudFree calls of the view ray
+layout (binding = 0, offset = 12) uniform atomic_uint shapeNoiseSamples;
+layout (binding = 0, offset = 16) uniform atomic_uint detailNoiseSamples;
+#endif
+
 const float PI = 3.14159265358979;
 const vec2[16] cloudFramePxOffsets = vec2[16](
     vec2(0.0, 3.0),
@@ -53,61 +79,13 @@ float softClip(float x) {
     return (-1.0 / (2.0 * x + 1.0)) + 1.0;
 }
 
-float remap(float val, float l0, float h0, float ln, float hn) {
-    return ln + ((val - l0) * (hn - ln)) / (h0 - l0);
-}
-
-float cloudBottomShape(float ph) {
-    return clamp(remap(ph, 0.0, 0.07, 0.0, 1.0), 0.0, 1.0);
-}
-
-float cloudTopShape(float ph, float wh) {
-    wh = clamp(wh + 0.12, 0.0, 1.0);
-    return clamp(remap(ph, wh * 0.2, wh, 1.0, 0.0), 0.0, 1.0);
-}
-
-float cloudShapeAlter(float ph, float wh) {
-    return cloudBottomShape(ph) * cloudTopShape(ph, wh);
-}
-
-float cloudBottomDensity(float ph) {
-    return clamp(remap(ph, 0, 0.2, 0, 1), 0.0, 1.0);
-}
-
-float cloudTopDensity(float ph) {
-    return clamp(remap(ph, 0.9, 1.0, 1.0, 0.0), 0.0, 1.0);
-}
-
-float cloudDensityAlter(float ph, float gd, float wd) {
-    return gd * cloudBottomDensity(ph) * cloudTopDensity(ph) * wd * 2.0;
-}
+#include CloudDensity
 
 float weatherMapCoverage(vec2 coords, float gc) {
     vec4 weatherMapSample = texture(weatherMap, coords / 50000.0);
     return max(weatherMapSample.r, clamp(gc - 0.5, 0.0, 1.0) * weatherMapSample.g * 2);
 }
 
-float sampleShapeNoise(vec3 coords, float mipmapLevel) {
-    vec4 SNsample = texture(shapeNoise, coords / 1755.62, mipmapLevel);
-    return remap(SNsample.r, dot(SNsample.gba, vec3(0.625, 0.25, 0.125)) - 1.0, 1.0, 0.0, 1.0);
-}
-
-float sampleDetailNoise(vec3 coords, float mipmapLevel, float gc, float ph) {
-    vec4 DNsample = texture(detailNoise, coords / detailScale, mipmapLevel);
-    float dn = dot(DNsample.rgb, vec3(0.625, 0.25, 0.125));
-    return 0.35 * exp(-gc * 0.75) * mix(dn, 1 - dn, clamp(ph * 5.0, 0.0, 1.0));
-}
-
-float cloudDensity(vec3 coords, float mipmapLevel, float gc, float gd, float cloudMinHeight, float cloudMaxHeight) {
-    vec4 weatherMapSampleVal = texture(weatherMap, coords.xz / 50000.0, mipmapLevel);
-    float coverage = max(weatherMapSampleVal.r, clamp(gc - 0.5, 0.0, 1.0) * weatherMapSampleVal.g * 2);
-    float wh = weatherMapSampleVal.b;
-    float wd = weatherMapSampleVal.a;
-    float ph = clamp((coords.y - cloudMinHeight) / (cloudMaxHeight - cloudMinHeight), 0.0, 1.0); //percentage of ray height between cloud height bounds
-    float sn = clamp(remap(sampleShapeNoise(coords, mipmapLevel) * cloudShapeAlter(ph, wh), 1 - gc * coverage, 1.0, 0.0, 1.0), 0.0, 1.0);
-    return clamp(remap(sn, sampleDetailNoise(coords, mipmapLevel, gc, ph), 1.0, 0.0, 1.0), 0.0, 1.0) * cloudDensityAlter(ph, gd, wd);
-}
-
 float beersLaw(float distance) {
     return exp(-b * distance);
 }
@@ -133,12 +111,7 @@ vec3 skyColor(vec3 rayDir, vec3 sunDir) {
 }
 
 const float FOV = radians(45.0);
-const float cloudMinHeight = 400.0;
-const float cloudMaxHeight = 1000.0;
 const float maxRayDistance = 6000.0;
-const int sunSteps = 8;
-const float sunStepLength = ((cloudMaxHeight - cloudMinHeight) * 0.5) / float(sunSteps);
-const vec3 sunDir = normalize(vec3(1.0, 0.5, 0.0));
 
 float rayLenOutside = 10.0;
 float rayLenInside = 2.0;
@@ -146,6 +119,45 @@ float rayLenInside = 2.0;
 int inStepsInAnOutStep = int(rayLenOutside / rayLenInside);
 int inStepsCloudCount = 0; //PREVENTS RAYMARCHER FROM SWITCHING BACK TO LONG STEPS AFTER ONLY ONE SMALL STEP, CORRUPTING THE TOTAL DENSITY
 
+ivec3 coverageBoundsSize;
+ivec3 shapeBoundsSize;
+ivec3 shapeNoiseSize;
+int coarsestOccupancyLevel;
+int coarsestShapeLevel;
+float sunDepthWidth; //of the window of sunOpticalDepth, its texture coordinates repeat every window
+
+//the width in units a sample at distance from the camera stands for, a pixel across or a step along the ray, times
+//lodScale. Past detailNoiseDistance so wide that the detail noise takes its mean
+float sampleFootprint(float distance, float stepLength) {
+    if (distance > detailNoiseDistance) return 1e10;
+    return max(distance * FOV / resolution.x, stepLength) * lodScale;
+}
+
+//cells of the occupancy maps a sample at pos falls in at a mip level: the weather map texel and height layer of its
+//coverage bound, and the shape noise brick of its shape bound, wrapped like the samplers wrap. The shape bounds stop at
+//their coarsest level, a single brick. The sky below and above the cloud layer, where the density is 0, is one cell each
+void occupancyCells(vec3 pos, int level, out ivec3 coverageCell, out ivec3 shapeBrick) {
+    int layer = int(floor((pos.y - cloudMinHeight) / (cloudMaxHeight - cloudMinHeight) * float(coverageBoundsSize.z)));
+    if (layer < 0 || layer >= coverageBoundsSize.z) {
+        coverageCell = ivec3(0, 0, clamp(layer, -1, coverageBoundsSize.z));
+        shapeBrick = ivec3(0);
+        return;
+    }
+    ivec2 texel = min(ivec2(fract(pos.xz / 50000.0) * vec2(coverageBoundsSize.xy)), coverageBoundsSize.xy - 1);
+    coverageCell = ivec3(min(texel >> level, max(coverageBoundsSize.xy >> level, 1) - 1), layer);
+    ivec3 shapeTexel = min(ivec3(fract(pos / 1755.62) * vec3(shapeNoiseSize)), shapeNoiseSize - 1);
+    int shapeLevel = min(level, coarsestShapeLevel);
+    shapeBrick = min((shapeTexel / shapeBrickTexels) >> shapeLevel, max(shapeBoundsSize >> shapeLevel, 1) - 1);
+}
+
+//true when no sample in the cells of a mip level can have a density, the shape noise there stays below what the
+//coverage needs
+bool cloudFree(ivec3 coverageCell, ivec3 shapeBrick, int level) {
+    if (coverageCell.z < 0 || coverageCell.z >= coverageBoundsSize.z) return true;
+    float shapeBound = texelFetch(shapeBounds, shapeBrick, min(level, coarsestShapeLevel)).r;
+    return shapeBound < texelFetch(coverageBounds, coverageCell, level).r;
+}
+
 void main() {
     //SET UP RAYS
     vec2 pxCoords = TexCoords + (cloudFramePxOffsets[min(cloudFrame, 15)] / (resolution));
@@ -153,13 +165,22 @@ void main() {
     rayAngle += radians(camAngle);
     vec3 rayUnitVec = normalize(vec3(sin(rayAngle.x) * cos(rayAngle.y), sin(rayAngle.y), cos(rayAngle.x) * cos(rayAngle.y)));
 
+    //DISTANCES TO WHERE THE RAY ENTERS AND LEAVES THE CLOUD LAYER, IN FRONT OF THE CAMERA
     float initialRayDist = 0.0;
-    if (camPos.y < cloudMinHeight) initialRayDist = ((cloudMinHeight - camPos.y) / rayUnitVec.y);
-    else if (camPos.y > cloudMaxHeight) initialRayDist = ((cloudMaxHeight - camPos.y) / rayUnitVec.y);
+    float exitRayDist = 1e10;
+    if (rayUnitVec.y != 0.0) {
+        float minHeightDist = (cloudMinHeight - camPos.y) / rayUnitVec.y;
+        float maxHeightDist = (cloudMaxHeight - camPos.y) / rayUnitVec.y;
+        initialRayDist = max(min(minHeightDist, maxHeightDist), 0.0);
+        exitRayDist = max(minHeightDist, maxHeightDist);
+    } else if (camPos.y < cloudMinHeight || camPos.y > cloudMaxHeight) {
+        exitRayDist = 0.0;
+    }
+    //THE DENSITY IS 0 OUTSIDE THE LAYER, A RAY THAT MISSES IT IS ONLY SKY AND THE REST STOP MARCHING WHEN THEY LEAVE IT
+    float rayMarchDist = exitRayDist > initialRayDist ? min(exitRayDist - initialRayDist, maxRayDistance) : -1.0;
 
     vec3 rayPos = camPos + initialRayDist * rayUnitVec;
     rayPos += rayUnitVec * 15.0 * texture(blueNoise, pxCoords * (resolution / vec2(470))).r;
-    initialRayDist = abs(initialRayDist);
 
     //rayLenOutside = ((3.0 * (1.0 - abs(rayAngle.y))) + 1.0) * rayLenOutside;
     //rayLenInside = rayLenOutside / 4.0;
@@ -173,15 +194,53 @@ void main() {
     float mainRaySample = 0.0;
     float activeRayLen = rayLenOutside;
     float depth = 1000000;
+    coverageBoundsSize = textureSize(coverageBounds, 0);
+    shapeBoundsSize = textureSize(shapeBounds, 0);
+    shapeNoiseSize = textureSize(shapeNoise, 0);
+    coarsestOccupancyLevel = clamp(occupancyLevels, 1, textureQueryLevels(coverageBounds)) - 1;
+    coarsestShapeLevel = textureQueryLevels(shapeBounds) - 1;
+    sunDepthWidth = sunDepthTexelSize * float(textureSize(sunOpticalDepth, 0).x);
+    setUpDetailNoise();
     
-    while (rayDist <= maxRayDistance && totalTransmission > 0.01) {
-        mainRaySample = cloudDensity(rayPos, 0.0, 0.8, 0.03, cloudMinHeight, cloudMaxHeight);
+    while (rayDist <= rayMarchDist && totalTransmission > 0.01) {
+        if (skipEmptySpace && activeRayLen == rayLenOutside) { //SKIP EMPTY CELLS
+            //steps over the cells without sampling them, by the same additions as a sampled step so the first sample
+            //after them is the one the march takes anyway and the image stays the same. After an empty cell the next
+            //check is a level coarser, a cell that may hold clouds is checked again a level finer, down to the base level
+            int level = 0;
+            ivec3 coverageCell, shapeBrick;
+            occupancyCells(rayPos, level, coverageCell, shapeBrick);
+            while (rayDist <= rayMarchDist) {
+#ifdef COUNT_DENSITY_SAMPLES
+                atomicCounterIncrement(occupancyChecks);
+#endif
+                if (cloudFree(coverageCell, shapeBrick, level)) {
+                    ivec3 freeCoverageCell = coverageCell;
+                    ivec3 freeShapeBrick = shapeBrick;
+                    while (rayDist <= rayMarchDist && coverageCell == freeCoverageCell && shapeBrick == freeShapeBrick) {
+                        rayPos += rayUnitVec * activeRayLen;
+                        rayDist += activeRayLen;
+                        occupancyCells(rayPos, level, coverageCell, shapeBrick);
+                    }
+                    level = min(level + 1, coarsestOccupancyLevel);
+                } else if (level > 0) {
+                    level--;
+                } else {
+                    break;
+                }
+                occupancyCells(rayPos, level, coverageCell, shapeBrick);
+            }
+            if (rayDist > rayMarchDist) break;
+        }
+        float footprint = sampleFootprint(rayDist + initialRayDist, activeRayLen);
+        mainRaySample = cloudDensity(rayPos, footprint, globalCoverage, 0.03, cloudMinHeight, cloudMaxHeight);
 
         if (mainRaySample > 0.0000001 && activeRayLen == rayLenOutside) { //SWITCH TO IN-CLOUD MODE
             if ((rayDist + initialRayDist)> rayLenOutside) {
                 rayPos -= rayUnitVec * (rayLenOutside - rayLenInside); //STEP BACK BY RAYLENOUTSIDE AND FORWARD BY RAYLENINSIDE
                 rayDist -= (rayLenOutside - rayLenInside);
-                mainRaySample = cloudDensity(rayPos, 0.0, 0.8, 0.03, cloudMinHeight, cloudMaxHeight);
+                footprint = sampleFootprint(rayDist + initialRayDist, rayLenInside);
+                mainRaySample = cloudDensity(rayPos, footprint, globalCoverage, 0.03, cloudMinHeight, cloudMaxHeight);
                 inStepsCloudCount = inStepsInAnOutStep;
             }
             activeRayLen = rayLenInside;
@@ -198,10 +257,27 @@ void main() {
         if (activeRayLen == rayLenInside) { //STEPS TOWARD THE SUN
             depth = min(depth, rayDist + initialRayDist);
             float sunLightTransmission = 1.0;
-            for (int i=0; i<sunSteps; i++) { //STEPS TOWARD THE SUN
-                sunRayPos += sunDir * sunStepLength;
-                sunSampleDensity = cloudDensity(sunRayPos, 0.0, 0.8, 0.03, cloudMinHeight, cloudMaxHeight); //SUN RAY DENSITY SAMPLE
-                sunLightTransmission *= beersLaw(sunStepLength * sunSampleDensity);
+            bool inSunDepthWindow = all(greaterThanEqual(rayPos.xz, sunDepthBounds.xy))
+                && all(lessThanEqual(rayPos.xz, sunDepthBounds.zw));
+            if (precomputedSunLight && inSunDepthWindow) { //THE SAME STEPS, BAKED
+                float sunDepthHeight = (rayPos.y - cloudMinHeight) / (cloudMaxHeight - cloudMinHeight);
+                vec3 sunDepthCoords = vec3(rayPos.x / sunDepthWidth, sunDepthHeight, rayPos.z / sunDepthWidth);
+                sunLightTransmission = beersLaw(textureLod(sunOpticalDepth, sunDepthCoords, 0.0).r);
+            } else {
+                for (int i=0; i<sunSteps; i++) { //STEPS TOWARD THE SUN
+                    sunRayPos += sunDir * sunStepLength;
+                    if (skipEmptySpace) { //A SAMPLE IN AN EMPTY CELL HAS NO DENSITY AND TRANSMITS ALL LIGHT
+                        ivec3 coverageCell, shapeBrick;
+                        occupancyCells(sunRayPos, 0, coverageCell, shapeBrick);
+                        if (cloudFree(coverageCell, shapeBrick, 0)) continue;
+                    }
+#ifdef COUNT_DENSITY_SAMPLES
+                    atomicCounterIncrement(sunDensitySamples);
+#endif
+                    footprint = sampleFootprint(rayDist + initialRayDist, sunStepLength);
+                    sunSampleDensity = cloudDensity(sunRayPos, footprint, globalCoverage, 0.03, cloudMinHeight, cloudMaxHeight); //SUN RAY DENSITY SAMPLE
+                    sunLightTransmission *= beersLaw(sunStepLength * sunSampleDensity);
+                }
             }
             //sunLightTransmission = 1.0 - ((1.0 - sunLightTransmission) * henyeyGreenstein(dot(sunDir, sunDir)));
 
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cassert>
+
+#include "FastNoiseLite.h"
+
+//FastNoiseLite with the noise type, fractal type, cellular distance function, cellular return type
+//and octave count fixed at compile time, so GetNoise has no switches left and the octave loop is unrolled.
+//Everything else (seed, frequency, period, gain, lacunarity, jitter, ...) is copied from a configured FastNoiseLite,
+//which has to use the same fixed settings and no 3D rotation. The results are identical to its GetNoise.
+//It pays off for cellular noise, whose neighbourhood walk no longer switches on the distance function; the lattice
+//types only lose the noise type switch, GenUniformGrid3D is the faster way to bake those.
+template <FastNoiseLite::NoiseType Noise,
+          FastNoiseLite::FractalType Fractal = FastNoiseLite::FractalType_None,
+          FastNoiseLite::CellularDistanceFunction DistanceFunction = FastNoiseLite::CellularDistanceFunction_EuclideanSq,
+          FastNoiseLite::CellularReturnType ReturnType = FastNoiseLite::CellularReturnType_Distance,
+          int Octaves = 3>
+class StaticNoise {
+    static_assert(Fractal == FastNoiseLite::FractalType_None || Fractal == FastNoiseLite::FractalType_FBm ||
+                  Fractal == FastNoiseLite::FractalType_Ridged || Fractal == FastNoiseLite::FractalType_PingPong,
+                  "StaticNoise only covers noise fractals, not domain warp");
+
+public:
+    StaticNoise(const FastNoiseLite& config);
+    float GetNoise(float x, float y) const;
+    float GetNoise(float x, float y, float z) const;
+
+private:
+    FastNoiseLite noise;
+
+    void transformCoordinate(float& x, float& y) const;
+    void transformCoordinate(float& x, float& y, float& z) const;
+    float single(int seed, float x, float y, int period) const;
+    float single(int seed, float x, float y, float z, int period) const;
+    float cellular(int seed, float x, float y, int period) const;
+    float cellular(int seed, float x, float y, float z, int period) const;
+    static unsigned primeCell(int cell, int prime, int period);
+    float cellularResult(float distance0, float distance1, int closestHash) const;
+    template <typename... Coords>
+    float fractal(Coords... coords) const;
+};
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::StaticNoise(const FastNoiseLite& config) : noise(config) {
+    assert(noise.mNoiseType == Noise);
+    assert(noise.mRotationType3D == FastNoiseLite::RotationType3D_None);
+    assert(noise.mFractalType == Fractal || Fractal == FastNoiseLite::FractalType_None);
+    assert(noise.mOctaves == Octaves || Fractal == FastNoiseLite::FractalType_None);
+    assert(noise.mCellularDistanceFunction == DistanceFunction || Noise != FastNoiseLite::NoiseType_Cellular);
+    assert(noise.mCellularReturnType == ReturnType || Noise != FastNoiseLite::NoiseType_Cellular);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::GetNoise(float x, float y) const {
+    transformCoordinate(x, y);
+    if constexpr (Fractal == FastNoiseLite::FractalType_None)
+        return single(noise.mSeed, x, y, noise.mPeriod);
+    else
+        return fractal(x, y);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::GetNoise(float x, float y, float z) const {
+    transformCoordinate(x, y, z);
+    if constexpr (Fractal == FastNoiseLite::FractalType_None)
+        return single(noise.mSeed, x, y, z, noise.mPeriod);
+    else
+        return fractal(x, y, z);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+void StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::transformCoordinate(float& x, float& y) const {
+    x *= noise.mFrequency;
+    y *= noise.mFrequency;
+    if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2 || Noise == FastNoiseLite::NoiseType_OpenSimplex2S) {
+        const float SQRT3 = (float)1.7320508075688772935274463415059;
+        const float F2 = 0.5f * (SQRT3 - 1);
+        float t = (x + y) * F2;
+        x += t;
+        y += t;
+    }
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+void StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::transformCoordinate(float& x, float& y, float& z) const {
+    x *= noise.mFrequency;
+    y *= noise.mFrequency;
+    z *= noise.mFrequency;
+    //without a 3D rotation only the OpenSimplex2 types transform the coordinate
+    if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2 || Noise == FastNoiseLite::NoiseType_OpenSimplex2S) {
+        const float R3 = (float)(2.0 / 3.0);
+        float r = (x + y + z) * R3; //rotation, not skew
+        x = r - x;
+        y = r - y;
+        z = r - z;
+    }
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::single(int seed, float x, float y, int period) const {
+    if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2) return noise.SingleSimplex(seed, x, y);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2S) return noise.SingleOpenSimplex2S(seed, x, y);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_Cellular) return cellular(seed, x, y, period);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_Perlin) return noise.SinglePerlin(seed, x, y, period);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_ValueCubic) return noise.SingleValueCubic(seed, x, y, period);
+    else return noise.SingleValue(seed, x, y, period);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::single(int seed, float x, float y, float z, int period) const {
+    if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2) return noise.SingleOpenSimplex2(seed, x, y, z);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_OpenSimplex2S) return noise.SingleOpenSimplex2S(seed, x, y, z);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_Cellular) return cellular(seed, x, y, z, period);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_Perlin) return noise.SinglePerlin(seed, x, y, z, period);
+    else if constexpr (Noise == FastNoiseLite::NoiseType_ValueCubic) return noise.SingleValueCubic(seed, x, y, z, period);
+    else return noise.SingleValue(seed, x, y, z, period);
+}
+
+//FastNoiseLite::PrimeCell in unsigned, so the primed coordinates wrap instead of overflowing,
+//the hash takes the same bits as an int
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+unsigned StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::primeCell(int cell, int prime, int period) {
+    if (period > 0) {
+        cell %= period;
+        if (cell < 0) cell += period;
+    }
+    return (unsigned)cell * (unsigned)prime;
+}
+
+//same arithmetic as FastNoiseLite::SingleCellular with the distance function and return type resolved at compile time
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::cellular(int seed, float x, float y, int period) const {
+    int xr = FastNoiseLite::FastRound(x);
+    int yr = FastNoiseLite::FastRound(y);
+
+    float distance0 = 1e10f;
+    float distance1 = 1e10f;
+    int closestHash = 0;
+
+    float cellularJitter = 0.43701595f * noise.mCellularJitterModifier;
+
+    unsigned xPrimes[3], yPrimes[3];
+    for (int i = 0; i < 3; i++) {
+        xPrimes[i] = primeCell(xr - 1 + i, FastNoiseLite::PrimeX, period);
+        yPrimes[i] = primeCell(yr - 1 + i, FastNoiseLite::PrimeY, period);
+    }
+
+    for (int xi = xr - 1; xi <= xr + 1; xi++) {
+        for (int yi = yr - 1; yi <= yr + 1; yi++) {
+            int hash = FastNoiseLite::Hash(seed, (int)xPrimes[xi - xr + 1], (int)yPrimes[yi - yr + 1]);
+            int idx = hash & (255 << 1);
+
+            float vecX = (float)(xi - x) + FastNoiseLite::Lookup<float>::RandVecs2D[idx] * cellularJitter;
+            float vecY = (float)(yi - y) + FastNoiseLite::Lookup<float>::RandVecs2D[idx | 1] * cellularJitter;
+
+            float newDistance;
+            if constexpr (DistanceFunction == FastNoiseLite::CellularDistanceFunction_Manhattan)
+                newDistance = FastNoiseLite::FastAbs(vecX) + FastNoiseLite::FastAbs(vecY);
+            else if constexpr (DistanceFunction == FastNoiseLite::CellularDistanceFunction_Hybrid)
+                newDistance = (FastNoiseLite::FastAbs(vecX) + FastNoiseLite::FastAbs(vecY)) + (vecX * vecX + vecY * vecY);
+            else
+                newDistance = vecX * vecX + vecY * vecY;
+
+            distance1 = FastNoiseLite::FastMax(FastNoiseLite::FastMin(distance1, newDistance), distance0);
+            if (newDistance < distance0) {
+                distance0 = newDistance;
+                closestHash = hash;
+            }
+        }
+    }
+
+    return cellularResult(distance0, distance1, closestHash);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::cellular(int seed, float x, float y, float z, int period) const {
+    int xr = FastNoiseLite::FastRound(x);
+    int yr = FastNoiseLite::FastRound(y);
+    int zr = FastNoiseLite::FastRound(z);
+
+    float distance0 = 1e10f;
+    float distance1 = 1e10f;
+    int closestHash = 0;
+
+    float cellularJitter = 0.39614353f * noise.mCellularJitterModifier;
+
+    unsigned xPrimes[3], yPrimes[3], zPrimes[3];
+    for (int i = 0; i < 3; i++) {
+        xPrimes[i] = primeCell(xr - 1 + i, FastNoiseLite::PrimeX, period);
+        yPrimes[i] = primeCell(yr - 1 + i, FastNoiseLite::PrimeY, period);
+        zPrimes[i] = primeCell(zr - 1 + i, FastNoiseLite::PrimeZ, period);
+    }
+
+    for (int xi = xr - 1; xi <= xr + 1; xi++) {
+        for (int yi = yr - 1; yi <= yr + 1; yi++) {
+            for (int zi = zr - 1; zi <= zr + 1; zi++) {
+                int hash = FastNoiseLite::Hash(seed, (int)xPrimes[xi - xr + 1], (int)yPrimes[yi - yr + 1], (int)zPrimes[zi - zr + 1]);
+                int idx = hash & (255 << 2);
+
+                float vecX = (float)(xi - x) + FastNoiseLite::Lookup<float>::RandVecs3D[idx] * cellularJitter;
+                float vecY = (float)(yi - y) + FastNoiseLite::Lookup<float>::RandVecs3D[idx | 1] * cellularJitter;
+                float vecZ = (float)(zi - z) + FastNoiseLite::Lookup<float>::RandVecs3D[idx | 2] * cellularJitter;
+
+                float newDistance;
+                if constexpr (DistanceFunction == FastNoiseLite::CellularDistanceFunction_Manhattan)
+                    newDistance = FastNoiseLite::FastAbs(vecX) + FastNoiseLite::FastAbs(vecY) + FastNoiseLite::FastAbs(vecZ);
+                else if constexpr (DistanceFunction == FastNoiseLite::CellularDistanceFunction_Hybrid)
+                    newDistance = (FastNoiseLite::FastAbs(vecX) + FastNoiseLite::FastAbs(vecY) + FastNoiseLite::FastAbs(vecZ)) + (vecX * vecX + vecY * vecY + vecZ * vecZ);
+                else
+                    newDistance = vecX * vecX + vecY * vecY + vecZ * vecZ;
+
+                distance1 = FastNoiseLite::FastMax(FastNoiseLite::FastMin(distance1, newDistance), distance0);
+                if (newDistance < distance0) {
+                    distance0 = newDistance;
+                    closestHash = hash;
+                }
+            }
+        }
+    }
+
+    return cellularResult(distance0, distance1, closestHash);
+}
+
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::cellularResult(float distance0, float distance1, int closestHash) const {
+    if constexpr (DistanceFunction == FastNoiseLite::CellularDistanceFunction_Euclidean && ReturnType >= FastNoiseLite::CellularReturnType_Distance) {
+        distance0 = FastNoiseLite::FastSqrt(distance0);
+        if constexpr (ReturnType >= FastNoiseLite::CellularReturnType_Distance2)
+            distance1 = FastNoiseLite::FastSqrt(distance1);
+    }
+
+    if constexpr (ReturnType == FastNoiseLite::CellularReturnType_CellValue) return closestHash * (1 / 2147483648.0f);
+    else if constexpr (ReturnType == FastNoiseLite::CellularReturnType_Distance) return distance0 - 1;
+    else if constexpr (ReturnType == FastNoiseLite::CellularReturnType_Distance2) return distance1 - 1;
+    else if constexpr (ReturnType == FastNoiseLite::CellularReturnType_Distance2Add) return (distance1 + distance0) * 0.5f - 1;
+    else if constexpr (ReturnType == FastNoiseLite::CellularReturnType_Distance2Sub) return distance1 - distance0 - 1;
+    else if constexpr (ReturnType == FastNoiseLite::CellularReturnType_Distance2Mul) return distance1 * distance0 * 0.5f - 1;
+    else return distance0 / distance1 - 1;
+}
+
+//FBm, Ridged and PingPong with the octave count as a compile time trip count
+template <FastNoiseLite::NoiseType Noise, FastNoiseLite::FractalType Fractal, FastNoiseLite::CellularDistanceFunction DistanceFunction, FastNoiseLite::CellularReturnType ReturnType, int Octaves>
+template <typename... Coords>
+float StaticNoise<Noise, Fractal, DistanceFunction, ReturnType, Octaves>::fractal(Coords... coords) const {
+    const bool is2D = sizeof...(Coords) == 2;
+    int seed = noise.mSeed;
+    int period = noise.mPeriod;
+    float sum = 0;
+    float amp = noise.mFractalBounding;
+
+#pragma GCC unroll 16
+    for (int i = 0; i < Octaves; i++) {
+        if constexpr (Fractal == FastNoiseLite::FractalType_FBm) {
+            float value = single(seed++, coords..., period);
+            sum += value * amp;
+            //2D FBm clamps the weight like FastNoiseLite does
+            if constexpr (is2D)
+                amp *= FastNoiseLite::Lerp(1.0f, FastNoiseLite::FastMin(value + 1, 2) * 0.5f, noise.mWeightedStrength);
+            else
+                amp *= FastNoiseLite::Lerp(1.0f, (value + 1) * 0.5f, noise.mWeightedStrength);
+        }
+        else if constexpr (Fractal == FastNoiseLite::FractalType_Ridged) {
+            float value = FastNoiseLite::FastAbs(single(seed++, coords..., period));
+            sum += (value * -2 + 1) * amp;
+            amp *= FastNoiseLite::Lerp(1.0f, 1 - value, noise.mWeightedStrength);
+        }
+        else {
+            float value = FastNoiseLite::PingPong((single(seed++, coords..., period) + 1) * noise.mPingPongStrength);
+            sum += (value - 0.5f) * 2 * amp;
+            amp *= FastNoiseLite::Lerp(1.0f, value, noise.mWeightedStrength);
+        }
+
+        ((coords *= noise.mLacunarity), ...);
+        amp *= noise.mGain;
+        period = noise.NextOctavePeriod(period);
+    }
+
+    return sum;
+}
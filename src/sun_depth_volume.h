@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "gpu_noise.h"
+#include "shader_reader.h"
+
+//The light cloudsFrag3.frag's samples inside a cloud get from the sun, baked once per texel of a window of the cloud
+//layer around the camera rather than marched eight density samples toward the sun for every sample. Each texel holds
+//the optical depth of those steps from its centre, cloudsFrag3.frag takes beersLaw of the filtered value, so b can still
+//change every frame. The texture repeats across, a texel holds the window's column its index wraps to, so the window
+//follows the camera by rewriting only the columns it uncovers. Samples outside the window march toward the sun as before.
+
+const int SUN_DEPTH_TEXELS = 256; //across the window, along x and z
+const int SUN_DEPTH_LAYERS = 32; //over the height of the cloud layer
+const float SUN_DEPTH_TEXEL_SIZE = 50.0f; //across, in units, the window reaches 6400 units from the camera
+
+class SunDepthVolume {
+public:
+    GLuint opticalDepth = 0; //r16f, x and z repeat, y the height layers
+
+    SunDepthVolume();
+    //bakes the whole window from the textures cloudsFrag3.frag samples, with its gc, detailScale and detailEdgeShape.
+    //Called again whenever a texture changed, the textures are kept to bake the columns follow uncovers
+    void bake(GLuint weatherMap, GLuint shapeNoise, GLuint detailNoise, float globalCoverage, float detailScale, float detailEdgeShape);
+    //centres the window on the camera, baking the columns it uncovers, all of them the first time or after a jump of
+    //the window's width
+    void follow(glm::vec3 camPos);
+    //x and z of the first and last corner of where filtering only blends texels of the window, for cloudsFrag3.frag
+    glm::vec4 bounds() const;
+
+private:
+    Shader shader;
+    GLuint weatherMap = 0, shapeNoise = 0, detailNoise = 0;
+    float globalCoverage = 0.0f, detailScale = 0.0f, detailEdgeShape = 0.0f;
+    glm::ivec2 firstTexel = glm::ivec2(0); //of the window, counted from the origin
+    bool placed = false;
+
+    //bakes count texels along x and z from first, counted from the origin
+    void update(glm::ivec2 first, glm::ivec2 count);
+};
+
+SunDepthVolume::SunDepthVolume() : shader("./src/shaders/cloudSunDepthGen.comp") {
+    glGenTextures(1, &opticalDepth);
+    glBindTexture(GL_TEXTURE_3D, opticalDepth);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R16F, SUN_DEPTH_TEXELS, SUN_DEPTH_LAYERS, SUN_DEPTH_TEXELS, 0, GL_RED, GL_FLOAT, NULL);
+}
+
+void SunDepthVolume::bake(GLuint weatherMap, GLuint shapeNoise, GLuint detailNoise, float globalCoverage, float detailScale, float detailEdgeShape) {
+    this->weatherMap = weatherMap;
+    this->shapeNoise = shapeNoise;
+    this->detailNoise = detailNoise;
+    this->globalCoverage = globalCoverage;
+    this->detailScale = detailScale;
+    this->detailEdgeShape = detailEdgeShape;
+    if (placed) update(firstTexel, glm::ivec2(SUN_DEPTH_TEXELS));
+}
+
+void SunDepthVolume::follow(glm::vec3 camPos) {
+    glm::ivec2 first = glm::ivec2(glm::floor(glm::vec2(camPos.x, camPos.z) / SUN_DEPTH_TEXEL_SIZE)) - SUN_DEPTH_TEXELS / 2;
+    glm::ivec2 shift = first - firstTexel;
+    if (!placed || std::abs(shift.x) >= SUN_DEPTH_TEXELS || std::abs(shift.y) >= SUN_DEPTH_TEXELS) {
+        firstTexel = first;
+        placed = true;
+        update(firstTexel, glm::ivec2(SUN_DEPTH_TEXELS));
+        return;
+    }
+    firstTexel = first;
+    //the columns along x, then the rows along z, each across the whole window
+    if (shift.x > 0) update(glm::ivec2(first.x + SUN_DEPTH_TEXELS - shift.x, first.y), glm::ivec2(shift.x, SUN_DEPTH_TEXELS));
+    if (shift.x < 0) update(first, glm::ivec2(-shift.x, SUN_DEPTH_TEXELS));
+    if (shift.y > 0) update(glm::ivec2(first.x, first.y + SUN_DEPTH_TEXELS - shift.y), glm::ivec2(SUN_DEPTH_TEXELS, shift.y));
+    if (shift.y < 0) update(first, glm::ivec2(SUN_DEPTH_TEXELS, -shift.y));
+}
+
+glm::vec4 SunDepthVolume::bounds() const {
+    glm::vec2 first = (glm::vec2(firstTexel) + 0.5f) * SUN_DEPTH_TEXEL_SIZE;
+    glm::vec2 last = (glm::vec2(firstTexel + SUN_DEPTH_TEXELS) - 0.5f) * SUN_DEPTH_TEXEL_SIZE;
+    return glm::vec4(first, last);
+}
+
+void SunDepthVolume::update(glm::ivec2 first, glm::ivec2 count) {
+    if (!weatherMap) return;
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, weatherMap);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, shapeNoise);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_3D, detailNoise);
+    glBindImageTexture(0, opticalDepth, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+    shader.use();
+    shader.setInt("weatherMap", 0);
+    shader.setInt("shapeNoise", 1);
+    shader.setInt("detailNoise", 2);
+    shader.setFloat("globalCoverage", globalCoverage);
+    shader.setFloat("detailScale", detailScale);
+    shader.setFloat("detailEdgeShape", detailEdgeShape);
+    shader.setFloat("texelSize", SUN_DEPTH_TEXEL_SIZE);
+    glUniform2i(glGetUniformLocation(shader.ID, "firstTexel"), first.x, first.y);
+    glUniform2i(glGetUniformLocation(shader.ID, "texelCount"), count.x, count.y);
+    dispatchCompute(shader.ID, count.x, SUN_DEPTH_LAYERS, count.y);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Persistent worker threads for splitting loops across all cores.
+//parallelFor gives every worker a contiguous share of the indices, workers that run out
+//steal single indices from the back of the other shares until everything is done.
+class ThreadPool {
+public:
+    ThreadPool(int threadCount = 0); //0 = one thread per hardware thread
+    ~ThreadPool();
+    int threadCount() const;
+    //runs task(i) for every i in [0, count) and returns once all of them finished, the calling thread works too
+    void parallelFor(int count, const std::function<void(int)>& task);
+
+private:
+    struct alignas(64) WorkRange {
+        std::atomic<uint64_t> bounds; //first index in the low 32 bits, one past the last in the high 32 bits
+    };
+
+    int numThreads;
+    std::vector<std::thread> workers;
+    std::unique_ptr<WorkRange[]> ranges;
+    const std::function<void(int)>* currentTask = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    uint64_t jobGeneration = 0;
+    int busyWorkers = 0;
+    bool stopping = false;
+
+    void workerLoop(int index);
+    void runWork(int index);
+    bool popFront(int index, int& item);
+    bool stealBack(int index, int& item);
+};
+
+static uint64_t packRange(uint32_t first, uint32_t last) {
+    return (uint64_t)first | ((uint64_t)last << 32);
+}
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    numThreads = std::max(threadCount, 1);
+    ranges = std::make_unique<WorkRange[]>(numThreads);
+    for (int i = 0; i < numThreads; i++)
+        ranges[i].bounds.store(0);
+    //index 0 is the thread calling parallelFor
+    for (int i = 1; i < numThreads; i++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+int ThreadPool::threadCount() const {
+    return numThreads;
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) return;
+    for (int i = 0; i < numThreads; i++) {
+        uint32_t first = (uint32_t)((int64_t)count * i / numThreads);
+        uint32_t last = (uint32_t)((int64_t)count * (i + 1) / numThreads);
+        ranges[i].bounds.store(packRange(first, last));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        busyWorkers = numThreads - 1;
+        jobGeneration++;
+    }
+    wakeCondition.notify_all();
+
+    runWork(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+    currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop(int index) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = jobGeneration;
+        }
+
+        runWork(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+        }
+        doneCondition.notify_one();
+    }
+}
+
+void ThreadPool::runWork(int index) {
+    const std::function<void(int)>& task = *currentTask;
+    int item;
+    while (popFront(index, item))
+        task(item);
+
+    //own share is done, help the others from the opposite end of their shares
+    for (int offset = 1; offset < numThreads; offset++) {
+        int victim = (index + offset) % numThreads;
+        while (stealBack(victim, item))
+            task(item);
+    }
+}
+
+bool ThreadPool::popFront(int index, int& item) {
+    std::atomic<uint64_t>& bounds = ranges[index].bounds;
+    uint64_t current = bounds.load();
+    while (true) {
+        uint32_t first = (uint32_t)current;
+        uint32_t last = (uint32_t)(current >> 32);
+        if (first >= last) return false;
+        if (bounds.compare_exchange_weak(current, packRange(first + 1, last))) {
+            item = (int)first;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::stealBack(int index, int& item) {
+    std::atomic<uint64_t>& bounds = ranges[index].bounds;
+    uint64_t current = bounds.load();
+    while (true) {
+        uint32_t first = (uint32_t)current;
+        uint32_t last = (uint32_t)(current >> 32);
+        if (first >= last) return false;
+        if (bounds.compare_exchange_weak(current, packRange(first, last - 1))) {
+            item = (int)(last - 1);
+            return true;
+        }
+    }
+}
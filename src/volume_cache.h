@@ -0,0 +1,434 @@
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+//windows.h redefines APIENTRY (already set by glad) to the same __stdcall calling convention
+#undef APIENTRY
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FastNoiseLite.h"
+#include "noise_layers.h"
+
+//On-disk cache of baked noise volumes, so an unchanged volume is memory mapped and uploaded instead of baked again.
+//A volume is addressed by a hash of everything that decides its texels: the settings of every FastNoiseLite
+//that feeds it, its size and its texel format. Changing any SetXxx gives a new hash, so a stale file is never
+//found and is replaced on the next store. Noise code that changes its output for the same settings has to bump
+//VOLUME_CACHE_VERSION, fill code written by hand has to bump a version in its key name.
+//The cache is shared by every process started in the same directory: a volume is published with an atomic rename and
+//mapped read only from the page cache, and VolumeCacheLock lets only one of several processes starting at once bake it.
+
+const uint32_t VOLUME_CACHE_VERSION = 1;
+const char* const VOLUME_CACHE_DIR = "cache";
+
+//file layout: this header, then the texels exactly as they are passed to glTexImage3D
+struct VolumeCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t hash;
+    int32_t width, height, depth;
+    uint32_t format, type, texelBytes;
+    uint64_t bytes;
+};
+
+class VolumeCacheKey {
+public:
+    //format and type are the glTexImage3D upload format and type, texelBytes the size of one texel in them
+    VolumeCacheKey(const char* name, int width, int height, int depth, unsigned int format, unsigned int type, int texelBytes);
+    VolumeCacheKey& add(const void* data, size_t size);
+    VolumeCacheKey& add(int value);
+    VolumeCacheKey& add(float value);
+    VolumeCacheKey& add(const char* text);
+    VolumeCacheKey& add(const FastNoiseLite& noise);
+    VolumeCacheKey& add(const NoiseLayers& layers);
+    uint64_t hash() const;
+    size_t byteSize() const;
+    //cache/<name>_<hash>.vol, the name part lets a store remove the files of older settings
+    std::filesystem::path path() const;
+    VolumeCacheHeader header() const;
+    const std::string& name() const;
+
+private:
+    std::string volumeName;
+    int width, height, depth;
+    unsigned int format, type;
+    int texelBytes;
+    uint64_t state;
+
+    std::string fileStem() const;
+};
+
+VolumeCacheKey::VolumeCacheKey(const char* name, int width, int height, int depth, unsigned int format, unsigned int type, int texelBytes)
+    : volumeName(name), width(width), height(height), depth(depth), format(format), type(type), texelBytes(texelBytes), state(14695981039346656037ull) {
+    add((int)VOLUME_CACHE_VERSION).add(name).add(width).add(height).add(depth).add((int)format).add((int)type).add(texelBytes);
+}
+
+//64 bit FNV-1a
+VolumeCacheKey& VolumeCacheKey::add(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i=0; i<size; i++) {
+        state ^= bytes[i];
+        state *= 1099511628211ull;
+    }
+    return *this;
+}
+
+VolumeCacheKey& VolumeCacheKey::add(int value) {
+    return add(&value, sizeof(value));
+}
+
+VolumeCacheKey& VolumeCacheKey::add(float value) {
+    return add(&value, sizeof(value));
+}
+
+VolumeCacheKey& VolumeCacheKey::add(const char* text) {
+    //the terminator keeps "ab" + "c" apart from "a" + "bc"
+    return add(text, strlen(text) + 1);
+}
+
+//every member on its own rather than the raw object, so padding bytes never reach the hash
+VolumeCacheKey& VolumeCacheKey::add(const FastNoiseLite& noise) {
+    add(noise.mSeed).add(noise.mFrequency).add(noise.mPeriod).add((int)noise.mNoiseType).add((int)noise.mRotationType3D).add((int)noise.mTransformType3D);
+    add((int)noise.mFractalType).add(noise.mOctaves).add(noise.mLacunarity).add(noise.mGain).add(noise.mWeightedStrength);
+    add(noise.mPingPongStrength).add(noise.mFractalBounding);
+    add((int)noise.mCellularDistanceFunction).add((int)noise.mCellularReturnType).add(noise.mCellularJitterModifier);
+    add((int)noise.mDomainWarpType).add((int)noise.mWarpTransformType3D).add(noise.mDomainWarpAmp);
+    return *this;
+}
+
+VolumeCacheKey& VolumeCacheKey::add(const NoiseLayers& layers) {
+    add(layers.channels).add((int)layers.layers.size());
+    for (const NoiseLayers::Layer& layer : layers.layers) {
+        add(layer.noise).add(layer.channel).add(layer.scale).add(layer.bias).add((int)layer.blend);
+    }
+    for (const ChannelRange& range : layers.ranges) {
+        add(range.min).add(range.max);
+    }
+    add(layers.axes, sizeof(layers.axes));
+    return *this;
+}
+
+uint64_t VolumeCacheKey::hash() const {
+    return state;
+}
+
+size_t VolumeCacheKey::byteSize() const {
+    return (size_t)width * height * depth * texelBytes;
+}
+
+std::string VolumeCacheKey::fileStem() const {
+    std::string stem = volumeName;
+    for (char& c : stem) {
+        if (!isalnum((unsigned char)c)) c = '_';
+    }
+    return stem + "_";
+}
+
+std::filesystem::path VolumeCacheKey::path() const {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)state);
+    return std::filesystem::path(VOLUME_CACHE_DIR) / (fileStem() + hex + ".vol");
+}
+
+VolumeCacheHeader VolumeCacheKey::header() const {
+    VolumeCacheHeader header;
+    memcpy(header.magic, "VOLC", 4);
+    header.version = VOLUME_CACHE_VERSION;
+    header.hash = state;
+    header.width = width;
+    header.height = height;
+    header.depth = depth;
+    header.format = format;
+    header.type = type;
+    header.texelBytes = texelBytes;
+    header.bytes = byteSize();
+    return header;
+}
+
+const std::string& VolumeCacheKey::name() const {
+    return volumeName;
+}
+
+//read only mapping of a cached volume, invalid when there is no file for the key or the file does not match it
+class MappedVolume {
+public:
+    MappedVolume(const VolumeCacheKey& key);
+    ~MappedVolume();
+    MappedVolume(const MappedVolume&) = delete;
+    MappedVolume& operator=(const MappedVolume&) = delete;
+    bool valid() const;
+    //the texels, ready for glTexImage3D; pages are read from disk as the upload touches them and shared with every
+    //other process mapping the same volume
+    const void* texels() const;
+
+private:
+    const unsigned char* view = nullptr;
+    size_t viewBytes = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int file = -1;
+#endif
+
+    void unmap();
+};
+
+MappedVolume::MappedVolume(const VolumeCacheKey& key) {
+    std::string path = key.path().string();
+    size_t expectedBytes = sizeof(VolumeCacheHeader) + key.byteSize();
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart != expectedBytes) {
+        unmap();
+        return;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        unmap();
+        return;
+    }
+    view = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    file = open(path.c_str(), O_RDONLY);
+    if (file < 0) return;
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || (uint64_t)fileStat.st_size != expectedBytes) {
+        unmap();
+        return;
+    }
+    void* mapped = mmap(nullptr, expectedBytes, PROT_READ, MAP_SHARED, file, 0);
+    if (mapped == MAP_FAILED) {
+        unmap();
+        return;
+    }
+    view = (const unsigned char*)mapped;
+#endif
+    if (view == nullptr) {
+        unmap();
+        return;
+    }
+    viewBytes = expectedBytes;
+
+    //the name already carries the hash, the header guards against collisions and truncated or foreign files
+    VolumeCacheHeader expected = key.header();
+    if (memcmp(view, &expected, sizeof(expected)) != 0) unmap();
+}
+
+MappedVolume::~MappedVolume() {
+    unmap();
+}
+
+void MappedVolume::unmap() {
+#ifdef _WIN32
+    if (view != nullptr) UnmapViewOfFile(view);
+    if (mapping != NULL) CloseHandle(mapping);
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (view != nullptr) munmap((void*)view, viewBytes);
+    if (file >= 0) close(file);
+    file = -1;
+#endif
+    view = nullptr;
+    viewBytes = 0;
+}
+
+bool MappedVolume::valid() const {
+    return view != nullptr;
+}
+
+const void* MappedVolume::texels() const {
+    return view != nullptr ? view + sizeof(VolumeCacheHeader) : nullptr;
+}
+
+//writes a volume to a temporary file in one or more pieces (e.g. slab by slab while it streams to the GPU) and renames
+//it into place on commit, so a crash never leaves a half written volume under a valid name; commit then removes the
+//files this volume left behind with older settings
+class VolumeCacheWriter {
+public:
+    VolumeCacheWriter(const VolumeCacheKey& key);
+    ~VolumeCacheWriter();
+    VolumeCacheWriter(const VolumeCacheWriter&) = delete;
+    VolumeCacheWriter& operator=(const VolumeCacheWriter&) = delete;
+    void write(const void* texels, size_t bytes);
+    //fails when the pieces do not add up to the whole volume
+    bool commit();
+
+private:
+    std::filesystem::path path, tempPath;
+    std::ofstream out;
+    size_t expectedBytes, writtenBytes = 0;
+    bool committed = false;
+
+    void removeStaleFiles();
+};
+
+VolumeCacheWriter::VolumeCacheWriter(const VolumeCacheKey& key) : path(key.path()), tempPath(key.path()), expectedBytes(key.byteSize()) {
+    std::error_code error;
+    tempPath += ".tmp";
+    std::filesystem::create_directories(path.parent_path(), error);
+    out.open(tempPath, std::ios::binary | std::ios::trunc);
+    VolumeCacheHeader header = key.header();
+    out.write((const char*)&header, sizeof(header));
+}
+
+VolumeCacheWriter::~VolumeCacheWriter() {
+    if (committed) return;
+    std::error_code error;
+    out.close();
+    std::filesystem::remove(tempPath, error);
+}
+
+void VolumeCacheWriter::write(const void* texels, size_t bytes) {
+    out.write((const char*)texels, bytes);
+    writtenBytes += bytes;
+}
+
+bool VolumeCacheWriter::commit() {
+    out.close();
+    if (!out || writtenBytes != expectedBytes) {
+        std::cout << "Failed to write volume cache file " << tempPath.string() << "\n";
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::cout << "Failed to write volume cache file " << path.string() << ": " << error.message() << "\n";
+        return false;
+    }
+    committed = true;
+    removeStaleFiles();
+    return true;
+}
+
+void VolumeCacheWriter::removeStaleFiles() {
+    std::error_code error;
+    std::string stem = path.filename().string();
+    stem = stem.substr(0, stem.size() - strlen("0123456789abcdef.vol"));
+    for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+        std::string fileName = entry.path().filename().string();
+        bool sameVolume = fileName.size() == path.filename().string().size() && fileName.rfind(stem, 0) == 0;
+        if (sameVolume && entry.path() != path && entry.path().extension() == ".vol") {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+//The right to bake the volume of a key, held by one process at a time through an OS file lock on cache/<name>_<hash>.lock.
+//Processes that start together all miss the cache, the one that gets the lock bakes and publishes the volume while the
+//others wait for the lock and then find it in the cache. The OS drops the lock of a process that dies, so a crashed
+//baker only means the next holder finds no volume and bakes it itself
+class VolumeCacheLock {
+public:
+    VolumeCacheLock(const VolumeCacheKey& key);
+    ~VolumeCacheLock();
+    VolumeCacheLock(const VolumeCacheLock&) = delete;
+    VolumeCacheLock& operator=(const VolumeCacheLock&) = delete;
+    //take the lock, waiting for another process to release it or (tryLock) returning false right away when one holds it;
+    //a lock file that can not be created or locked counts as taken, there is no cache to share then
+    bool lock();
+    bool tryLock();
+    void unlock();
+
+private:
+    bool held = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int file = -1;
+#endif
+
+    bool acquire(bool block);
+};
+
+VolumeCacheLock::VolumeCacheLock(const VolumeCacheKey& key) {
+    std::error_code error;
+    std::filesystem::path path = key.path().replace_extension(".lock");
+    std::filesystem::create_directories(path.parent_path(), error);
+    //the file stays behind after the bake, deleting it could let a late process lock a new file while another holds the old one
+#ifdef _WIN32
+    file = CreateFileA(path.string().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_ALWAYS, 0, NULL);
+#else
+    file = open(path.string().c_str(), O_RDWR | O_CREAT, 0666);
+#endif
+}
+
+VolumeCacheLock::~VolumeCacheLock() {
+    unlock();
+#ifdef _WIN32
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+    if (file >= 0) close(file);
+#endif
+}
+
+bool VolumeCacheLock::lock() {
+    return acquire(true);
+}
+
+bool VolumeCacheLock::tryLock() {
+    return acquire(false);
+}
+
+bool VolumeCacheLock::acquire(bool block) {
+    if (held) return true;
+#ifdef _WIN32
+    if (file == INVALID_HANDLE_VALUE) return true;
+    OVERLAPPED overlapped = {};
+    held = LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK | (block ? 0 : LOCKFILE_FAIL_IMMEDIATELY), 0, 1, 0, &overlapped);
+    //any failure but another holder means the file system can not lock, like a missing lock file that counts as taken
+    if (!held) return GetLastError() != ERROR_LOCK_VIOLATION;
+#else
+    if (file < 0) return true;
+    int result;
+    do {
+        result = flock(file, LOCK_EX | (block ? 0 : LOCK_NB));
+    } while (result != 0 && errno == EINTR);
+    held = result == 0;
+    if (!held) return errno != EWOULDBLOCK;
+#endif
+    return held;
+}
+
+void VolumeCacheLock::unlock() {
+    if (!held) return;
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    UnlockFileEx(file, 0, 1, 0, &overlapped);
+#else
+    flock(file, LOCK_UN);
+#endif
+    held = false;
+}
+
+bool storeCachedVolume(const VolumeCacheKey& key, const void* texels) {
+    VolumeCacheWriter writer(key);
+    writer.write(texels, key.byteSize());
+    return writer.commit();
+}
+
+void printCacheLoadTime(const char* name, int width, int height, int depth, double ms) {
+    std::cout << "Loaded " << name << " (" << width << "x" << height << "x" << depth << ") from the volume cache in "
+        << ms << " ms\n";
+}
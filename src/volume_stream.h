@@ -0,0 +1,212 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "noise_bake.h"
+#include "thread_pool.h"
+
+//Bakes a volume slab by slab (a slab is a run of z slices) and uploads each slab as soon as it is done, so generation
+//and upload overlap and the host only ever holds a few slabs instead of the whole volume.
+//A producer thread fills slabs on the ThreadPool straight into the slots of one persistently mapped pixel buffer;
+//the GL thread uploads finished slots with glTextureSubImage3D and hands a slot back once the fence after its upload passed.
+//stream() does all of it before returning, start() and update() spread the uploads over frames while the renderer runs.
+
+class VolumeStreamer {
+public:
+    //format and type are the upload format and type of the texture, texelBytes the size of one texel in them
+    VolumeStreamer(int width, int height, int depth, GLenum format, GLenum type, int texelBytes, int slabDepth = 8, int slots = 3);
+    //a bake still running stops after its current slab
+    ~VolumeStreamer();
+    VolumeStreamer(const VolumeStreamer&) = delete;
+    VolumeStreamer& operator=(const VolumeStreamer&) = delete;
+    //fillBrick(const VolumeBrick&, void* texels) writes a brick starting at texels, rows width * texelBytes apart;
+    //onSlab(const void* texels, size_t bytes) then sees every finished slab in z order on the producer thread, before it is uploaded.
+    //Uploads into the storage of the GL_TEXTURE_3D bound when called, returns the time until the last slab reached the GPU in ms
+    template <typename FillFn>
+    double stream(ThreadPool& pool, FillFn& fillBrick, const std::function<void(const void*, size_t)>& onSlab = nullptr);
+    //starts the bake and returns at once, update() then uploads the slabs into level 0 of texture as they finish.
+    //pool is busy until update() returned true, parallelFor does not take a second caller
+    void start(ThreadPool& pool, const std::function<void(const VolumeBrick&, void*)>& fillBrick,
+        const std::function<void(const void*, size_t)>& onSlab, GLuint texture);
+    //uploads the slabs finished since the last call, or with wait every slab still to come, on the GL thread;
+    //returns true once the last slab was uploaded and the GPU read it
+    bool update(bool wait);
+
+private:
+    int width, height, depth;
+    GLenum format, type;
+    int texelBytes;
+    int slabDepth, slotCount;
+    size_t slotBytes;
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    std::vector<GLsync> fences;
+    GLuint texture = 0;
+    std::function<void(const VolumeBrick&, void*)> fillBrick;
+    std::function<void(const void*, size_t)> onSlab;
+    std::thread producer;
+    int slabsUploaded = 0; //only touched by the GL thread
+
+    //producer / GL thread handoff, slab s goes to slot s % slotCount
+    std::mutex mutex;
+    std::condition_variable changed;
+    int slabsFilled = 0;
+    int slabsReleased = 0;
+    bool cancelled = false;
+
+    int slabCount() const;
+    void produce(ThreadPool& pool);
+    bool waitFence(int slot, bool block = true);
+    void releaseSlots(bool block);
+};
+
+VolumeStreamer::VolumeStreamer(int width, int height, int depth, GLenum format, GLenum type, int texelBytes, int slabDepth, int slots)
+    : width(width), height(height), depth(depth), format(format), type(type), texelBytes(texelBytes),
+      slabDepth(std::max(slabDepth, 1)), slotCount(std::max(slots, 2)), fences(std::max(slots, 2), nullptr) {
+    slotBytes = (size_t)width * height * this->slabDepth * texelBytes;
+    //read access keeps the mapping in cached memory, onSlab reads the slabs back to store them
+    GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slotBytes * slotCount, NULL, flags);
+    mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slotBytes * slotCount, flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+VolumeStreamer::~VolumeStreamer() {
+    if (producer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        changed.notify_all();
+        producer.join();
+    }
+    for (int slot=0; slot<slotCount; slot++) waitFence(slot);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+}
+
+int VolumeStreamer::slabCount() const {
+    return (depth + slabDepth - 1) / slabDepth;
+}
+
+//true once the last upload from slot finished reading it, waits for that unless block is false
+bool VolumeStreamer::waitFence(int slot, bool block) {
+    if (fences[slot] == nullptr) return true;
+    GLenum status;
+    do {
+        status = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, block ? 1000000 : 0);
+    } while (block && status == GL_TIMEOUT_EXPIRED);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(fences[slot]);
+    fences[slot] = nullptr;
+    return true;
+}
+
+//slab n may go into the slot of slab n - slotCount once that one was uploaded and the GPU is done reading it
+void VolumeStreamer::releaseSlots(bool block) {
+    int released = slabsReleased; //only this thread writes it
+    while (released < slabCount() && released - slotCount < slabsUploaded && waitFence(released % slotCount, block)) released++;
+    if (released == slabsReleased) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slabsReleased = released;
+    }
+    changed.notify_all();
+}
+
+void VolumeStreamer::produce(ThreadPool& pool) {
+    size_t rowBytes = (size_t)width * texelBytes;
+    for (int slab=0; slab<slabCount(); slab++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return slab < slabsReleased || cancelled; });
+            if (cancelled) return;
+        }
+        int zFirst = slab * slabDepth;
+        int zCount = std::min(slabDepth, depth - zFirst);
+        unsigned char* slot = mapped + (slab % slotCount) * slotBytes;
+        auto fillSlabBrick = [&](const VolumeBrick& brick) {
+            fillBrick(brick, slot + ((size_t)(brick.z - zFirst) * height + brick.y) * rowBytes + (size_t)brick.x * texelBytes);
+        };
+        bakeSlab(pool, width, height, zFirst, zCount, fillSlabBrick);
+        if (onSlab) onSlab(slot, (size_t)zCount * height * rowBytes);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            slabsFilled++;
+        }
+        changed.notify_all();
+    }
+}
+
+template <typename FillFn>
+double VolumeStreamer::stream(ThreadPool& pool, FillFn& fillBrick, const std::function<void(const void*, size_t)>& onSlab) {
+    auto start = std::chrono::steady_clock::now();
+    GLint boundTexture;
+    glGetIntegerv(GL_TEXTURE_BINDING_3D, &boundTexture);
+    this->start(pool, fillBrick, onSlab, (GLuint)boundTexture);
+    update(true);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void VolumeStreamer::start(ThreadPool& pool, const std::function<void(const VolumeBrick&, void*)>& fillBrick,
+    const std::function<void(const void*, size_t)>& onSlab, GLuint texture) {
+    this->fillBrick = fillBrick;
+    this->onSlab = onSlab;
+    this->texture = texture;
+    slabsUploaded = 0;
+    slabsFilled = 0;
+    slabsReleased = std::min(slotCount, slabCount());
+    //GL calls stay on the GL thread, the producer only waits for released slots and fills them
+    producer = std::thread(&VolumeStreamer::produce, this, std::ref(pool));
+}
+
+bool VolumeStreamer::update(bool wait) {
+    int slabs = slabCount();
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    while (slabsUploaded < slabs) {
+        releaseSlots(false);
+        int filled;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            filled = slabsFilled;
+        }
+        if (slabsUploaded == filled) {
+            if (!wait) break;
+            //the producer may be waiting for a slot the GPU still reads, nothing is left to do here until it fills one
+            releaseSlots(true);
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return slabsUploaded < slabsFilled; });
+            continue;
+        }
+        int slot = slabsUploaded % slotCount;
+        int zFirst = slabsUploaded * slabDepth;
+        int zCount = std::min(slabDepth, depth - zFirst);
+        glTextureSubImage3D(texture, 0, 0, 0, zFirst, width, height, zCount, format, type, (const void*)(slot * slotBytes));
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slabsUploaded++;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+    if (slabsUploaded < slabs) return false;
+
+    for (int slot=0; slot<slotCount; slot++) {
+        if (!waitFence(slot, wait)) return false;
+    }
+    if (producer.joinable()) producer.join();
+    return true;
+}